@@ -96,6 +96,7 @@ _set_func('vc_clearDecls', None, _VC)
 _set_func('vc_printAsserts', None, _VC, c_int32)
 _set_func('vc_printQueryStateToBuffer', None, _VC, _Expr, POINTER(c_char_p), POINTER(c_ulong), c_int32)
 _set_func('vc_printCounterExampleToBuffer', None, _VC, POINTER(c_char_p), POINTER(c_ulong))
+_set_func('vc_printProfileToBuffer', None, _VC, POINTER(c_char_p), POINTER(c_ulong))
 _set_func('vc_printQuery', None, _VC)
 _set_func('vc_assertFormula', None, _VC, _Expr)
 _set_func('vc_simplify', _Expr, _VC, _Expr)
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "ASTInterior.h"
 #include "ASTSymbol.h"
 #include "ASTBVConst.h"
+#include "ASTNodeTable.h"
 
 namespace stp
 {
@@ -71,14 +72,12 @@ bool BVTypeCheckRecursive(const ASTNode& n);
 // Takes a BVCONST and returns its constant value
 unsigned int GetUnsignedConst(const ASTNode n);
 
-typedef hash_map<ASTNode, ASTNode, ASTNode::ASTNodeHasher,
-                 ASTNode::ASTNodeEqual> ASTNodeMap;
+typedef ASTNodeHashMap<ASTNode> ASTNodeMap;
 
 typedef hash_map<ASTNode, int32_t, ASTNode::ASTNodeHasher,
                  ASTNode::ASTNodeEqual> ASTNodeCountMap;
 
-typedef hash_set<ASTNode, ASTNode::ASTNodeHasher, ASTNode::ASTNodeEqual>
-    ASTNodeSet;
+typedef ASTNodeHashSet ASTNodeSet;
 
 typedef hash_multiset<ASTNode, ASTNode::ASTNodeHasher, ASTNode::ASTNodeEqual>
     ASTNodeMultiSet;
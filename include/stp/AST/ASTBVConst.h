@@ -27,6 +27,7 @@ THE SOFTWARE.
 #define ASTBVCONST_H
 
 #include "ASTInternal.h"
+#include <stdint.h>
 
 namespace stp
 {
@@ -52,6 +53,17 @@ private:
   // taken.
   bool cbv_managed_outside;
 
+  // Constants of 64 bits or less keep their CBV inside the node, the three
+  // hidden constantbv words followed by two data words, so they need no
+  // heap allocation. Their value is also kept as a word, which is what is
+  // hashed and compared.
+  unsigned int _inline_bv[5];
+  uint64_t _value;
+
+  bool isSmall() const { return _value_width <= 64; }
+  void setInline(uint64_t value);
+  uint64_t readSmall(const CBV bv) const;
+
   /****************************************************************
    * Hasher for ASTBVConst nodes                                  *
    ****************************************************************/
@@ -75,25 +87,54 @@ private:
   ASTBVConst(CBV bv, unsigned int width, bool managed_outside = false)
       : ASTInternal(BVCONST)
   {
-    if (managed_outside) {
+    _value_width = width;
+    cbv_managed_outside = managed_outside;
+    _value = 0;
+    if (isSmall())
+    {
+      if (managed_outside)
+      {
+        _bvconst = bv;
+        _value = readSmall(bv);
+      }
+      else
+        setInline(readSmall(bv));
+    }
+    else if (managed_outside)
       _bvconst = (bv);
-    } else {
+    else
       _bvconst = CONSTANTBV::BitVector_Clone(bv);
-    }
+  }
+
+  // A constant of 64 bits or less, without a CBV.
+  ASTBVConst(unsigned int width, uint64_t value) : ASTInternal(BVCONST)
+  {
+    assert(width > 0 && width <= 64);
     _value_width = width;
-    cbv_managed_outside = managed_outside;
+    cbv_managed_outside = false;
+    setInline(value);
   }
 
   ASTBVConst(const ASTBVConst& sym);
 
+  // Copies the constant into a node owned by the manager.
+  ASTBVConst(const ASTBVConst& sym, STPMgr* mgr);
+
   // friend equality operator
   friend bool operator==(const ASTBVConst& bvc1, const ASTBVConst& bvc2)
   {
     if (bvc1._value_width != bvc2._value_width)
       return false;
+    if (bvc1.isSmall())
+      return bvc1._value == bvc2._value;
     return (0 == CONSTANTBV::BitVector_Compare(bvc1._bvconst, bvc2._bvconst));
   }
 
+  bool ownsHeapCBV() const
+  {
+    return !cbv_managed_outside && _bvconst != _inline_bv + 3;
+  }
+
   // Call this when deleting a node that has been stored in the the
   // unique table
   virtual void CleanUp();
@@ -110,12 +151,19 @@ public:
 
   virtual ~ASTBVConst()
   {
-    if (!cbv_managed_outside)
+    if (ownsHeapCBV())
       CONSTANTBV::BitVector_Destroy(_bvconst);
   }
 
   // Return the bvconst. It is a const-value
   CBV GetBVConst() const;
+
+  // The value of a constant of 64 bits or less.
+  uint64_t GetSmallValue() const
+  {
+    assert(isSmall());
+    return _value;
+  }
 };
 
 } // end of namespace
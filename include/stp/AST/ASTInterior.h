@@ -51,6 +51,15 @@ class ASTInterior : public ASTInternalWithChildren
                                  const stp::ASTVec& back_children);
 
 private:
+  // A kind and children to look up in the unique table, without building
+  // a node to hold them.
+  struct Key
+  {
+    Key(Kind k, const ASTVec& c) : kind(k), children(c) {}
+    Kind kind;
+    const ASTVec& children;
+  };
+
   /******************************************************************
    * Hasher for ASTInterior pointer nodes                           *
    ******************************************************************/
@@ -58,6 +67,7 @@ private:
   {
   public:
     size_t operator()(const ASTInterior* int_node_ptr) const;
+    size_t operator()(const Key& key) const;
   };
 
   /******************************************************************
@@ -68,6 +78,7 @@ private:
   public:
     bool operator()(const ASTInterior* int_node_ptr1,
                     const ASTInterior* int_node_ptr2) const;
+    bool operator()(const ASTInterior* int_node_ptr, const Key& key) const;
   };
 
   // Used in Equality class for hash tables
@@ -89,9 +100,10 @@ private:
 
 public:
   ASTInterior(Kind kind) : ASTInternalWithChildren(kind) {}
-  ASTInterior(Kind kind, ASTVec& children)
+  ASTInterior(Kind kind, const ASTVec& children, STPMgr* mgr)
       : ASTInternalWithChildren(kind, children)
   {
+    _mgr = mgr;
   }
 
   // This copies the contents of the child nodes
@@ -70,20 +70,24 @@ protected:
    * Protected Data                                               *
    ****************************************************************/
 
-  mutable uint8_t iteration;
+  // Kind. It's a type tag and the operator.
+  enumeration<Kind, unsigned char> _kind;
+
+  // The last traversal that visited this node. It shares a word with _kind.
+  mutable unsigned int iteration : 24;
 
   // reference counting for garbage collection
   unsigned int _ref_count;
 
-  // Kind. It's a type tag and the operator.
-  enumeration<Kind, unsigned char> _kind;
-
   // Nodenum is a unique positive integer for the node.  The nodenum
   // of a node should always be greater than its descendents (which
   // is easily achieved by incrementing the number each time a new
   // node is created).
   unsigned int _node_num;
 
+  // Hash of the node's contents, set when the node enters its unique table.
+  unsigned int _hash;
+
   /*******************************************************************
    * ASTNode is of type BV      <==> ((indexwidth=0)&&(valuewidth>0))*
    * ASTNode is of type ARRAY   <==> ((indexwidth>0)&&(valuewidth>0))*
@@ -102,6 +106,13 @@ protected:
    *******************************************************************/
   unsigned int _value_width;
 
+  // The manager whose unique table and pool hold this node. Nodes find
+  // their way back to it when they die, rather than going through a
+  // global, so several managers can coexist. It is given when the manager
+  // constructs the node, and is NULL only for the temporary lookup keys,
+  // which are never cleaned up.
+  STPMgr* _mgr;
+
   /****************************************************************
    * Protected Member Functions                                   *
    ****************************************************************/
@@ -125,10 +136,13 @@ protected:
   virtual ASTVec const& GetChildren() const = 0;
 
 public:
+  // The largest traversal number that fits in a node.
+  static const unsigned int MaxIteration = (1u << 24) - 1;
+
   // Constructor (kind only, empty children, int nodenum)
   ASTInternal(Kind kind, int nodenum = 0)
-      : iteration(0), _ref_count(0), _kind(kind), _node_num(nodenum),
-        _index_width(0), _value_width(0)
+      : _kind(kind), iteration(0), _ref_count(0), _node_num(nodenum),
+        _hash(0), _index_width(0), _value_width(0), _mgr(NULL)
   {
   }
 
@@ -138,9 +152,10 @@ public:
   // temporary hash keys before uniquefication.
   // FIXME:  I don't think children need to be copied.
   ASTInternal(const ASTInternal& int_node)
-      : iteration(0), _ref_count(0), _kind(int_node._kind),
-        _node_num(int_node._node_num), _index_width(int_node._index_width),
-        _value_width(int_node._value_width)
+      : _kind(int_node._kind), iteration(0), _ref_count(0),
+        _node_num(int_node._node_num), _hash(int_node._hash),
+        _index_width(int_node._index_width),
+        _value_width(int_node._value_width), _mgr(int_node._mgr)
   {
   }
 
@@ -168,6 +183,12 @@ public:
 
   void SetNodeNum(int nn) { _node_num = nn; } 
 
+  unsigned int GetHash() const { return _hash; }
+
+  void SetHash(unsigned int h) { _hash = h; }
+
+  STPMgr* GetSTPMgr() const { return _mgr; }
+
 }; 
 } // end of namespace
 #endif
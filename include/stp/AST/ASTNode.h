@@ -25,6 +25,7 @@ THE SOFTWARE.
 #define ASTNODE_H
 
 #include "stp/AST/ASTInternal.h"
+#include <stdint.h>
 #include "stp/AST/ASTKind.h"
 #include "stp/AST/NodeFactory/HashingNodeFactory.h"
 
@@ -74,8 +75,8 @@ public:
    * Public Member Functions                                      *
    ****************************************************************/
 
-  uint8_t getIteration() const;
-  void setIteration(uint8_t v) const;
+  uint32_t getIteration() const;
+  void setIteration(uint32_t v) const;
 
   // Default constructor.
   ASTNode() : _int_node_ptr(NULL){};
@@ -165,6 +166,9 @@ public:
 
   unsigned int GetUnsignedConst() const;
 
+  // Get the value of a BVCONST of 64 bits or less.
+  uint64_t GetSmallBVConst() const;
+
   /*******************************************************************
    * ASTNode is of type BV      <==> ((indexwidth=0)&&(valuewidth>0))*
    * ASTNode is of type ARRAY   <==> ((indexwidth>0)&&(valuewidth>0))*
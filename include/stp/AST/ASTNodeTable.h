@@ -0,0 +1,388 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+#ifndef ASTNODETABLE_H
+#define ASTNODETABLE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "stp/AST/ASTNode.h"
+
+namespace stp
+{
+
+/******************************************************************
+ * Open addressing (linear probing) hash tables keyed by nodes,   *
+ * behind the ASTNodeMap and ASTNodeSet typedefs. The entries are *
+ * kept inline in one array, so a lookup touches one or two cache *
+ * lines rather than following a bucket's chain, and an entry     *
+ * costs no allocation of its own.                                *
+ *                                                                *
+ * Unlike hash_map, growing the table moves the entries. So don't *
+ * hold a reference or an iterator into a table over an insertion *
+ * into it. Erasing leaves a tombstone and moves nothing, so      *
+ * erasing while iterating works as it does with hash_map.        *
+ ******************************************************************/
+template <class Entry, class KeyOf> class ASTNodeTable
+{
+  enum
+  {
+    EMPTY = 0,
+    FULL,
+    ERASED
+  };
+
+  // Kept in step: slots[i] holds an entry iff states[i] is FULL. The size
+  // is zero until the first insertion, then always a power of two.
+  std::vector<Entry> slots;
+  std::vector<uint8_t> states;
+  size_t full; // FULL slots.
+  size_t used;  // FULL or ERASED slots.
+  unsigned shift;
+
+  // Nodes are unique, so the address identifies them. Fibonacci hashing
+  // takes the high bits of the product, which depend on all of the address.
+  size_t home(const ASTNode& key) const
+  {
+    return (size_t)(((uint64_t)key.Hash() * 0x9E3779B97F4A7C15ULL) >> shift);
+  }
+
+  size_t mask() const { return slots.size() - 1; }
+
+  // The slot holding key, or slots.size() if there's none.
+  size_t slot(const ASTNode& key) const
+  {
+    if (full == 0)
+      return slots.size();
+    for (size_t i = home(key); states[i] != EMPTY; i = (i + 1) & mask())
+      if (states[i] == FULL && KeyOf::get(slots[i]) == key)
+        return i;
+    return slots.size();
+  }
+
+  // Rebuilds the table with room for at least size entries, dropping the
+  // tombstones.
+  void rehash(size_t size)
+  {
+    size_t capacity = 16;
+    while (4 * size > 3 * capacity)
+      capacity *= 2;
+
+    std::vector<Entry> oldSlots(capacity);
+    std::vector<uint8_t> oldStates(capacity, (uint8_t)EMPTY);
+    oldSlots.swap(slots);
+    oldStates.swap(states);
+    shift = 64;
+    for (size_t s = capacity; s > 1; s /= 2)
+      shift--;
+    used = full;
+
+    for (size_t i = 0; i < oldSlots.size(); i++)
+      if (oldStates[i] == FULL)
+      {
+        size_t j = home(KeyOf::get(oldSlots[i]));
+        while (states[j] != EMPTY)
+          j = (j + 1) & mask();
+        std::swap(slots[j], oldSlots[i]);
+        states[j] = FULL;
+      }
+  }
+
+protected:
+  Entry& slotEntry(size_t i) { return slots[i]; }
+
+  // Returns the slot for key, and whether it was empty. An empty slot is
+  // given key, and a default value.
+  std::pair<size_t, bool> insertKey(const ASTNode& key)
+  {
+    assert(!key.IsNull());
+    if (4 * (used + 1) > 3 * slots.size())
+      rehash(2 * (full + 1));
+
+    size_t erased = slots.size();
+    size_t i = home(key);
+    for (; states[i] != EMPTY; i = (i + 1) & mask())
+    {
+      if (states[i] == FULL && KeyOf::get(slots[i]) == key)
+        return std::make_pair(i, false);
+      if (states[i] == ERASED && erased == slots.size())
+        erased = i;
+    }
+
+    if (erased != slots.size())
+      i = erased;
+    else
+      used++;
+    states[i] = FULL;
+    KeyOf::set(slots[i], key);
+    full++;
+    return std::make_pair(i, true);
+  }
+
+public:
+  template <class T, class S> class basic_iterator
+  {
+    friend class ASTNodeTable;
+    template <class, class> friend class basic_iterator;
+    T* p;
+    S* s;
+    S* end;
+
+    basic_iterator(T* p_, S* s_, S* end_) : p(p_), s(s_), end(end_)
+    {
+      while (s != end && *s != FULL)
+      {
+        p++;
+        s++;
+      }
+    }
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef T* pointer;
+    typedef T& reference;
+
+    basic_iterator() : p(NULL), s(NULL), end(NULL) {}
+
+    // An iterator converts to a const_iterator.
+    template <class U, class R>
+    basic_iterator(const basic_iterator<U, R>& o)
+        : p(o.p), s(o.s), end(o.end)
+    {
+    }
+
+    T& operator*() const { return *p; }
+    T* operator->() const { return p; }
+    basic_iterator& operator++()
+    {
+      do
+      {
+        p++;
+        s++;
+      } while (s != end && *s != FULL);
+      return *this;
+    }
+    basic_iterator operator++(int)
+    {
+      basic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+    template <class U, class R>
+    bool operator==(const basic_iterator<U, R>& o) const
+    {
+      return s == o.s;
+    }
+    template <class U, class R>
+    bool operator!=(const basic_iterator<U, R>& o) const
+    {
+      return s != o.s;
+    }
+  };
+
+  typedef ASTNode key_type;
+  typedef Entry value_type;
+  typedef size_t size_type;
+  typedef basic_iterator<Entry, uint8_t> iterator;
+  typedef basic_iterator<const Entry, const uint8_t> const_iterator;
+
+  ASTNodeTable() : full(0), used(0), shift(64) {}
+
+  explicit ASTNodeTable(size_t initial) : full(0), used(0), shift(64)
+  {
+    rehash(initial);
+  }
+
+  template <class It>
+  ASTNodeTable(It first, It last)
+      : full(0), used(0), shift(64)
+  {
+    insert(first, last);
+  }
+
+  iterator begin()
+  {
+    return iterator(slots.data(), states.data(),
+                    states.data() + states.size());
+  }
+  iterator end()
+  {
+    return iterator(slots.data() + slots.size(),
+                    states.data() + states.size(),
+                    states.data() + states.size());
+  }
+  const_iterator begin() const
+  {
+    return const_iterator(slots.data(), states.data(),
+                          states.data() + states.size());
+  }
+  const_iterator end() const
+  {
+    return const_iterator(slots.data() + slots.size(),
+                          states.data() + states.size(),
+                          states.data() + states.size());
+  }
+
+  iterator find(const ASTNode& key)
+  {
+    const size_t i = slot(key);
+    return iterator(slots.data() + i, states.data() + i,
+                    states.data() + states.size());
+  }
+  const_iterator find(const ASTNode& key) const
+  {
+    const size_t i = slot(key);
+    return const_iterator(slots.data() + i, states.data() + i,
+                          states.data() + states.size());
+  }
+
+  size_t count(const ASTNode& key) const
+  {
+    return slot(key) == slots.size() ? 0 : 1;
+  }
+
+  std::pair<iterator, bool> insert(const Entry& e)
+  {
+    const std::pair<size_t, bool> r = insertKey(KeyOf::get(e));
+    if (r.second)
+      slots[r.first] = e;
+    return std::make_pair(iterator(slots.data() + r.first,
+                                   states.data() + r.first,
+                                   states.data() + states.size()),
+                          r.second);
+  }
+
+  template <class It> void insert(It first, It last)
+  {
+    for (; first != last; ++first)
+      insert(*first);
+  }
+
+  // Returns the entry after the erased one.
+  iterator erase(const_iterator it)
+  {
+    const size_t i = it.s - states.data();
+    assert(states[i] == FULL);
+    slots[i] = Entry(); // Let go of the nodes.
+    states[i] = ERASED;
+    full--;
+    return iterator(slots.data() + i, states.data() + i,
+                    states.data() + states.size());
+  }
+
+  size_t erase(const ASTNode& key)
+  {
+    const size_t i = slot(key);
+    if (i == slots.size())
+      return 0;
+    erase(const_iterator(slots.data() + i, states.data() + i,
+                         states.data() + states.size()));
+    return 1;
+  }
+
+  size_t size() const { return full; }
+  bool empty() const { return full == 0; }
+  size_t bucket_count() const { return slots.size(); }
+
+  // Also gives back the memory.
+  void clear()
+  {
+    std::vector<Entry>().swap(slots);
+    std::vector<uint8_t>().swap(states);
+    full = used = 0;
+    shift = 64;
+  }
+
+  void swap(ASTNodeTable& o)
+  {
+    slots.swap(o.slots);
+    states.swap(o.states);
+    std::swap(full, o.full);
+    std::swap(used, o.used);
+    std::swap(shift, o.shift);
+  }
+};
+
+struct ASTNodeTableSetKey
+{
+  static const ASTNode& get(const ASTNode& e) { return e; }
+  static void set(ASTNode& e, const ASTNode& key) { e = key; }
+};
+
+template <class V> struct ASTNodeTableMapKey
+{
+  static const ASTNode& get(const std::pair<ASTNode, V>& e) { return e.first; }
+  static void set(std::pair<ASTNode, V>& e, const ASTNode& key)
+  {
+    e.first = key;
+  }
+};
+
+template <class V>
+class ASTNodeHashMap
+    : public ASTNodeTable<std::pair<ASTNode, V>, ASTNodeTableMapKey<V> >
+{
+  typedef ASTNodeTable<std::pair<ASTNode, V>, ASTNodeTableMapKey<V> > Table;
+
+public:
+  typedef V mapped_type;
+
+  ASTNodeHashMap() {}
+  explicit ASTNodeHashMap(size_t initial) : Table(initial) {}
+  template <class It> ASTNodeHashMap(It first, It last) : Table(first, last)
+  {
+  }
+
+  V& operator[](const ASTNode& key)
+  {
+    return Table::slotEntry(Table::insertKey(key).first).second;
+  }
+};
+
+// The entries of a set are its keys, so they can't be changed in place.
+class ASTNodeHashSet : public ASTNodeTable<ASTNode, ASTNodeTableSetKey>
+{
+  typedef ASTNodeTable<ASTNode, ASTNodeTableSetKey> Table;
+
+public:
+  typedef Table::const_iterator iterator;
+  typedef Table::const_iterator const_iterator;
+
+  ASTNodeHashSet() {}
+  explicit ASTNodeHashSet(size_t initial) : Table(initial) {}
+  template <class It> ASTNodeHashSet(It first, It last) : Table(first, last)
+  {
+  }
+
+  const_iterator begin() const { return Table::begin(); }
+  const_iterator end() const { return Table::end(); }
+  const_iterator find(const ASTNode& key) const { return Table::find(key); }
+};
+
+} // end namespace stp
+
+#endif
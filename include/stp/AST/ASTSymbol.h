@@ -92,6 +92,11 @@ public:
 
   // Constructor.  This does NOT copy its argument.
   ASTSymbol(const char* const name) : ASTInternal(SYMBOL), _name(name) {}
+  ASTSymbol(const char* const name, STPMgr* mgr)
+      : ASTInternal(SYMBOL), _name(name)
+  {
+    _mgr = mgr;
+  }
 
   virtual ~ASTSymbol() {}
 
@@ -72,6 +72,10 @@ public:
 private:
   std::map<ASTNode, vector<std::pair<ASTNode, ASTNode>>> ack_pair;
 
+  // Arrays that have been read from during this transformation, and whose
+  // reads still need relating through a sorting network.
+  std::set<ASTNode> arraysToSort;
+
   /****************************************************************
    * Private Typedefs and Data                                    *
    ****************************************************************/
@@ -104,6 +108,10 @@ private:
 
   ASTNode TransformArrayRead(const ASTNode& term);
 
+  // Sorts the (index, value) pairs by index, then constrains neighbours
+  // with equal indexes to have equal values.
+  ASTNode SortedReadCongruence(ASTVec indexes, ASTVec values);
+
   ASTNode TransformFormula(const ASTNode& form);
 
 public:
@@ -138,6 +146,7 @@ public:
   {
     arrayToIndexToRead.clear();
     ack_pair.clear();
+    arraysToSort.clear();
   }
 
   void printArrayStats()
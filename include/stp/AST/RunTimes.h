@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <stack>
 #include <map>
 #include <string>
+#include <vector>
 //#include "../sat/utils/System.h"
 #include <iomanip>
 #include <iostream>
@@ -59,38 +60,63 @@ public:
     UseITEContext,
     AIGSimplifyCore,
     IntervalPropagation,
-    AlwaysTrue
+    AlwaysTrue,
+    CategoryCount
   };
 
   static std::string CategoryNames[];
 
-  typedef std::pair<Category, long> Element;
+  struct Element
+  {
+    Category category;
+    long wall; // microseconds
+    long cpu;  // microseconds, only taken when profiling.
+  };
 
 private:
   RunTimes& operator=(const RunTimes&);
   RunTimes(const RunTimes& other);
 
-  std::map<Category, int> counts;
-  std::map<Category, long> times;
+  int counts[CategoryCount];
+  long times[CategoryCount];    // wall time, microseconds.
+  long cpuTimes[CategoryCount]; // microseconds.
+  std::map<std::string, long> counters; // named event counts, not timed.
   std::stack<Element> category_stack;
 
-  // millisecond precision timer.
+  // The node count after each stage of a query, in order. Only kept when
+  // profiling.
+  std::vector<std::pair<std::string, long> > nodeCounts;
+
+  // Profiling takes the CPU time as well as the wall time of each category,
+  // and records node counts, cache, CNF and SAT statistics.
+  bool profiling;
+
+  // microsecond precision timers.
   long getCurrentTime();
-  void addTime(Category c, long milliseconds);
+  long getCPUTime();
 
   long lastTime;
 
 public:
   void addCount(Category c);
+  void addCounter(const std::string& name, long amount = 1);
+  void addNodeCount(const std::string& stage, long nodes);
   void start(Category c);
   void stop(Category c);
   void print();
 
+  // Writes everything recorded since the last clear() as a JSON object on
+  // one line.
+  void printJSON(std::ostream& os);
+
+  void setProfiling(bool p) { profiling = p; }
+  bool isProfiling() const { return profiling; }
+
   std::string getDifference()
   {
     std::stringstream s;
     long val = getCurrentTime();
-    s << (val - lastTime) << "ms";
+    s << (val - lastTime) / 1000 << "ms";
     lastTime = val;
     s << ":" << std::fixed << std::setprecision(0)
       << memUsed() / (1024.0 * 1024.0) << "MB";
@@ -101,13 +127,24 @@ public:
 
   void difference() { std::cout << getDifference() << std::endl << std::endl; }
 
-  RunTimes() { lastTime = getCurrentTime(); }
+  RunTimes() : profiling(false)
+  {
+    clear();
+    lastTime = getCurrentTime();
+  }
 
+  // Categories that are running aren't stopped, so the statistics can be
+  // cleared between queries while parsing is being timed.
   void clear()
   {
-    counts.clear();
-    times.clear();
-    category_stack.empty();
+    for (int i = 0; i < CategoryCount; i++)
+    {
+      counts[i] = 0;
+      times[i] = 0;
+      cpuTimes[i] = 0;
+    }
+    counters.clear();
+    nodeCounts.clear();
   }
 };
 
@@ -0,0 +1,197 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+#ifndef UNIQUETABLE_H
+#define UNIQUETABLE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace stp
+{
+
+/******************************************************************
+ * An open addressing (linear probing) hash set of node pointers. *
+ *                                                                *
+ * Each node carries the structural hash it was given when it was *
+ * inserted (GetHash()), so growing the table or erasing a node   *
+ * never recomputes it, and a probe only compares the contents of *
+ * nodes whose hashes match. Equal compares the contents of two   *
+ * nodes.                                                         *
+ ******************************************************************/
+template <class T, class Equal> class UniqueTable
+{
+  // NULL marks an empty slot. The size is always a power of two.
+  std::vector<T*> slots;
+  size_t count;
+
+  size_t mask() const { return slots.size() - 1; }
+
+  // The node hashes aren't all well mixed in their low bits, so mix them
+  // before picking a slot.
+  size_t home(unsigned h) const
+  {
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    return h & mask();
+  }
+
+  void grow()
+  {
+    std::vector<T*> old;
+    old.swap(slots);
+    slots.resize(old.size() * 2, NULL);
+
+    for (size_t i = 0; i < old.size(); i++)
+      if (old[i] != NULL)
+      {
+        size_t j = home(old[i]->GetHash());
+        while (slots[j] != NULL)
+          j = (j + 1) & mask();
+        slots[j] = old[i];
+      }
+  }
+
+public:
+  class iterator
+  {
+    friend class UniqueTable;
+    T* const* p;
+    T* const* end;
+
+    iterator(T* const* p_, T* const* end_) : p(p_), end(end_)
+    {
+      while (p != end && *p == NULL)
+        p++;
+    }
+
+  public:
+    T* operator*() const { return *p; }
+    iterator& operator++()
+    {
+      do
+        p++;
+      while (p != end && *p == NULL);
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator result = *this;
+      ++*this;
+      return result;
+    }
+    bool operator==(const iterator& o) const { return p == o.p; }
+    bool operator!=(const iterator& o) const { return p != o.p; }
+  };
+  typedef iterator const_iterator;
+
+  explicit UniqueTable(size_t initial = 1024) : slots(), count(0)
+  {
+    size_t size = 16;
+    while (size < initial)
+      size *= 2;
+    slots.resize(size, NULL);
+  }
+
+  // Returns the node equal to key, or NULL. The caller supplies the key's
+  // hash, because the key usually isn't in the table and has no hash yet.
+  // The key can be anything Equal compares a node with.
+  template <class Key> T* find(const Key& key, unsigned hash) const
+  {
+    for (size_t i = home(hash); slots[i] != NULL; i = (i + 1) & mask())
+      if (slots[i]->GetHash() == hash && Equal()(slots[i], key))
+        return slots[i];
+    return NULL;
+  }
+
+  // The node mustn't be in the table already, and must have its hash set.
+  void insert(T* node)
+  {
+    if (4 * (count + 1) > 3 * slots.size())
+      grow();
+
+    size_t i = home(node->GetHash());
+    while (slots[i] != NULL)
+    {
+      assert(slots[i] != node);
+      i = (i + 1) & mask();
+    }
+    slots[i] = node;
+    count++;
+  }
+
+  // Removes exactly this node (not a node equal to it). The entries after it
+  // in the probe sequence are shuffled back, so no tombstones are left.
+  void erase(T* node)
+  {
+    size_t i = home(node->GetHash());
+    while (slots[i] != node)
+    {
+      if (slots[i] == NULL)
+        return;
+      i = (i + 1) & mask();
+    }
+
+    size_t j = i;
+    while (true)
+    {
+      j = (j + 1) & mask();
+      if (slots[j] == NULL)
+        break;
+
+      // Move slots[j] into the hole at i, unless its home slot lies
+      // cyclically in (i, j], in which case it's already reachable.
+      const size_t h = home(slots[j]->GetHash());
+      if (((j - h) & mask()) >= ((j - i) & mask()))
+      {
+        slots[i] = slots[j];
+        i = j;
+      }
+    }
+    slots[i] = NULL;
+    count--;
+  }
+
+  size_t size() const { return count; }
+  size_t bucket_count() const { return slots.size(); }
+
+  // Forgets the nodes without freeing them.
+  void clear()
+  {
+    std::fill(slots.begin(), slots.end(), (T*)NULL);
+    count = 0;
+  }
+
+  iterator begin() const
+  {
+    return iterator(slots.data(), slots.data() + slots.size());
+  }
+  iterator end() const
+  {
+    return iterator(slots.data() + slots.size(), slots.data() + slots.size());
+  }
+};
+
+} // end namespace stp
+
+#endif
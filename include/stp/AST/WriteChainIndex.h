@@ -0,0 +1,77 @@
+// -*- c++ -*-
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+
+#ifndef WRITECHAININDEX_H_
+#define WRITECHAININDEX_H_
+
+#include "stp/AST/AST.h"
+
+namespace stp
+{
+// Answers READ(WRITE(...WRITE(A, i1, v1)..., in, vn), j) when j and the
+// write indexes are constants, without walking down the chain for each read.
+//
+// Writes to constant indexes are grouped into segments. In a segment, each
+// write is over the one before it. A write is numbered by its depth in its
+// segment, and for each index the segment keeps the depths that write to it
+// in ascending order. A read finds the last write at or below its depth with
+// a binary search. Chains that share a prefix start a new segment above the
+// shared write, so reads that miss in the new segment continue from there.
+class WriteChainIndex // not copyable
+{
+  typedef vector<std::pair<unsigned, ASTNode>> Writes;
+  typedef hash_map<ASTNode, Writes, ASTNode::ASTNodeHasher,
+                   ASTNode::ASTNodeEqual> IndexToWrites;
+
+  struct Segment
+  {
+    ASTNode base; // The array under the segment's first write.
+    ASTNode top;  // The last write added to the segment.
+    IndexToWrites writes;
+  };
+
+  struct Position
+  {
+    Segment* segment;
+    unsigned depth;
+  };
+
+  typedef hash_map<ASTNode, Position, ASTNode::ASTNodeHasher,
+                   ASTNode::ASTNodeEqual> PositionMap;
+  PositionMap positions;
+  vector<Segment*> segments;
+
+  Position add(const ASTNode& write);
+
+public:
+  ~WriteChainIndex() { clear(); }
+
+  // "write" is a WRITE to a constant index, and "index" is a constant.
+  // Returns the value of the last write to "index" in the chain. If none
+  // of the indexed writes is to "index", returns a null node and sets
+  // "below" to the array that the read should continue into.
+  ASTNode lookup(const ASTNode& write, const ASTNode& index, ASTNode& below);
+
+  void clear();
+};
+} // end of namespace
+#endif
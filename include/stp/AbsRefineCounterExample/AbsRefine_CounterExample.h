@@ -106,6 +106,9 @@ public:
   // to e
   ASTNode GetCounterExample(bool t, const ASTNode& e);
 
+  // evaluates the formula or bitvector term e under the counterexample
+  ASTNode EvaluateUsingModel(const ASTNode& e);
+
   // queries the counterexample, and returns a vector of index-value pairs for e
   std::vector<std::pair<ASTNode, ASTNode>>
   GetCounterExampleArray(bool t, const ASTNode& e);
@@ -82,13 +82,14 @@ enum SOLVER_RETURN_TYPE
 extern std::vector<ASTNode> _empty_ASTVec;
 
 // Needed by the SMTLIB printer
-extern enum inputStatus input_status;
+extern thread_local enum inputStatus input_status;
 
 
-// Useful global variables. Use for parsing only
-extern STP* GlobalSTP;
-extern STPMgr* GlobalParserBM;
-extern Cpp_interface* GlobalParserInterface;
+// Useful global variables. Use for parsing only. Each thread has its own, so
+// instances on different threads don't see each other.
+extern thread_local STP* GlobalSTP;
+extern thread_local STPMgr* GlobalParserBM;
+extern thread_local Cpp_interface* GlobalParserInterface;
 
 // Function that computes various kinds of statistics for the phases
 // of STP
@@ -31,15 +31,15 @@ namespace printer
 {
 
 // Map from ASTNodes to LetVars
-extern stp::ASTNodeMap NodeLetVarMap;
+extern thread_local stp::ASTNodeMap NodeLetVarMap;
 
 // This is a vector which stores the Node to LetVars pairs. It
 // allows for sorted printing, as opposed to NodeLetVarMap
-extern std::vector<std::pair<ASTNode, ASTNode>> NodeLetVarVec;
+extern thread_local std::vector<std::pair<ASTNode, ASTNode>> NodeLetVarVec;
 
 // a partial Map from ASTNodes to LetVars. Needed in order to
 // correctly print shared subterms inside the LET itself
-extern stp::ASTNodeMap NodeLetVarMap1;
+extern thread_local stp::ASTNodeMap NodeLetVarMap1;
 
 std::string functionToSMTLIBName(const Kind k, bool smtlib1);
 
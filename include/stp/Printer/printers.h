@@ -44,7 +44,7 @@ ostream& PL_Print(ostream& os, const stp::ASTNode& n, int indentation = 0);
 void PL_Print1(ostream& os, const ASTNode& n, int indentation, bool letize);
 
 ostream& Lisp_Print(ostream& os, const stp::ASTNode& n, int indentation = 0);
-extern stp::ASTNodeSet Lisp_AlreadyPrintedSet;
+extern thread_local stp::ASTNodeSet Lisp_AlreadyPrintedSet;
 ostream& Lisp_Print_indent(ostream& os, const stp::ASTNode& n,
                            int indentation = 0);
 
@@ -54,6 +54,9 @@ void SMTLIB1_PrintBack(ostream& os, const stp::ASTNode& n);
 void SMTLIB2_PrintBack(ostream& os, const ASTNode& n,
                        bool definately_bv = false);
 
+// Prints just the expression, without lets.
+void SMTLIB2_Print(ostream& os, const ASTNode& n);
+
 ostream& GDL_Print(ostream& os, const stp::ASTNode n);
 ostream& GDL_Print(ostream& os, const ASTNode n,
                    std::string (*annotate)(const ASTNode&));
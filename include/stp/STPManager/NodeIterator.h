@@ -40,7 +40,7 @@ class NodeIterator // not copyable
   std::stack<ASTNode> toVisit;
 
   const ASTNode& sentinel;
-  uint8_t iteration;
+  uint32_t iteration;
 
 public:
   NodeIterator(const ASTNode& n, const ASTNode& _sentinel, STPMgr& stpMgr)
@@ -38,13 +38,36 @@ THE SOFTWARE.
 
 namespace stp
 {
+class ToSATAIG;
+class EstablishIntervals;
+
 // not copyable
 // FIXME: This needs a better name
 class STP
 {
 
+  // What sizeReducing() keeps between calls while a query is solved, so
+  // that repeating it to a fixed point doesn't start from nothing each time.
+  struct SizeReducingState
+  {
+    explicit SizeReducingState(STPMgr& bm);
+    ~SizeReducingState();
+
+    // Remembers the intervals of the nodes it has seen.
+    EstablishIntervals* intervals;
+
+    // The last input that each pass left unchanged. These passes only look
+    // at their input, so they would leave it unchanged again.
+    ASTNode unconstrainedDone, intervalsDone, bitPropagationDone,
+        pureLiteralsDone, alwaysTrueDone;
+
+  private:
+    SizeReducingState(const SizeReducingState&);
+    SizeReducingState& operator=(const SizeReducingState&);
+  };
+
   ASTNode sizeReducing(ASTNode input, BVSolver* bvSolver,
-                       PropagateEqualities* pe);
+                       PropagateEqualities* pe, SizeReducingState& state);
 
   // A copy of all the state we need to restore to a prior expression.
   struct Revert_to
@@ -69,6 +92,20 @@ class STP
 
   SATSolver* get_new_sat_solver();
 
+  // Incremental mode. The solver and the CNF converter live as long as this
+  // object does. Each asserted formula is preprocessed once, the result is
+  // remembered so that the same conjunct always maps to the same activation
+  // literal in the solver.
+  SATSolver* persistentSolver;
+  ToSATAIG* persistentToSAT;
+  ASTNodeMap incrementalPreprocessed;
+
+  bool useIncremental() const;
+  ASTNode preprocessIncremental(const ASTNode& conjunct);
+  SOLVER_RETURN_TYPE TopLevelSTPIncremental(const ASTNode& inputasserts,
+                                            const ASTNode& query,
+                                            const ASTNode& original_input);
+
 public:
 
   STPMgr* bm;
@@ -85,6 +122,8 @@ public:
     tosat = ts;
     arrayTransformer = a;
     Ctr_Example = ce;
+    persistentSolver = NULL;
+    persistentToSAT = NULL;
   } 
 
   STP(STPMgr* b, Simplifier* s, BVSolver* bsolv, ArrayTransformer* a,
@@ -96,25 +135,15 @@ public:
     delete bsolv; // Remove from the constructor later..
     arrayTransformer = a;
     Ctr_Example = ce;
+    persistentSolver = NULL;
+    persistentToSAT = NULL;
   } 
 
-  ~STP()
-  {
-    ClearAllTables();
-
-    delete Ctr_Example;
-    Ctr_Example = NULL;
+  ~STP();
 
-    delete arrayTransformer;
-    arrayTransformer = NULL;
-
-    delete tosat;
-    tosat = NULL;
-
-    delete simp;
-    simp = NULL;
-    // delete bm;
-  }
+  // Drops the persistent solver and the preprocessed conjuncts of an
+  // incremental session, so the next query starts from scratch.
+  void ResetIncremental();
 
   // The absolute TopLevel function that invokes STP on the input
   // formula
@@ -126,6 +155,7 @@ public:
   // calls sizeReducing and the bitblasting simplification.
   ASTNode callSizeReducing(ASTNode simplified_solved_InputToSAT,
                            BVSolver* bvSolver, PropagateEqualities* pe,
+                           SizeReducingState& state,
                            const int initial_difficulty_score,
                            int& actualBBSize);
 
@@ -133,7 +163,9 @@ public:
   {
     if (simp != NULL)
       simp->ClearAllTables();
-    if (arrayTransformer != NULL)
+    // In incremental mode, reads that were removed for one query are
+    // referred to by the clauses already in the persistent solver.
+    if (arrayTransformer != NULL && persistentSolver == NULL)
       arrayTransformer->ClearAllTables();
     if (tosat != NULL)
       tosat->ClearAllTables();
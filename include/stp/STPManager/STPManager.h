@@ -29,7 +29,10 @@ THE SOFTWARE.
 #include "stp/STPManager/UserDefinedFlags.h"
 #include "stp/AST/AST.h"
 #include "stp/AST/NodeFactory/HashingNodeFactory.h"
+#include "stp/AST/UniqueTable.h"
+#include "stp/AST/WriteChainIndex.h"
 #include "stp/Sat/SATSolver.h"
+#include "stp/Util/SlabAllocator.h"
 
 namespace stp
 {
@@ -54,16 +57,20 @@ private:
    ****************************************************************/
 
   // Typedef for unique Interior node table.
-  typedef hash_set<ASTInterior*, ASTInterior::ASTInteriorHasher,
-                   ASTInterior::ASTInteriorEqual> ASTInteriorSet;
+  typedef UniqueTable<ASTInterior, ASTInterior::ASTInteriorEqual>
+      ASTInteriorSet;
 
   // Typedef for unique Symbol node (leaf) table.
-  typedef hash_set<ASTSymbol*, ASTSymbol::ASTSymbolHasher,
-                   ASTSymbol::ASTSymbolEqual> ASTSymbolSet;
+  typedef UniqueTable<ASTSymbol, ASTSymbol::ASTSymbolEqual> ASTSymbolSet;
 
   // Typedef for unique BVConst node (leaf) table.
-  typedef hash_set<ASTBVConst*, ASTBVConst::ASTBVConstHasher,
-                   ASTBVConst::ASTBVConstEqual> ASTBVConstSet;
+  typedef UniqueTable<ASTBVConst, ASTBVConst::ASTBVConstEqual> ASTBVConstSet;
+
+  // Memory for the nodes in the unique tables. Declared first so that they
+  // outlive the other members, which may hold nodes.
+  SlabAllocator<ASTInterior> _interior_pool;
+  SlabAllocator<ASTSymbol> _symbol_pool;
+  SlabAllocator<ASTBVConst> _bvconst_pool;
 
   // Unique node tables that enables common subexpression sharing
   ASTInteriorSet _interior_unique_table;
@@ -74,10 +81,20 @@ private:
   // Table to uniquefy bvconst
   ASTBVConstSet _bvconst_unique_table;
 
+  // Scratch space for sorting the children of a commutative node that
+  // arrive out of order. It keeps its capacity between lookups.
+  ASTVec _sorted_children;
+
+  // Interior nodes whose last reference has gone but whose children are still
+  // to be released. ASTInterior::CleanUp drains it in a loop, so freeing a
+  // long chain of nodes doesn't recurse once per node.
+  std::vector<ASTInterior*> _interior_cleanup_pending;
+  bool _interior_cleanup_running;
+
   // Global for assigning new node numbers.
   int _max_node_num;
 
-  uint8_t last_iteration;
+  uint32_t last_iteration;
 
 public:
   HashingNodeFactory* hashingNodeFactory;
@@ -86,19 +103,53 @@ public:
   // frequently used nodes
   ASTNode ASTFalse, ASTTrue, ASTUndefined;
 
+  // Lets the simplifying node factory read through long chains of writes
+  // to constant indexes without walking them.
+  WriteChainIndex writeChains;
+
   bool soft_timeout_expired;
 
+  // The time, as given by getCurrentTime(), after which the current query
+  // gives up. -1 if there's no deadline.
+  long timeout_deadline;
+
+  // Starts the clock for a query that may run for max_time milliseconds.
+  void startTimeout(int64_t max_time)
+  {
+    soft_timeout_expired = false;
+    timeout_deadline = (max_time < 0) ? -1 : getCurrentTime() + max_time;
+  }
+
+  // Reads the clock, so callers in tight loops should only call this every
+  // so often. Sets soft_timeout_expired once the deadline has passed.
+  bool checkTimeout()
+  {
+    if (!soft_timeout_expired && timeout_deadline >= 0 &&
+        getCurrentTime() >= timeout_deadline)
+      soft_timeout_expired = true;
+    return soft_timeout_expired;
+  }
+
+  // Milliseconds until the deadline, or -1 if there isn't one.
+  long timeoutRemaining()
+  {
+    if (timeout_deadline < 0)
+      return -1;
+    return std::max(0L, timeout_deadline - getCurrentTime());
+  }
+
   // No nodes should already have the iteration number that is returned from
-  // here. This never returns zero.
-  uint8_t getNextIteration()
+  // here. This never returns zero. The unique tables are only swept when
+  // the numbers run out, which takes 2^24 traversals.
+  uint32_t getNextIteration()
   {
-    if (last_iteration == 255)
+    if (last_iteration == ASTInternal::MaxIteration)
     {
       resetIteration();
       last_iteration = 0;
     }
 
-    uint8_t result = ++last_iteration;
+    uint32_t result = ++last_iteration;
     assert(result != 0);
     return result;
   }
@@ -151,15 +202,11 @@ private:
    * Private Member Functions                                     *
    ****************************************************************/
 
-  // Destructively appends back_child nodes to front_child nodes.
-  // If back_child nodes is NULL, no appending is done.  back_child
-  // nodes are not modified.  Then it returns the hashed copy of the
-  // node, which is created if necessary.
-  ASTInterior* CreateInteriorNode(Kind kind, ASTInterior* new_node,
-                                  const ASTVec& back_children = _empty_ASTVec);
-
-  // Create unique ASTInterior node.
-  ASTInterior* LookupOrCreateInterior(ASTInterior* n);
+  // Returns the unique ASTInterior node with this kind and children,
+  // creating it if necessary. If sortChildren is set, the children are
+  // put into the order that SortByArith gives first.
+  ASTInterior* LookupOrCreateInterior(Kind kind, const ASTVec& children,
+                                      bool sortChildren);
 
   // Create unique ASTSymbol node.
   ASTSymbol* LookupOrCreateSymbol(ASTSymbol& s);
@@ -223,8 +270,12 @@ public:
 
    
   STPMgr()
-      : _interior_unique_table(), _symbol_unique_table(),
-        _bvconst_unique_table(), last_iteration(0), soft_timeout_expired(false),
+      : _interior_pool(), _symbol_pool(), _bvconst_pool(),
+        _interior_unique_table(), _symbol_unique_table(),
+        _bvconst_unique_table(), _sorted_children(),
+        _interior_cleanup_pending(), _interior_cleanup_running(false),
+        last_iteration(0), soft_timeout_expired(false),
+        timeout_deadline(-1),
         UserFlags(), _symbol_count(0), CNFFileNameCounter(0)
   {
     _max_node_num = 0;
@@ -470,8 +521,26 @@ public:
     TermsAlreadySeenMap.clear();
     NodeLetVarVec.clear();
     ListOfDeclaredVars.clear();
+    writeChains.clear();
   } 
 
+  // Bytes taken by the nodes that are alive. The children of interior nodes
+  // aren't counted.
+  size_t NodeMemoryUsed() const
+  {
+    return _interior_pool.size() * sizeof(ASTInterior) +
+           _symbol_pool.size() * sizeof(ASTSymbol) +
+           _bvconst_pool.size() * sizeof(ASTBVConst);
+  }
+
+  // Gets the manager ready for an unrelated problem, keeping the memory
+  // that it already has. All the nodes of the last problem must have been
+  // released. Returns false if that didn't happen, or once MaxRecycledNodeNum
+  // node numbers have been handed out, in which case the manager should be
+  // deleted instead.
+  static const int MaxRecycledNodeNum = 1 << 22;
+  bool Recycle();
+
   ~STPMgr();
 
 }; 
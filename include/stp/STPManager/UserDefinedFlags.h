@@ -52,6 +52,9 @@ public:
 
   int64_t timeout_max_conflicts;
 
+  // Wall-clock milliseconds a query may run for. -1 means no limit.
+  int64_t timeout_max_time;
+
   // print DAG nodes
   bool print_nodes_flag;
 
@@ -65,6 +68,10 @@ public:
   bool ackermannisation; // eagerly write through the array's function
                          // congruence axioms.
 
+  // When eagerly encoding the congruence axioms, relate each array's reads
+  // through a sorting network on their indexes rather than nested ITEs.
+  bool sorted_ackermannisation;
+
 
   // check the counterexample against the original input to STP
   bool check_counterexample_flag;
@@ -151,11 +158,20 @@ public:
   {
     MINISAT_SOLVER = 0,
     SIMPLIFYING_MINISAT_SOLVER,
-    CRYPTOMINISAT4_SOLVER
+    CRYPTOMINISAT4_SOLVER,
+    PORTFOLIO_SOLVER
   };
 
   enum SATSolvers solver_to_use;
 
+  // How many solvers the portfolio solver races against each other.
+  int portfolio_workers;
+
+  // Keep a single SAT solver alive across queries. Each asserted formula is
+  // sent to it once, guarded by an activation literal that is assumed only
+  // while the formula is asserted.
+  bool incremental_flag;
+
   std::map<std::string, std::string> config_options;
 
   void set(std::string n, std::string v)
@@ -208,6 +224,7 @@ public:
   UserDefinedFlags()
   {
     timeout_max_conflicts = -1;
+    timeout_max_time = -1;
 
     // collect statistics on certain functions
     stats_flag = false;
@@ -223,6 +240,7 @@ public:
     // constraints to re-constraint the problem correctly, and call SAT again,
     // until all constraints have been added.
     ackermannisation = false;
+    sorted_ackermannisation = false;
 
     // flag to control write refinement
     // arraywrite_refinement_flag = true;
@@ -287,6 +305,9 @@ public:
 
     // use minisat by default.
     solver_to_use = MINISAT_SOLVER;
+    portfolio_workers = 4;
+
+    incremental_flag = false;
 
     // Should constant bit propagation be enabled?
     bitConstantProp_flag = true;
@@ -51,10 +51,17 @@ public:
 
   bool addClause(const vec_literals& ps); // Add a clause to the solver.
 
+  bool addClauses(const int* lits, const int* begins, int n);
+
   bool okay() const; // FALSE means solver is in a conflicting state
 
   bool solve(bool& timeout_expired); // Search without assumptions.
 
+  void interrupt();
+
+  bool solveWithAssumptions(bool& timeout_expired,
+                            const vec_literals& assumptions);
+
   virtual uint8_t modelValue(uint32_t x) const;
 
   virtual uint32_t newVar();
@@ -54,6 +54,12 @@ public:
 
   bool solve(bool& timeout_expired); // Search without assumptions.
 
+  void interrupt();
+  void clearInterrupt();
+
+  bool solveWithAssumptions(bool& timeout_expired,
+                            const vec_literals& assumptions);
+
   virtual void setMaxConflicts(int64_t max_confl);
 
   virtual bool simplify(); // Removes already satisfied clauses.
@@ -70,8 +76,14 @@ public:
 
   void printStats() const;
 
+  uint64_t nConflicts() const;
+  uint64_t nDecisions() const;
+  uint64_t nPropagations() const;
+
   virtual void setSeed(int i);
 
+  virtual void setDiversity(int k);
+
   virtual lbool true_literal() { return ((uint8_t)0); }
   virtual lbool false_literal() { return ((uint8_t)1); }
   virtual lbool undef_literal() { return ((uint8_t)2); }
@@ -0,0 +1,104 @@
+// -*- c++ -*-
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+#ifndef PORTFOLIOSOLVER_H_
+#define PORTFOLIOSOLVER_H_
+
+#include "SATSolver.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace stp
+{
+// Gives every clause to several differently configured SAT solvers, then
+// runs them on their own threads. The first to finish gives the answer and
+// the others are interrupted. Worker i uses backend i mod (number of
+// backends), and workers after the first lap get a diversity of
+// i / (number of backends), so that they search differently.
+class PortfolioSolver : public SATSolver // not copyable
+{
+  struct Worker
+  {
+    SATSolver* solver;
+    int diversity;
+    bool seedable; // CryptoMiniSat doesn't take a seed.
+  };
+
+  std::vector<Worker> workers;
+
+  // Which worker answered the last search, or -1.
+  int winner;
+  bool winner_result;
+  std::mutex lock;
+
+  // Set by interrupt() from outside, e.g. by the SolverWatchdog.
+  std::atomic<bool> interrupted;
+
+  void run(size_t i, const vec_literals* assumptions);
+  bool search(bool& timeout_expired, const vec_literals* assumptions);
+
+public:
+  explicit PortfolioSolver(int number_of_workers);
+
+  ~PortfolioSolver();
+
+  bool addClause(const vec_literals& ps); // Add a clause to the solver.
+
+  bool okay() const; // FALSE means solver is in a conflicting state
+
+  bool solve(bool& timeout_expired); // Search without assumptions.
+
+  bool solveWithAssumptions(bool& timeout_expired,
+                            const vec_literals& assumptions);
+
+  void interrupt();
+  void clearInterrupt();
+
+  virtual void setMaxConflicts(int64_t max_confl);
+
+  virtual bool simplify();
+
+  virtual uint8_t modelValue(uint32_t x) const;
+
+  virtual uint32_t newVar();
+
+  void setVerbosity(int v);
+
+  unsigned long nVars() const;
+
+  void printStats() const;
+
+  uint64_t nConflicts() const;
+  uint64_t nDecisions() const;
+  uint64_t nPropagations() const;
+
+  virtual void setSeed(int i);
+
+  virtual void setFrozen(uint32_t x);
+
+  virtual lbool true_literal() { return ((uint8_t)0); }
+  virtual lbool false_literal() { return ((uint8_t)1); }
+  virtual lbool undef_literal() { return ((uint8_t)2); }
+};
+}
+
+#endif
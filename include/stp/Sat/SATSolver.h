@@ -51,10 +51,41 @@ public:
   virtual bool addClause(
       const SATSolver::vec_literals& ps) = 0; // Add a clause to the solver.
 
+  // Adds n clauses at once. Clause i is lits[begins[i]] up to
+  // lits[begins[i+1]], with each literal encoded as mkLit() does.
+  virtual bool addClauses(const int* lits, const int* begins, int n)
+  {
+    vec_literals clause;
+    for (int i = 0; i < n; i++)
+    {
+      clause.clear();
+      for (int j = begins[i]; j < begins[i + 1]; j++)
+      {
+        Minisat::Lit l;
+        l.x = lits[j];
+        clause.push(l);
+      }
+      if (!addClause(clause))
+        return false;
+    }
+    return true;
+  }
+
   virtual bool okay() const = 0; // FALSE means solver is in a conflicting state
 
   virtual bool solve(bool& timeout_expired) = 0; // Search without assumptions.
 
+  // Search with the given literals assumed true. Unlike solve(), a false
+  // result leaves the solver usable, so that clauses guarded by an assumption
+  // can be switched off again for later queries.
+  virtual bool solveWithAssumptions(bool& timeout_expired,
+                                    const vec_literals& assumptions)
+  {
+    std::cerr << "Solving under assumptions is not supported by this SAT solver"
+              << std::endl;
+    exit(1);
+  }
+
   typedef uint8_t lbool;
 
   static inline Minisat::Lit mkLit(uint32_t var, bool sign)
@@ -64,6 +95,7 @@ public:
     return p;
   }
 
+  // A negative value removes any limit.
   virtual void setMaxConflicts(int64_t max_confl)
   {
     std::cerr
@@ -79,6 +111,12 @@ public:
 
   virtual void printStats() const = 0;
 
+  // Search statistics since the solver was made, for profiling. Solvers that
+  // don't keep them return zero.
+  virtual uint64_t nConflicts() const { return 0; }
+  virtual uint64_t nDecisions() const { return 0; }
+  virtual uint64_t nPropagations() const { return 0; }
+
   virtual void setSeed(int i)
   {
     std::cerr << "Setting the random seen is not implemented for this solver"
@@ -92,6 +130,17 @@ public:
   virtual lbool false_literal() = 0;
   virtual lbool undef_literal() = 0;
 
+  // Asks a running search to stop as soon as it can, which it reports as a
+  // timeout. Safe to call from another thread.
+  virtual void interrupt() {}
+
+  // Withdraws an interrupt, so that later searches aren't stopped by it.
+  virtual void clearInterrupt() {}
+
+  // Varies the search heuristics, so that copies of a solver that are given
+  // the same clauses search differently. Zero keeps the defaults.
+  virtual void setDiversity(int k) {}
+
   // The simplifying solvers shouldn't eliminate index / value variables.
   virtual void setFrozen(uint32_t x) {}
 
@@ -49,6 +49,12 @@ public:
 
   bool solve(bool& timeout_expired); // Search without assumptions.
 
+  void interrupt();
+  void clearInterrupt();
+
+  bool solveWithAssumptions(bool& timeout_expired,
+                            const vec_literals& assumptions);
+
   bool simplify(); // Removes already satisfied clauses.
 
   virtual void setMaxConflicts(int64_t max_confl);
@@ -63,8 +69,14 @@ public:
 
   void printStats() const;
 
+  uint64_t nConflicts() const;
+  uint64_t nDecisions() const;
+  uint64_t nPropagations() const;
+
   virtual void setSeed(int i);
 
+  virtual void setDiversity(int k);
+
   virtual lbool true_literal() { return ((uint8_t)0); }
   virtual lbool false_literal() { return ((uint8_t)1); }
   virtual lbool undef_literal() { return ((uint8_t)2); }
@@ -0,0 +1,58 @@
+// -*- c++ -*-
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+#ifndef SOLVERWATCHDOG_H_
+#define SOLVERWATCHDOG_H_
+
+#include "SATSolver.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace stp
+{
+// The SAT solvers can't read the clock during search. While one of these is
+// alive, a thread waits for the time limit to pass, then interrupts the
+// solver, so that a query with a time limit stops soon after the limit even
+// if it's in the middle of a long search.
+class SolverWatchdog // not copyable
+{
+  SATSolver& solver;
+  bool finished;
+  bool fired;
+  std::mutex lock;
+  std::condition_variable wake;
+  std::thread watcher;
+
+  void watch(long milliseconds);
+
+  SolverWatchdog(const SolverWatchdog&);
+  void operator=(const SolverWatchdog&);
+
+public:
+  // A negative time limit means there's nothing to watch for.
+  SolverWatchdog(SATSolver& s, long milliseconds);
+
+  ~SolverWatchdog();
+};
+}
+
+#endif
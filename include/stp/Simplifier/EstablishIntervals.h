@@ -24,7 +24,12 @@ THE SOFTWARE.
 ********************************************************************/
 
 /*
- * Performs a basic unsigned interval analysis.
+ * Performs an interval analysis. Comparisons that are asserted at the top
+ * level bound their operands. Those bounds are pushed down through the
+ * operations that can be inverted on intervals, then forward again, for a
+ * few rounds. Signed comparisons give signed bounds, which are kept apart
+ * from the unsigned ones since a signed interval that spans zero is two
+ * unsigned intervals.
  */
 
 #ifndef ESTABLISHINTERVALS_H_
@@ -87,6 +92,14 @@ private:
       assert(!isComplete());
     }
 
+    // Whether the minimum and maximum have the same sign. If so, the signed
+    // order of the values in the interval is the same as the unsigned order.
+    bool sameSign(int width)
+    {
+      return CONSTANTBV::BitVector_bit_test(minV, width - 1) ==
+             CONSTANTBV::BitVector_bit_test(maxV, width - 1);
+    }
+
     // If the interval is interpreted as a clockwise interval.
     bool crossesSignedUnsigned(int width)
     {
@@ -105,6 +118,49 @@ private:
   vector<EstablishIntervals::IntervalType*> toDeleteLater;
   vector<CBV> likeAutoPtr;
 
+  // Bounds on terms that follow from the top-level conjuncts.
+  map<const ASTNode, IntervalType*> constraints;
+
+  // Signed bounds on terms that follow from the top-level conjuncts. The
+  // minimum and maximum are compared as signed numbers.
+  map<const ASTNode, IntervalType*> signedConstraints;
+
+  // Terms whose bounds have changed, so might bound their operands.
+  vector<ASTNode> pending;
+
+  // The conjuncts that the bounds came from, in the order they appear.
+  ASTVec usedConjuncts;
+  ASTNodeSet usedSet;
+
+  // Set if a term has been bounded to an empty interval.
+  bool unsatisfiable;
+
+  // Intervals found without the top-level bounds. These depend only on the
+  // node, so they're kept between calls to topLevel_unsignedIntervals.
+  map<const ASTNode, IntervalType*> forward;
+  map<const ASTNode, IntervalType*> forwardClockwise;
+
+  // Copies the intervals of the nodes reachable from top out of forward.
+  void restrictTo(const ASTNode& top,
+                  map<const ASTNode, IntervalType*>& visited)
+  {
+    vector<ASTNode> stack;
+    stack.push_back(top);
+    while (!stack.empty())
+    {
+      const ASTNode n = stack.back();
+      stack.pop_back();
+
+      map<const ASTNode, IntervalType*>::const_iterator it = forward.find(n);
+      assert(it != forward.end());
+      if (!visited.insert(*it).second)
+        continue;
+
+      for (size_t i = 0; i < n.Degree(); i++)
+        stack.push_back(n[i]);
+    }
+  }
+
   IntervalType* freshUnsignedInterval(int width)
   {
     assert(width > 0);
@@ -127,6 +183,632 @@ private:
     return result;
   }
 
+  CBV copyCBV(CBV from, int width)
+  {
+    CBV result = makeCBV(width);
+    CONSTANTBV::BitVector_Copy(result, from);
+    return result;
+  }
+
+  CBV onesCBV(int width)
+  {
+    CBV result = makeCBV(width);
+    CONSTANTBV::BitVector_Fill(result);
+    return result;
+  }
+
+  CBV maxSigned(int width)
+  {
+    CBV result = onesCBV(width);
+    CONSTANTBV::BitVector_Bit_Off(result, width - 1);
+    return result;
+  }
+
+  CBV minSigned(int width)
+  {
+    CBV result = makeCBV(width);
+    CONSTANTBV::BitVector_Bit_On(result, width - 1);
+    return result;
+  }
+
+  // The low "to" bits of from, or from zero extended to "to" bits.
+  CBV resized(CBV from, int fromWidth, int to)
+  {
+    CBV result = makeCBV(to);
+    CONSTANTBV::BitVector_Interval_Copy(result, from, 0, 0,
+                                        std::min(fromWidth, to));
+    return result;
+  }
+
+  // a / b, rounded down. b isn't zero.
+  CBV divide(CBV a, CBV b, int width, bool& exact)
+  {
+    CBV q = makeCBV(width);
+    CBV r = makeCBV(width);
+    CONSTANTBV::ErrCode e = CONSTANTBV::BitVector_Div_Pos(
+        q, copyCBV(a, width), copyCBV(b, width), r);
+    assert(0 == e);
+    exact = CONSTANTBV::BitVector_is_empty(r);
+    return q;
+  }
+
+  // The interval found for n, or NULL if it could be anything.
+  IntervalType* knownInterval(const ASTNode& n,
+                              map<const ASTNode, IntervalType*>& visited)
+  {
+    map<const ASTNode, IntervalType*>::const_iterator it = visited.find(n);
+    return it == visited.end() ? NULL : it->second;
+  }
+
+  IntervalType* intervalOf(const ASTNode& n,
+                           map<const ASTNode, IntervalType*>& visited)
+  {
+    map<const ASTNode, IntervalType*>::const_iterator it = visited.find(n);
+    if (it == visited.end() || it->second == NULL)
+      return freshUnsignedInterval(n.GetValueWidth());
+    return it->second;
+  }
+
+  // The values that are in both "a" and "b". "a" may be NULL, meaning
+  // everything.
+  IntervalType* intersect(IntervalType* a, IntervalType* b)
+  {
+    if (a == NULL)
+      return b;
+
+    CBV min = CONSTANTBV::BitVector_Lexicompare(a->minV, b->minV) >= 0
+                  ? a->minV
+                  : b->minV;
+    CBV max = CONSTANTBV::BitVector_Lexicompare(a->maxV, b->maxV) <= 0
+                  ? a->maxV
+                  : b->maxV;
+
+    if (CONSTANTBV::BitVector_Lexicompare(min, max) > 0)
+    {
+      unsatisfiable = true;
+      return a;
+    }
+
+    if (min == a->minV && max == a->maxV)
+      return a;
+    return createInterval(min, max);
+  }
+
+  // As intersect(), for signed intervals. "a" isn't NULL.
+  IntervalType* intersectSigned(IntervalType* a, IntervalType* b)
+  {
+    CBV min = CONSTANTBV::BitVector_Compare(a->minV, b->minV) >= 0 ? a->minV
+                                                                   : b->minV;
+    CBV max = CONSTANTBV::BitVector_Compare(a->maxV, b->maxV) <= 0 ? a->maxV
+                                                                   : b->maxV;
+
+    if (CONSTANTBV::BitVector_Compare(min, max) > 0)
+    {
+      unsatisfiable = true;
+      return a;
+    }
+
+    if (min == a->minV && max == a->maxV)
+      return a;
+    return createInterval(min, max);
+  }
+
+  // The values of the unsigned interval "u" that are in the signed interval
+  // "s". A signed interval from a negative number to a positive one is, as
+  // unsigned numbers, [0,max] and [min,2^width-1], so it only narrows "u"
+  // when "u" is within one of the two.
+  IntervalType* intersectWithSigned(IntervalType* u, IntervalType* s,
+                                    int width)
+  {
+    if (s->sameSign(width))
+      return intersect(u, s);
+
+    if (u == NULL)
+      return NULL;
+    if (CONSTANTBV::BitVector_Lexicompare(u->maxV, s->minV) < 0)
+      return intersect(u, createInterval(makeCBV(width), s->maxV));
+    if (CONSTANTBV::BitVector_Lexicompare(u->minV, s->maxV) > 0)
+      return intersect(u, createInterval(s->minV, onesCBV(width)));
+    return u;
+  }
+
+  // The signed interval of n, from its unsigned interval when that doesn't
+  // span the sign boundary, and from its signed bounds.
+  IntervalType* signedIntervalOf(const ASTNode& n,
+                                 map<const ASTNode, IntervalType*>& visited)
+  {
+    const int width = n.GetValueWidth();
+    IntervalType* result = knownInterval(n, visited);
+    if (result == NULL || !result->sameSign(width))
+      result = createInterval(minSigned(width), maxSigned(width));
+
+    map<const ASTNode, IntervalType*>::const_iterator it =
+        signedConstraints.find(n);
+    if (it != signedConstraints.end())
+      result = intersectSigned(result, it->second);
+    return result;
+  }
+
+  // Records that "n" is in [min,max]. Returns true if that is tighter than
+  // the interval that the last pass found for "n".
+  bool narrow(const ASTNode& n, CBV min, CBV max,
+              map<const ASTNode, IntervalType*>& visited)
+  {
+    if (n.isConstant())
+      return false;
+
+    if (CONSTANTBV::BitVector_Lexicompare(min, max) > 0)
+    {
+      unsatisfiable = true;
+      return false;
+    }
+
+    IntervalType* known = intervalOf(n, visited);
+    if (CONSTANTBV::BitVector_Lexicompare(min, known->minV) <= 0 &&
+        CONSTANTBV::BitVector_Lexicompare(max, known->maxV) >= 0)
+      return false;
+
+    const int width = n.GetValueWidth();
+    IntervalType* bound =
+        createInterval(copyCBV(min, width), copyCBV(max, width));
+
+    map<const ASTNode, IntervalType*>::iterator it = constraints.find(n);
+    if (it == constraints.end())
+      constraints.insert(make_pair(n, bound));
+    else
+      it->second = intersect(it->second, bound);
+    pending.push_back(n);
+    return true;
+  }
+
+  // Records that "n" is in the signed interval [min,max]. If that leaves "n"
+  // on one side of the sign boundary, it's an unsigned bound too.
+  bool narrowSigned(const ASTNode& n, CBV min, CBV max,
+                    map<const ASTNode, IntervalType*>& visited)
+  {
+    if (n.isConstant())
+      return false;
+
+    if (CONSTANTBV::BitVector_Compare(min, max) > 0)
+    {
+      unsatisfiable = true;
+      return false;
+    }
+
+    IntervalType* known = signedIntervalOf(n, visited);
+    if (CONSTANTBV::BitVector_Compare(min, known->minV) <= 0 &&
+        CONSTANTBV::BitVector_Compare(max, known->maxV) >= 0)
+      return false;
+
+    const int width = n.GetValueWidth();
+    IntervalType* bound =
+        createInterval(copyCBV(min, width), copyCBV(max, width));
+
+    map<const ASTNode, IntervalType*>::iterator it =
+        signedConstraints.find(n);
+    if (it == signedConstraints.end())
+      signedConstraints.insert(make_pair(n, bound));
+    else
+      it->second = intersectSigned(it->second, bound);
+
+    IntervalType* now = intersectSigned(known, bound);
+    if (!unsatisfiable && now->sameSign(width))
+      narrow(n, now->minV, now->maxV, visited);
+    return true;
+  }
+
+  // big > small (if strict), or big >= small, unsigned.
+  bool learnUnsigned(const ASTNode& big, const ASTNode& small, bool strict,
+                     map<const ASTNode, IntervalType*>& visited)
+  {
+    const int width = big.GetValueWidth();
+    CBV lo = copyCBV(intervalOf(small, visited)->minV, width);
+    CBV hi = copyCBV(intervalOf(big, visited)->maxV, width);
+
+    if (strict)
+    {
+      if (CONSTANTBV::BitVector_is_full(lo) ||
+          CONSTANTBV::BitVector_is_empty(hi))
+      {
+        unsatisfiable = true;
+        return false;
+      }
+      CONSTANTBV::BitVector_increment(lo);
+      CONSTANTBV::BitVector_decrement(hi);
+    }
+
+    CBV zero = makeCBV(width);
+    CBV max = makeCBV(width);
+    CONSTANTBV::BitVector_Fill(max);
+
+    bool learnt = narrow(big, lo, max, visited);
+    if (narrow(small, zero, hi, visited))
+      learnt = true;
+    return learnt;
+  }
+
+  // big > small (if strict), or big >= small, signed.
+  bool learnSigned(const ASTNode& big, const ASTNode& small, bool strict,
+                   map<const ASTNode, IntervalType*>& visited)
+  {
+    const int width = big.GetValueWidth();
+    CBV lo = copyCBV(signedIntervalOf(small, visited)->minV, width);
+    CBV hi = copyCBV(signedIntervalOf(big, visited)->maxV, width);
+
+    if (strict)
+    {
+      // Nothing is greater than the largest positive number, or less than
+      // the smallest negative number.
+      if (CONSTANTBV::BitVector_Compare(lo, maxSigned(width)) == 0 ||
+          CONSTANTBV::BitVector_Compare(hi, minSigned(width)) == 0)
+      {
+        unsatisfiable = true;
+        return false;
+      }
+      CONSTANTBV::BitVector_increment(lo);
+      CONSTANTBV::BitVector_decrement(hi);
+    }
+
+    bool learnt = narrowSigned(big, lo, maxSigned(width), visited);
+    if (narrowSigned(small, minSigned(width), hi, visited))
+      learnt = true;
+    return learnt;
+  }
+
+  // n is the sum of its children. If only one child isn't constant, it's n
+  // less the constants, unless that wraps around. Otherwise, if the sum
+  // can't overflow, each child is n less the sum of the others.
+  bool boundAddends(const ASTNode& n, IntervalType* bound,
+                    map<const ASTNode, IntervalType*>& visited)
+  {
+    const int width = n.GetValueWidth();
+    const int wide = width + 32; // Holds the sum of the children.
+
+    vector<IntervalType*> addends;
+    addends.reserve(n.Degree());
+    CBV sumMin = makeCBV(wide);
+    CBV sumMax = makeCBV(wide);
+    CBV constants = makeCBV(width);
+    int variables = 0;
+    size_t variable = 0;
+
+    for (size_t i = 0; i < n.Degree(); i++)
+    {
+      IntervalType* a = intervalOf(n[i], visited);
+      addends.push_back(a);
+
+      bool carry = false;
+      CONSTANTBV::BitVector_add(sumMin, sumMin, resized(a->minV, width, wide),
+                                &carry);
+      carry = false;
+      CONSTANTBV::BitVector_add(sumMax, sumMax, resized(a->maxV, width, wide),
+                                &carry);
+
+      if (a->isConstant())
+      {
+        carry = false;
+        CONSTANTBV::BitVector_add(constants, constants, a->minV, &carry);
+      }
+      else
+      {
+        variables++;
+        variable = i;
+      }
+    }
+
+    if (variables == 0)
+      return false;
+
+    if (variables == 1)
+    {
+      bool borrow = false;
+      CBV lo = makeCBV(width);
+      CBV hi = makeCBV(width);
+      CONSTANTBV::BitVector_sub(lo, bound->minV, constants, &borrow);
+      borrow = false;
+      CONSTANTBV::BitVector_sub(hi, bound->maxV, constants, &borrow);
+      if (CONSTANTBV::BitVector_Lexicompare(lo, hi) > 0)
+        return false; // Wraps around.
+      return narrow(n[variable], lo, hi, visited);
+    }
+
+    if (CONSTANTBV::BitVector_Lexicompare(
+            sumMax, resized(onesCBV(width), width, wide)) > 0)
+      return false;
+
+    CBV boundMin = resized(bound->minV, width, wide);
+    CBV boundMax = resized(bound->maxV, width, wide);
+    bool learnt = false;
+    for (size_t i = 0; i < n.Degree() && !unsatisfiable; i++)
+    {
+      if (addends[i]->isConstant())
+        continue;
+
+      bool borrow = false;
+      CBV othersMin = makeCBV(wide);
+      CBV othersMax = makeCBV(wide);
+      CONSTANTBV::BitVector_sub(othersMin, sumMin,
+                                resized(addends[i]->minV, width, wide),
+                                &borrow);
+      borrow = false;
+      CONSTANTBV::BitVector_sub(othersMax, sumMax,
+                                resized(addends[i]->maxV, width, wide),
+                                &borrow);
+
+      CBV lo = makeCBV(wide);
+      CBV hi = makeCBV(wide);
+      borrow = false;
+      CONSTANTBV::BitVector_sub(lo, boundMin, othersMax, &borrow);
+      if (borrow)
+        CONSTANTBV::BitVector_Empty(lo);
+      borrow = false;
+      CONSTANTBV::BitVector_sub(hi, boundMax, othersMin, &borrow);
+      if (borrow)
+      {
+        // The others are always more than n.
+        unsatisfiable = true;
+        return false;
+      }
+
+      if (narrow(n[i], resized(lo, wide, width), resized(hi, wide, width),
+                 visited))
+        learnt = true;
+    }
+    return learnt;
+  }
+
+  // n is c * a. If c * a can't overflow, a is n / c.
+  bool boundMultiplicand(const ASTNode& a, const ASTNode& c,
+                         IntervalType* bound,
+                         map<const ASTNode, IntervalType*>& visited)
+  {
+    const int width = a.GetValueWidth();
+    CBV k = c.GetBVConst();
+    if (CONSTANTBV::BitVector_is_empty(k))
+      return false;
+
+    bool exact;
+    CBV largest = divide(onesCBV(width), k, width, exact);
+    if (CONSTANTBV::BitVector_Lexicompare(intervalOf(a, visited)->maxV,
+                                          largest) > 0)
+      return false;
+
+    CBV lo = divide(bound->minV, k, width, exact);
+    if (!exact)
+      CONSTANTBV::BitVector_increment(lo);
+    CBV hi = divide(bound->maxV, k, width, exact);
+    return narrow(a, lo, hi, visited);
+  }
+
+  // Pushes the bound on n down to its operands, for the operations that can
+  // be inverted on intervals.
+  bool boundOperands(const ASTNode& n, IntervalType* bound,
+                     map<const ASTNode, IntervalType*>& visited)
+  {
+    const int width = n.GetValueWidth();
+    switch (n.GetKind())
+    {
+      case BVPLUS:
+        return boundAddends(n, bound, visited);
+
+      case BVMULT:
+        if (n.Degree() == 2 && n[0].GetKind() == BVCONST)
+          return boundMultiplicand(n[1], n[0], bound, visited);
+        if (n.Degree() == 2 && n[1].GetKind() == BVCONST)
+          return boundMultiplicand(n[0], n[1], bound, visited);
+        return false;
+
+      case BVLEFTSHIFT:
+      case BVRIGHTSHIFT:
+      {
+        if (n[1].GetKind() != BVCONST ||
+            CONSTANTBV::Set_Max(n[1].GetBVConst()) >= 32)
+          return false;
+        const unsigned shift = *(n[1].GetBVConst());
+        if (shift >= (unsigned)width)
+          return false;
+
+        CBV lo = copyCBV(bound->minV, width);
+        CBV hi = copyCBV(bound->maxV, width);
+        if (n.GetKind() == BVLEFTSHIFT)
+        {
+          // Unless the top bits of n[0] can be shifted out, n[0] is n / 2^shift.
+          if (CONSTANTBV::Set_Max(intervalOf(n[0], visited)->maxV) >=
+              (long)(width - shift))
+            return false;
+          CONSTANTBV::BitVector_Move_Right(lo, shift);
+          CBV back = copyCBV(lo, width);
+          CONSTANTBV::BitVector_Move_Left(back, shift);
+          if (CONSTANTBV::BitVector_Lexicompare(back, bound->minV) != 0)
+            CONSTANTBV::BitVector_increment(lo);
+          CONSTANTBV::BitVector_Move_Right(hi, shift);
+        }
+        else
+        {
+          // The top "shift" bits of n are zero.
+          if (CONSTANTBV::Set_Max(lo) >= (long)(width - shift))
+          {
+            unsatisfiable = true;
+            return false;
+          }
+          CONSTANTBV::BitVector_Move_Left(lo, shift);
+          if (CONSTANTBV::Set_Max(hi) >= (long)(width - shift))
+            CONSTANTBV::BitVector_Fill(hi);
+          else if (shift > 0)
+          {
+            CONSTANTBV::BitVector_Move_Left(hi, shift);
+            CONSTANTBV::BitVector_Interval_Fill(hi, 0, shift - 1);
+          }
+        }
+        return narrow(n[0], lo, hi, visited);
+      }
+
+      case BVEXTRACT:
+      {
+        const ASTNode& a = n[0];
+        const int aWidth = a.GetValueWidth();
+        const unsigned high = n[1].GetUnsignedConst();
+        const unsigned low = n[2].GetUnsignedConst();
+
+        if (high == (unsigned)aWidth - 1)
+        {
+          // The top bits: a is n followed by anything.
+          CBV lo = makeCBV(aWidth);
+          CBV hi = onesCBV(aWidth);
+          CONSTANTBV::BitVector_Interval_Copy(lo, bound->minV, low, 0, width);
+          CONSTANTBV::BitVector_Interval_Copy(hi, bound->maxV, low, 0, width);
+          return narrow(a, lo, hi, visited);
+        }
+
+        // The bottom bits, when the bits above are zero: a is n.
+        if (low == 0 &&
+            CONSTANTBV::Set_Max(intervalOf(a, visited)->maxV) <= (long)high)
+          return narrow(a, resized(bound->minV, width, aWidth),
+                        resized(bound->maxV, width, aWidth), visited);
+        return false;
+      }
+
+      case BVCONCAT:
+      {
+        // n is top followed by bottom.
+        const ASTNode& top = n[0];
+        const ASTNode& bottom = n[1];
+        const int bottomWidth = bottom.GetValueWidth();
+        const int topWidth = top.GetValueWidth();
+
+        CBV minTop = makeCBV(topWidth);
+        CBV maxTop = makeCBV(topWidth);
+        CONSTANTBV::BitVector_Interval_Copy(minTop, bound->minV, 0,
+                                            bottomWidth, topWidth);
+        CONSTANTBV::BitVector_Interval_Copy(maxTop, bound->maxV, 0,
+                                            bottomWidth, topWidth);
+        bool learnt = narrow(top, minTop, maxTop, visited);
+        if (unsatisfiable)
+          return false;
+
+        // When the top is known, the bound's low bits bound the bottom at
+        // the ends of the range.
+        IntervalType* t = intervalOf(top, visited);
+        if (!t->isConstant())
+          return learnt;
+        CBV lo = makeCBV(bottomWidth);
+        CBV hi = onesCBV(bottomWidth);
+        if (CONSTANTBV::BitVector_Lexicompare(t->minV, minTop) == 0)
+          lo = resized(bound->minV, width, bottomWidth);
+        if (CONSTANTBV::BitVector_Lexicompare(t->minV, maxTop) == 0)
+          hi = resized(bound->maxV, width, bottomWidth);
+        if (narrow(bottom, lo, hi, visited))
+          learnt = true;
+        return learnt;
+      }
+
+      case BVSX:
+      {
+        // Sign extending keeps the signed value, so a is n if n's values fit.
+        const ASTNode& a = n[0];
+        const int aWidth = a.GetValueWidth();
+        if (!bound->sameSign(width))
+          return false;
+
+        CBV lo = copyCBV(bound->minV, width);
+        CBV hi = copyCBV(bound->maxV, width);
+        if (!CONSTANTBV::BitVector_bit_test(hi, width - 1))
+        {
+          CBV limit = resized(maxSigned(aWidth), aWidth, width);
+          if (CONSTANTBV::BitVector_Lexicompare(hi, limit) > 0)
+            hi = limit;
+        }
+        else
+        {
+          // The smallest negative number of a's width, sign extended.
+          CBV limit = makeCBV(width);
+          CONSTANTBV::BitVector_Interval_Fill(limit, aWidth - 1, width - 1);
+          if (CONSTANTBV::BitVector_Lexicompare(lo, limit) < 0)
+            lo = limit;
+        }
+        return narrow(a, resized(lo, width, aWidth), resized(hi, width, aWidth),
+                      visited);
+      }
+
+      default:
+        return false;
+    }
+  }
+
+  // Pushes the bounds learnt for terms down to their operands, and theirs
+  // to their operands, and so on. Returns true if any operand is bounded
+  // more tightly than the last pass found.
+  bool propagateDown(map<const ASTNode, IntervalType*>& visited)
+  {
+    // A term bounded by several parents is looked at again, but not forever.
+    const int maxVisits = 4;
+    ASTNodeCountMap visits;
+
+    bool changed = false;
+    while (!pending.empty() && !unsatisfiable)
+    {
+      const ASTNode n = pending.back();
+      pending.pop_back();
+      if (++visits[n] > maxVisits)
+        continue;
+
+      IntervalType* bound =
+          intersect(knownInterval(n, visited), constraints.find(n)->second);
+      if (!unsatisfiable && boundOperands(n, bound, visited))
+        changed = true;
+    }
+    pending.clear();
+    return changed;
+  }
+
+  // Bounds the operands of comparisons that are asserted at the top level.
+  // Returns true if any bound is tighter than what the last pass found.
+  bool learnBounds(const ASTVec& conjuncts,
+                   map<const ASTNode, IntervalType*>& visited)
+  {
+    bool changed = false;
+    for (size_t i = 0; i < conjuncts.size() && !unsatisfiable; i++)
+    {
+      const ASTNode& c = conjuncts[i];
+      const bool negated = (c.GetKind() == NOT);
+      const ASTNode& f = negated ? c[0] : c;
+      const Kind k = f.GetKind();
+
+      bool learnt = false;
+      if (k == EQ && !negated && f[0].GetType() == BITVECTOR_TYPE)
+      {
+        IntervalType* i0 = intervalOf(f[0], visited);
+        IntervalType* i1 = intervalOf(f[1], visited);
+        learnt = narrow(f[0], i1->minV, i1->maxV, visited);
+        if (narrow(f[1], i0->minV, i0->maxV, visited))
+          learnt = true;
+      }
+      else if (k == BVGT || k == BVGE || k == BVSGT || k == BVSGE)
+      {
+        // not(a > b) is b >= a, and not(a >= b) is b > a.
+        ASTNode big = negated ? f[1] : f[0];
+        ASTNode small = negated ? f[0] : f[1];
+        const bool strict = ((k == BVGT || k == BVSGT) != negated);
+
+        if (k == BVGT || k == BVGE)
+          learnt = learnUnsigned(big, small, strict, visited);
+        else
+          learnt = learnSigned(big, small, strict, visited);
+      }
+
+      if (learnt)
+      {
+        changed = true;
+        if (usedSet.insert(c).second)
+          usedConjuncts.push_back(c);
+      }
+    }
+
+    if (!unsatisfiable && propagateDown(visited))
+      changed = true;
+    return changed;
+  }
+
   // A special version that handles the lhs appearing in the rhs of the fromTo
   // map.
   ASTNode replace(const ASTNode& n, ASTNodeMap& fromTo, ASTNodeMap& cache)
@@ -174,14 +856,53 @@ private:
   }
 
 public:
-  // Replace some of the things that unsigned intervals can figure out for us.
-  // Reduce from signed to unsigned if possible.
+  // Replace some of the things that intervals can figure out for us. Reduce
+  // from signed to unsigned if possible.
   ASTNode topLevel_unsignedIntervals(const ASTNode& top)
   {
     bm.GetRunTimes()->start(RunTimes::IntervalPropagation);
+
+    // The bounds were learnt from the last problem, which has gone.
+    constraints.clear();
+    signedConstraints.clear();
+    pending.clear();
+    usedConjuncts.clear();
+    usedSet.clear();
+    unsatisfiable = false;
+
     map<const ASTNode, IntervalType*> visited;
     map<const ASTNode, IntervalType*> clockwise;
-    visit(top, visited, clockwise);
+    visit(top, forward, forwardClockwise);
+    restrictTo(top, visited);
+
+    // The asserts and the query can arrive as nested ANDs.
+    ASTVec conjuncts;
+    if (top.GetKind() == AND)
+      conjuncts = FlattenKind(AND, top.GetChildren());
+    else
+      conjuncts.push_back(top);
+
+    // Bounds learnt from the top-level comparisons are pushed down to the
+    // operands, then forward again, which may give tighter bounds, and so
+    // on. Two terms bounding each other can shrink by one each round, so
+    // stop after a few.
+    const int maxRounds = 10;
+    for (int round = 0; round < maxRounds && !unsatisfiable &&
+                        learnBounds(conjuncts, visited);
+         round++)
+    {
+      visited.clear();
+      clockwise.clear();
+      visit(top, visited, clockwise);
+    }
+    bm.GetRunTimes()->addCounter("Interval bounds learnt",
+                                 constraints.size() + signedConstraints.size());
+
+    if (unsatisfiable)
+    {
+      bm.GetRunTimes()->stop(RunTimes::IntervalPropagation);
+      return bm.ASTFalse;
+    }
     ASTNodeMap fromTo;
     ASTNodeMap onePass;
     for (map<const ASTNode, IntervalType*>::const_iterator it = visited.begin();
@@ -359,10 +1080,28 @@ public:
     if (fromTo.size() > 0)
     {
       ASTNodeMap cache;
+      result = SubstitutionMap::replace(result, fromTo, cache,
+                                        top.GetSTPMgr()->defaultNodeFactory);
+    }
 
-      bm.GetRunTimes()->stop(RunTimes::IntervalPropagation);
-      return SubstitutionMap::replace(result, fromTo, cache,
-                                      top.GetSTPMgr()->defaultNodeFactory);
+    // The bounds hold because of these conjuncts, which might themselves
+    // have been simplified away using the bounds. So put back those that
+    // are missing, as they were. Adding one that is still there would make
+    // the result differ from the input on every call.
+    if (result != top && !usedConjuncts.empty())
+    {
+      ASTVec children;
+      if (result.GetKind() == AND)
+        children = FlattenKind(AND, result.GetChildren());
+      else
+        children.push_back(result);
+      ASTNodeSet present(children.begin(), children.end());
+      for (ASTVec::const_iterator it = usedConjuncts.begin();
+           it != usedConjuncts.end(); it++)
+        if (present.insert(*it).second)
+          children.push_back(*it);
+      result = children.size() == 1 ? children[0]
+                                     : nf->CreateNode(AND, children);
     }
 
     bm.GetRunTimes()->stop(RunTimes::IntervalPropagation);
@@ -433,12 +1172,7 @@ private:
         break;
       case BVGT:
       case BVSGT:
-        if ((BVGT == n.GetKind() && knownC0 && knownC1) ||
-            (BVSGT == n.GetKind() && knownC0 && knownC1 &&
-             !CONSTANTBV::BitVector_bit_test(children[0]->maxV,
-                                             n[0].GetValueWidth() - 1) &&
-             !CONSTANTBV::BitVector_bit_test(children[1]->maxV,
-                                             n[0].GetValueWidth() - 1)))
+        if (BVGT == n.GetKind() && knownC0 && knownC1)
         {
           if (CONSTANTBV::BitVector_Lexicompare(children[0]->minV,
                                                 children[1]->maxV) > 0)
@@ -448,6 +1182,18 @@ private:
                                                 children[0]->maxV) >= 0)
             result = createInterval(littleZero, littleZero);
         }
+        else if (BVSGT == n.GetKind())
+        {
+          IntervalType* s0 = signedIntervalOf(n[0], visited);
+          IntervalType* s1 = signedIntervalOf(n[1], visited);
+
+          // BitVector_Compare is signed.
+          if (CONSTANTBV::BitVector_Compare(s0->minV, s1->maxV) > 0)
+            result = createInterval(littleOne, littleOne);
+
+          if (CONSTANTBV::BitVector_Compare(s1->minV, s0->maxV) >= 0)
+            result = createInterval(littleZero, littleZero);
+        }
         if (BVSGT == n.GetKind() && result == NULL)
         {
           map<const ASTNode, IntervalType*>::iterator clock_it;
@@ -498,12 +1244,7 @@ private:
         break;
       case BVGE:
       case BVSGE:
-        if ((BVGE == n.GetKind() && knownC0 && knownC1) ||
-            (BVSGE == n.GetKind() && knownC0 && knownC1 &&
-             !CONSTANTBV::BitVector_bit_test(children[0]->maxV,
-                                             n[0].GetValueWidth() - 1) &&
-             !CONSTANTBV::BitVector_bit_test(children[1]->maxV,
-                                             n[0].GetValueWidth() - 1)))
+        if (BVGE == n.GetKind() && knownC0 && knownC1)
         {
           if (CONSTANTBV::BitVector_Lexicompare(children[0]->minV,
                                                 children[1]->maxV) >= 0)
@@ -512,6 +1253,16 @@ private:
                                                 children[0]->maxV) > 0)
             result = createInterval(littleZero, littleZero);
         }
+        else if (BVSGE == n.GetKind())
+        {
+          IntervalType* s0 = signedIntervalOf(n[0], visited);
+          IntervalType* s1 = signedIntervalOf(n[1], visited);
+
+          if (CONSTANTBV::BitVector_Compare(s0->minV, s1->maxV) >= 0)
+            result = createInterval(littleOne, littleOne);
+          if (CONSTANTBV::BitVector_Compare(s1->minV, s0->maxV) > 0)
+            result = createInterval(littleZero, littleZero);
+        }
         break;
       case BVDIV:
         if (knownC1)
@@ -563,10 +1314,12 @@ private:
       case BVSX:
         if (knownC0 && knownC1)
         {
-          // If the maximum doesn't have the top bit set, then zero extend it.
-          if (!CONSTANTBV::BitVector_bit_test(children[0]->maxV,
-                                              n[0].GetValueWidth() - 1))
+          // If the minimum and the maximum have the same sign, then extending
+          // them keeps them in order.
+          if (children[0]->sameSign(n[0].GetValueWidth()))
           {
+            const bool negative = CONSTANTBV::BitVector_bit_test(
+                children[0]->maxV, n[0].GetValueWidth() - 1);
             result = freshUnsignedInterval(n.GetValueWidth());
 
             // Copy in the minimum and maximum.
@@ -584,7 +1337,12 @@ private:
             }
 
             for (unsigned i = n[0].GetValueWidth(); i < n.GetValueWidth(); i++)
-              CONSTANTBV::BitVector_Bit_Off(result->maxV, i);
+            {
+              if (negative)
+                CONSTANTBV::BitVector_Bit_On(result->minV, i);
+              else
+                CONSTANTBV::BitVector_Bit_Off(result->maxV, i);
+            }
           }
         }
         else if (knownC1)
@@ -856,6 +1614,22 @@ private:
       }
     }
 
+    // Tighten with what the top-level conjuncts say about this term.
+    if (width > 0 && !constraints.empty())
+    {
+      map<const ASTNode, IntervalType*>::const_iterator c =
+          constraints.find(n);
+      if (c != constraints.end())
+        result = intersect(result, c->second);
+    }
+    if (width > 0 && !signedConstraints.empty())
+    {
+      map<const ASTNode, IntervalType*>::const_iterator c =
+          signedConstraints.find(n);
+      if (c != signedConstraints.end())
+        result = intersectWithSigned(result, c->second, width);
+    }
+
     if (result != NULL && result->isComplete())
       result = NULL;
 
@@ -873,7 +1647,7 @@ private:
   NodeFactory* nf;
 
 public:
-  EstablishIntervals(STPMgr& _bm) : bm(_bm)
+  EstablishIntervals(STPMgr& _bm) : unsatisfiable(false), bm(_bm)
   {
     littleZero = makeCBV(1);
     littleOne = makeCBV(1);
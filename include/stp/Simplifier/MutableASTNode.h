@@ -36,10 +36,10 @@ THE SOFTWARE.
 
 namespace stp
 {
+// Every node built for one run is recorded in a vector owned by the caller,
+// which frees them all with cleanup() at the end.
 class MutableASTNode
 {
-  static vector<MutableASTNode*> all;
-
 public:
   typedef std::set<MutableASTNode*> ParentsType;
   ParentsType parents;
@@ -57,7 +57,8 @@ private:
 
 public:
   static MutableASTNode* build(const ASTNode& n,
-                               std::map<ASTNode, MutableASTNode*>& visited)
+                               std::map<ASTNode, MutableASTNode*>& visited,
+                               vector<MutableASTNode*>& all)
   {
     if (visited.find(n) != visited.end())
     {
@@ -69,10 +70,10 @@ public:
 
     for (size_t i = 0; i < n.Degree(); i++)
     {
-      tempChildren.push_back(build(n[i], visited));
+      tempChildren.push_back(build(n[i], visited, all));
     }
 
-    MutableASTNode* mut = createNode(n);
+    MutableASTNode* mut = createNode(n, all);
 
     for (size_t i = 0; i < n.Degree(); i++)
     {
@@ -171,7 +172,7 @@ public:
   ASTNode n;
   vector<MutableASTNode*> children;
 
-  static MutableASTNode* createNode(ASTNode n)
+  static MutableASTNode* createNode(ASTNode n, vector<MutableASTNode*>& all)
   {
     MutableASTNode* result = new MutableASTNode(n);
     all.push_back(result);
@@ -188,10 +189,10 @@ public:
     return result;
   }
 
-  static MutableASTNode* build(ASTNode n)
+  static MutableASTNode* build(ASTNode n, vector<MutableASTNode*>& all)
   {
     std::map<ASTNode, MutableASTNode*> visited;
-    return build(n, visited);
+    return build(n, visited, all);
   }
 
   void propagateUpDirty()
@@ -253,7 +254,8 @@ public:
   }
 
   // Variables that have >1 disjoint extract parents.
-  static void getDisjointExtractVariables(vector<MutableASTNode*>& result)
+  static void getDisjointExtractVariables(const vector<MutableASTNode*>& all,
+                                          vector<MutableASTNode*>& result)
   {
     const int size = all.size();
     for (int i = size - 1; i >= 0; i--)
@@ -310,7 +312,8 @@ public:
   // Visit the parent before children. So that we hopefully prune parts of the
   // tree. Ie given  ( F(x_1,... x_10000) = v), where v is unconstrained,
   // we don't spend time exploring F(..), but chop it out.
-  static void getAllUnconstrainedVariables(vector<MutableASTNode*>& result)
+  static void getAllUnconstrainedVariables(const vector<MutableASTNode*>& all,
+                                           vector<MutableASTNode*>& result)
   {
     const int size = all.size();
     for (int i = size - 1; i >= 0; i--)
@@ -343,7 +346,7 @@ public:
     return parents.size() == 1;
   }
 
-  static void cleanup()
+  static void cleanup(vector<MutableASTNode*>& all)
   {
     for (size_t i = 0; i < all.size(); i++)
       delete all[i];
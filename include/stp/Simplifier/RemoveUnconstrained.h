@@ -45,14 +45,18 @@ class RemoveUnconstrained // not copyable
 {
   STPMgr& bm;
 
+  // The mutable nodes built for the current run.
+  vector<MutableASTNode*> all;
+
   ASTNode replaceParentWithFresh(MutableASTNode& mute,
                                  vector<MutableASTNode*>& variables);
 
   ASTNode topLevel_other(const ASTNode& n, Simplifier* simplifier);
 
-  void splitExtractOnly(vector<MutableASTNode*> extracts);
+  void splitExtractOnly(vector<MutableASTNode*> extracts,
+                        Simplifier* simplifier);
 
-  void replace(const ASTNode& from, const ASTNode to);
+  void replace(Simplifier* simplifier, const ASTNode& from, const ASTNode to);
 
   NodeFactory* nf;
 
@@ -69,6 +69,9 @@ class ConstantBitPropagation
 
   bool topFixed;
 
+  // Print the worklist counters when the tables are cleared.
+  bool printWorkListStats;
+
   // A vector that's reused.
   std::vector<unsigned> previousChildrenFixedCount;
 
@@ -86,6 +89,9 @@ public:
 
   bool isUnsatisfiable() { return status == CONFLICT; }
 
+  // For the push, pop and revisit counters. NULL after clearTables().
+  const WorkList* getWorkList() const { return workList; }
+
   // propagates.
   ConstantBitPropagation(stp::Simplifier* _sm, NodeFactory* _nf,
                          const ASTNode& top);
@@ -103,6 +109,8 @@ public:
     fixedMap = NULL;
     delete dependents;
     dependents = NULL;
+    if (workList != NULL && printWorkListStats)
+      workList->printStats();
     delete workList;
     workList = NULL;
     delete msm;
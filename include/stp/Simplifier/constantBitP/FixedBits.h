@@ -26,9 +26,11 @@ THE SOFTWARE.
 #ifndef FIXEDBITS_H_
 #define FIXEDBITS_H_
 
-#include <vector>
-#include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <iostream>
+#include <stdint.h>
+#include <vector>
 
 class MTRand;
 
@@ -49,15 +51,66 @@ namespace constantBitP
 #define CONSTANTBITP_UTILITY_XSTR(s) CONSTANTBITP_UTILITY_STR(s)
 #define LOCATION __FILE__ ":" CONSTANTBITP_UTILITY_XSTR(__LINE__) ": "
 
-static int staticUniqueId = 1;
+// Orders FixedBits by creation. Ids are only compared between FixedBits of
+// one solver, so a counter per thread is enough.
+static thread_local int staticUniqueId = 1;
+
+// Population count and count of trailing zeroes of a word.
+inline unsigned popcount64(uint64_t w)
+{
+#ifdef __GNUC__
+  return __builtin_popcountll(w);
+#else
+  unsigned result = 0;
+  for (; w != 0; w &= w - 1)
+    result++;
+  return result;
+#endif
+}
+
+// w must not be zero.
+inline unsigned ctz64(uint64_t w)
+{
+  assert(w != 0);
+#ifdef __GNUC__
+  return __builtin_ctzll(w);
+#else
+  unsigned result = 0;
+  for (; (w & 1) == 0; w >>= 1)
+    result++;
+  return result;
+#endif
+}
+
+// w must not be zero.
+inline unsigned topBit64(uint64_t w)
+{
+  assert(w != 0);
+#ifdef __GNUC__
+  return 63 - __builtin_clzll(w);
+#else
+  unsigned result = 0;
+  for (; w > 1; w >>= 1)
+    result++;
+  return result;
+#endif
+}
 
 // Bits can be fixed, or unfixed. Fixed bits are fixed to either zero or one.
 // Unfixed bits are marked as '*' when using operator[]
+//
+// The bits are packed 64 to a word. The "fixed" words say which bits are
+// fixed, the "values" words hold the values of the fixed bits. The value of an
+// unfixed bit is meaningless, so the word accessors mask it out. Bits past the
+// width in the last word are always zero.
 class FixedBits
 {
+public:
+  static const unsigned bitsPerWord = 64;
+
 private:
-  bool* fixed;
-  bool* values;
+  uint64_t* fixed;
+  uint64_t* values;
   unsigned width;
   bool representsBoolean;
 
@@ -67,6 +120,9 @@ private:
   bool unsignedHolds_new(unsigned val);
   bool unsignedHolds_old(unsigned val);
 
+  static unsigned wordOf(unsigned n) { return n / bitsPerWord; }
+  static uint64_t bitOf(unsigned n) { return (uint64_t)1 << (n % bitsPerWord); }
+
 public:
   FixedBits(unsigned n, bool isBoolean);
 
@@ -79,11 +135,7 @@ public:
 
   bool isBoolean() const { return representsBoolean; }
 
-  ~FixedBits()
-  {
-    delete[] fixed;
-    delete[] values;
-  }
+  ~FixedBits() { delete[] fixed; }
 
   bool operator<=(const FixedBits& copy) const
   {
@@ -110,11 +162,59 @@ public:
       return *this;
 
     delete[] fixed;
-    delete[] values;
     init(copy);
     return *this;
   }
 
+  /****************************************************************
+   * Word access, for transfer functions that work 64 bits at a   *
+   * time.                                                        *
+   ****************************************************************/
+
+  static unsigned wordsFor(unsigned width)
+  {
+    return (width + bitsPerWord - 1) / bitsPerWord;
+  }
+
+  unsigned numberOfWords() const { return wordsFor(width); }
+
+  // The bits of word w that are inside the width.
+  uint64_t wordMask(unsigned w) const
+  {
+    assert(w < numberOfWords());
+    const unsigned rest = width - w * bitsPerWord;
+    return rest >= bitsPerWord ? ~(uint64_t)0 : (bitOf(rest) - 1);
+  }
+
+  uint64_t getFixedWord(unsigned w) const
+  {
+    assert(w < numberOfWords());
+    return fixed[w];
+  }
+
+  // The bits of word w that are fixed to one.
+  uint64_t getOnesWord(unsigned w) const
+  {
+    assert(w < numberOfWords());
+    return values[w] & fixed[w];
+  }
+
+  // The bits of word w that are fixed to zero.
+  uint64_t getZeroesWord(unsigned w) const
+  {
+    assert(w < numberOfWords());
+    return fixed[w] & ~values[w];
+  }
+
+  // Fixes the bits of word w that are in mask to the corresponding bits of v.
+  void fixWord(unsigned w, uint64_t mask, uint64_t v)
+  {
+    assert(w < numberOfWords());
+    assert((mask & ~wordMask(w)) == 0);
+    fixed[w] |= mask;
+    values[w] = (values[w] & ~mask) | (v & mask);
+  }
+
   // All values are fixed to false.
   void fixToZero();
 
@@ -125,15 +225,7 @@ public:
   {
     assert(isTotallyFixed());
     assert(getWidth() <= 32);
-    unsigned result = 0;
-
-    for (unsigned i = 0; i < width; i++)
-    {
-      if (getValue(i))
-        result += (1 << i);
-    }
-
-    return result;
+    return (unsigned)values[0];
   }
 
   // True if all bits are fixed (irrespective of what value they are fixed to).
@@ -143,93 +235,80 @@ public:
   void setValue(unsigned n, bool value)
   {
     assert(((char)value) == 0 || (char)value == 1);
-    assert(n < width && fixed[n]);
-    values[n] = value;
+    assert(n < width && isFixed(n));
+    if (value)
+      values[wordOf(n)] |= bitOf(n);
+    else
+      values[wordOf(n)] &= ~bitOf(n);
   }
 
   bool getValue(unsigned n) const
   {
-    assert(n < width && fixed[n]);
-    return values[n];
+    assert(n < width && isFixed(n));
+    return (values[wordOf(n)] & bitOf(n)) != 0;
   }
 
   // returns -1 if it's zero.
   int topmostPossibleLeadingOne()
   {
-    int i;
-    for (i = (int)getWidth() - 1; i >= 0; i--)
+    for (int w = (int)numberOfWords() - 1; w >= 0; w--)
     {
-      if (!isFixed(i) || getValue(i))
-        break;
+      const uint64_t possible = (~fixed[w] | values[w]) & wordMask(w);
+      if (possible != 0)
+        return w * bitsPerWord + topBit64(possible);
     }
-    return i;
+    return -1;
   }
 
-  unsigned minimum_trailingOne()
-  {
-    unsigned i = 0;
-    for (; i < getWidth(); i++)
-    {
-      if (!isFixed(i) || getValue(i))
-        break;
-    }
-    return i;
-  }
+  unsigned minimum_trailingOne() { return minimum_numberOfTrailingZeroes(); }
 
-  unsigned maximum_trailingOne()
-  {
-    unsigned i = 0;
-    for (; i < getWidth(); i++)
-    {
-      if (isFixed(i) && getValue(i))
-        break;
-    }
-    return i;
-  }
+  unsigned maximum_trailingOne() { return maximum_numberOfTrailingZeroes(); }
 
+  // The position of the lowest bit that isn't fixed to zero.
   unsigned minimum_numberOfTrailingZeroes()
   {
-    unsigned i = 0;
-    for (; i < getWidth(); i++)
+    for (unsigned w = 0; w < numberOfWords(); w++)
     {
-      if (!isFixed(i) || getValue(i))
-        break;
+      const uint64_t possible = (~fixed[w] | values[w]) & wordMask(w);
+      if (possible != 0)
+        return w * bitsPerWord + ctz64(possible);
     }
-    return i;
+    return width;
   }
 
+  // The position of the lowest bit that is fixed to one.
   unsigned maximum_numberOfTrailingZeroes()
   {
-    unsigned i = 0;
-    for (; i < getWidth(); i++)
+    for (unsigned w = 0; w < numberOfWords(); w++)
     {
-      if (isFixed(i) && getValue(i))
-        break;
+      const uint64_t ones = getOnesWord(w);
+      if (ones != 0)
+        return w * bitsPerWord + ctz64(ones);
     }
-    return i;
+    return width;
   }
 
   // Returns the position of the first non-fixed value.
   unsigned leastUnfixed() const
   {
-    unsigned i = 0;
-    for (; i < getWidth(); i++)
+    for (unsigned w = 0; w < numberOfWords(); w++)
     {
-      if (!isFixed(i))
-        break;
+      const uint64_t unfixed = ~fixed[w] & wordMask(w);
+      if (unfixed != 0)
+        return w * bitsPerWord + ctz64(unfixed);
     }
-    return i;
+    return width;
   }
 
   int mostUnfixed() const
   {
-    int i = (int)getWidth() - 1;
-    for (; i >= 0; i--)
+    for (int w = (int)numberOfWords() - 1; w >= 0; w--)
     {
-      if (!isFixed(i))
-        break;
+      const uint64_t unfixed = ~fixed[w] & wordMask(w);
+      if (unfixed != 0)
+        return w * bitsPerWord + topBit64(unfixed);
     }
-    return i;
+    return -1;
   }
 
   // is this bit fixed to zero?
@@ -242,59 +321,54 @@ public:
   bool isFixed(unsigned n) const
   {
     assert(n < width);
-    return fixed[n];
+    return (fixed[wordOf(n)] & bitOf(n)) != 0;
   }
 
   // set bit n to either fixed or unfixed.
   void setFixed(unsigned n, bool value)
   {
     assert(n < width);
-    fixed[n] = value;
+    if (value)
+      fixed[wordOf(n)] |= bitOf(n);
+    else
+      fixed[wordOf(n)] &= ~bitOf(n);
   }
 
   // Whether the set of values contains this one.
   bool unsignedHolds(unsigned val);
 
+  // Makes the bottom a.getWidth() bits the same as a.
   void replaceWithContents(const FixedBits& a)
   {
     assert(getWidth() >= a.getWidth());
 
-    for (unsigned i = 0; i < a.getWidth(); i++)
+    for (unsigned w = 0; w < a.numberOfWords(); w++)
     {
-      if (a.isFixed(i))
-      {
-        setFixed(i, true);
-        setValue(i, a.getValue(i));
-      }
-      else
-      {
-        setFixed(i, false);
-      }
+      const uint64_t mask = a.wordMask(w);
+      fixed[w] = (fixed[w] & ~mask) | a.fixed[w];
+      values[w] = (values[w] & ~mask) | (a.values[w] & mask);
     }
   }
 
   void copyIn(const FixedBits& a)
   {
-    unsigned to = std::min(getWidth(), a.getWidth());
-    for (unsigned i = 0; i < to; i++)
+    const unsigned to = std::min(getWidth(), a.getWidth());
+    for (unsigned w = 0; w < wordsFor(to); w++)
     {
-      assert(!isFixed(i));
-      if (a.isFixed(i))
-      {
-        setFixed(i, true);
-        setValue(i, a.getValue(i));
-      }
+      uint64_t mask = a.fixed[w];
+      if ((w + 1) * bitsPerWord > to)
+        mask &= bitOf(to) - 1;
+      assert((fixed[w] & mask) == 0);
+      fixWord(w, mask, a.values[w]);
     }
   }
 
   // todo merger with unsignedHolds()
   bool containsZero() const
   {
-    for (unsigned i = 0; i < getWidth(); i++)
-    {
-      if (isFixed(i) && getValue(i))
+    for (unsigned w = 0; w < numberOfWords(); w++)
+      if (getOnesWord(w) != 0)
         return false;
-    }
 
     return true;
   }
@@ -302,11 +376,8 @@ public:
   unsigned countFixed() const
   {
     unsigned result = 0;
-    for (unsigned i = 0; i < width; i++)
-    {
-      if (isFixed(i))
-        result++;
-    }
+    for (unsigned w = 0; w < numberOfWords(); w++)
+      result += popcount64(fixed[w]);
 
     return result;
   }
@@ -322,14 +393,8 @@ public:
   void mergeIn(const FixedBits& a)
   {
     assert(a.getWidth() == getWidth());
-    for (unsigned i = 0; i < width; i++)
-    {
-      if (a.isFixed(i) && !isFixed(i))
-      {
-        setFixed(i, true);
-        setValue(i, a.getValue(i));
-      }
-    }
+    for (unsigned w = 0; w < numberOfWords(); w++)
+      fixWord(w, a.fixed[w] & ~fixed[w], a.values[w]);
   }
 
   static FixedBits meet(const FixedBits& a, const FixedBits& b);
@@ -28,6 +28,10 @@ THE SOFTWARE.
 
 #include "stp/AST/ASTNode.h"
 #include "stp/AST/AST.h"
+#include <algorithm>
+#include <functional>
+#include <stdint.h>
+#include <vector>
 
 namespace simplifier
 {
@@ -38,20 +42,52 @@ using std::endl;
 
 class WorkList
 {
-  /* Rough worklist. Constraint Programming people have lovely structures to do
-   * this
-   * The set (on my machine), is implemented by red-black trees. Deleting just
-   * from one end may unbalance the tree??
+  /* A priority queue of the nodes waiting to be propagated. Cheap nodes are
+   * taken before expensive ones (multiplication, addition and division), and
+   * within each class, nodes with lower node numbers come first. A node is
+   * always made after its children, so this works bottom up: the fixings of
+   * the children have usually settled by the time a parent is visited, which
+   * saves visiting the parent again.
+   *
+   * The queue is a binary heap of keys. Each node is given a slot the first
+   * time it's pushed, and whether it's queued is kept by slot, so a push of a
+   * node that's already waiting costs one lookup. Slots are numbered densely
+   * rather than by node number, so the memory used follows the size of the
+   * formula, not the number of nodes the manager has ever made.
    */
 
 private:
-  // select nodes from the cheap_worklist first.
-  std::set<stp::ASTNode> cheap_workList;     // Nodes to work on.
-  std::set<stp::ASTNode> expensive_workList; // Nodes to work on.
+  // The top bit is set for expensive nodes. The next 31 bits are the node
+  // number, which orders the nodes, and the low 32 bits are the slot.
+  typedef uint64_t Key;
+  std::vector<Key> heap;
+
+  typedef hash_map<stp::ASTNode, uint32_t, stp::ASTNode::ASTNodeHasher,
+                   stp::ASTNode::ASTNodeEqual> SlotMap;
+  SlotMap slots;
+
+  // By slot: the node, whether it's queued, and whether it's been popped.
+  std::vector<stp::ASTNode> nodes;
+  std::vector<bool> queued;
+  std::vector<bool> popped;
+
+  static uint32_t slotOf(Key k) { return (uint32_t)k; }
+
+  // Counters, for tuning.
+  uint64_t pushes;           // Nodes added.
+  uint64_t duplicatePushes;  // Pushes of nodes that were already queued.
+  uint64_t pops;             // Nodes taken off.
+  uint64_t revisits;         // Pops of nodes that had been popped before.
 
   WorkList(const WorkList&); // Shouldn't needed to copy or assign.
   WorkList& operator=(const WorkList&);
 
+  static bool isExpensive(const stp::ASTNode& n)
+  {
+    const stp::Kind k = n.GetKind();
+    return k == stp::BVMULT || k == stp::BVPLUS || k == stp::BVDIV;
+  }
+
   // We add to the worklist any node that immediately depends on a constant.
   void addToWorklist(const stp::ASTNode& n, stp::ASTNodeSet& visited)
   {
@@ -79,9 +115,13 @@ private:
 public:
   // Add to the worklist any node that immediately depends on a constant.
 
-  WorkList(const ASTNode& top) { initWorkList(top); }
+  WorkList(const ASTNode& top)
+      : pushes(0), duplicatePushes(0), pops(0), revisits(0)
+  {
+    initWorkList(top);
+  }
 
-  int size() { return cheap_workList.size() + expensive_workList.size(); }
+  int size() { return heap.size(); }
 
   void initWorkList(const ASTNode& n)
   {
@@ -94,52 +134,68 @@ public:
     if (n.isConstant()) // don't ever add constants to the worklist.
       return;
 
-    // cerr << "WorkList Inserting:" << n.GetNodeNum() << endl;
-    if (n.GetKind() == stp::BVMULT || n.GetKind() == stp::BVPLUS || n.GetKind() == stp::BVDIV)
-      expensive_workList.insert(n);
-    else
-      cheap_workList.insert(n);
+    std::pair<SlotMap::iterator, bool> inserted =
+        slots.insert(std::make_pair(n, (uint32_t)nodes.size()));
+    const uint32_t slot = inserted.first->second;
+    if (inserted.second)
+    {
+      nodes.push_back(n);
+      queued.push_back(false);
+      popped.push_back(false);
+    }
+
+    if (queued[slot])
+    {
+      duplicatePushes++;
+      return;
+    }
+
+    pushes++;
+    queued[slot] = true;
+
+    const Key num = n.GetNodeNum();
+    assert(num < ((Key)1 << 31));
+    heap.push_back(((Key)isExpensive(n) << 63) | (num << 32) | slot);
+    std::push_heap(heap.begin(), heap.end(), std::greater<Key>());
   }
 
   stp::ASTNode pop()
   {
     assert(!isEmpty());
-    if (cheap_workList.size() > 0)
-    {
-      ASTNode ret = *cheap_workList.begin();
-      cheap_workList.erase(cheap_workList.begin());
-      return ret;
-    }
-    else
-    {
-      assert(expensive_workList.size() > 0);
-      ASTNode ret = *expensive_workList.begin();
-      expensive_workList.erase(expensive_workList.begin());
-      return ret;
-    }
+    std::pop_heap(heap.begin(), heap.end(), std::greater<Key>());
+    const uint32_t slot = slotOf(heap.back());
+    heap.pop_back();
+
+    pops++;
+    if (popped[slot])
+      revisits++;
+    popped[slot] = true;
+
+    queued[slot] = false;
+    return nodes[slot];
   }
 
-  bool isEmpty()
+  bool isEmpty() { return heap.empty(); }
+
+  uint64_t getPushes() const { return pushes; }
+  uint64_t getDuplicatePushes() const { return duplicatePushes; }
+  uint64_t getPops() const { return pops; }
+  uint64_t getRevisits() const { return revisits; }
+
+  void printStats()
   {
-    return cheap_workList.empty() && expensive_workList.empty();
+    std::cout << "Worklist pushes:" << pushes
+         << " duplicate pushes:" << duplicatePushes << " pops:" << pops
+         << " revisits:" << revisits << std::endl;
   }
 
   void print()
   {
     cerr << "+Worklist" << endl;
-    std::set<stp::ASTNode>::const_iterator it = cheap_workList.begin();
-    while (it != cheap_workList.end())
-    {
-      cerr << *it << " ";
-      it++;
-    }
-
-    it = expensive_workList.begin();
-    while (it != expensive_workList.end())
-    {
-      cerr << *it << " ";
-      it++;
-    }
+    std::vector<Key> sorted(heap);
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); i++)
+      cerr << nodes[slotOf(sorted[i])] << " ";
 
     cerr << "-Worklist" << endl;
   }
@@ -55,6 +55,9 @@ private:
   ASTNodeMap* SimplifyMap;
   ASTNodeMap* SimplifyNegMap;
   hash_set<int> AlwaysTrueHashSet;
+
+  // Lookups in the two maps above, for profiling.
+  long cacheHits, cacheMisses;
   ASTNodeMap MultInverseMap;
 
   // For ArrayWrite Abstraction: map from read-over-write term to
@@ -74,6 +77,17 @@ private:
 
   void checkIfInSimplifyMap(const ASTNode& n, ASTNodeSet visited);
 
+  // How deeply SimplifyTerm and SimplifyFormula have recursed.
+  unsigned depth;
+  class Level;
+  void simplifyBelow(const ASTNode& n, ASTNodeMap* VarConstMap);
+
+  // Results found with a VarConstMap aren't kept in the simplify maps, since
+  // they hold only for that map. They're kept here instead, until the
+  // outermost call returns, so that simplifyBelow() works on that path too.
+  ASTNodeMap* varConstResultsMap;
+  ASTNodeMap varConstResults;
+
   ASTNode makeTower(const Kind k, const ASTVec& children);
 
   ASTNode pullUpBVSX(const ASTNode output);
@@ -88,7 +102,9 @@ public:
   /****************************************************************
    * Public Member Functions                                      *
    ****************************************************************/
-  Simplifier(STPMgr* bm) : _bm(bm), substitutionMap(this, bm)
+  Simplifier(STPMgr* bm)
+      : cacheHits(0), cacheMisses(0), _bm(bm), substitutionMap(this, bm),
+        depth(0), varConstResultsMap(NULL)
   {
     SimplifyMap = new ASTNodeMap(INITIAL_TABLE_SIZE);
     SimplifyNegMap = new ASTNodeMap(INITIAL_TABLE_SIZE);
@@ -236,6 +252,10 @@ public:
 
   void printCacheStatus();
 
+  // Adds the cache hits, misses and sizes since the last call to the
+  // profiling counters.
+  void recordCacheStatus();
+
 #if 0
     //FIXME: Get rid of this horrible function
     const ASTNodeMap * ReadOverWriteMap()
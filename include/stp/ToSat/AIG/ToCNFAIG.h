@@ -51,9 +51,12 @@ class ToCNFAIG // not copyable
 public:
   ToCNFAIG(UserDefinedFlags& _uf) : uf(_uf) {}
 
+  // If a sink is given, clauses may be handed to it while they are derived
+  // instead of being stored in cnfData, which then has no clauses.
   void toCNF(const BBNodeAIG& top, Cnf_Dat_t*& cnfData,
              ToSATBase::ASTNodeToSATVar& nodeToVars, bool needAbsRef,
-             BBNodeManagerAIG& _mgr);
+             BBNodeManagerAIG& _mgr, Cnf_ClauseSink_t sink = NULL,
+             void* sinkData = NULL);
 };
 }
 #endif /* TOCNFAIG_H_ */
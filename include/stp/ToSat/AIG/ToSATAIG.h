@@ -44,8 +44,27 @@ private:
   ASTNodeToSATVar nodeToSATVar;
   simplifier::constantBitP::ConstantBitPropagation* cb;
 
+  // In incremental mode each conjunct of the input is bit-blasted once, and
+  // its root is asserted under an activation variable. The bit-blaster and
+  // its AIG live as long as this object, so terms shared between conjuncts
+  // are bit-blasted once, and each AIG node is given a SAT variable once.
+  bool incremental;
+  hash_map<ASTNode, uint32_t, ASTNode::ASTNodeHasher, ASTNode::ASTNodeEqual>
+      activation;
+  Simplifier* incrementalSimp;
+  BBNodeManagerAIG* incrementalMgr;
+  BitBlaster<BBNodeAIG, BBNodeManagerAIG>* incrementalBB;
+  vector<unsigned> aigToSATVar; // indexed by the AIG node's Id.
+  int mappedPis;
+
   ArrayTransformer* arrayTransformer;
 
+  // A bit-blast of the input done before it was given to us, when it was
+  // measured. Used instead of bit-blasting the same input again.
+  ASTNode bitBlastedInput;
+  BBNodeManagerAIG* bitBlastedMgr;
+  BBNodeAIG bitBlastedRoot;
+
   // don't assign or copy construct.
   ToSATAIG& operator=(const ToSATAIG& other);
   ToSATAIG(const ToSATAIG& other);
@@ -60,7 +79,13 @@ private:
 
   bool runSolver(SATSolver& satSolver);
   void add_cnf_to_solver(SATSolver& satSolver, Cnf_Dat_t* cnfData);
-  Cnf_Dat_t* bitblast(const ASTNode& input, bool needAbsRef);
+  void map_new_symbols(SATSolver& satSolver);
+  Minisat::Lit encode_aig(SATSolver& satSolver, Aig_Obj_t* root);
+  void clear_incremental();
+  Cnf_Dat_t* bitblast(const ASTNode& input, bool needAbsRef,
+                      SATSolver* stream);
+  uint32_t getActivationVar(SATSolver& satSolver, const ASTNode& conjunct);
+  bool CallSATIncremental(SATSolver& satSolver, const ASTNode& input);
   void handle_cnf_options(Cnf_Dat_t* cnfData, bool needAbsRef);
   void release_cnf_memory(Cnf_Dat_t* cnfData);
 
@@ -73,15 +98,21 @@ private:
   {
     count = 0;
     first = true;
+    incrementalSimp = NULL;
+    incrementalMgr = NULL;
+    incrementalBB = NULL;
+    mappedPis = 0;
+    bitBlastedMgr = NULL;
   }
 
-  static int cnf_calls;
+  // ABC's CNF tables are kept per thread, so this counts per thread too.
+  static thread_local int cnf_calls;
 
 public:
   bool cbIsDestructed() { return cb == NULL; }
 
-  ToSATAIG(STPMgr* bm, ArrayTransformer* at)
-      : ToSATBase(bm), toCNF(bm->UserFlags)
+  ToSATAIG(STPMgr* bm, ArrayTransformer* at, bool incremental_ = false)
+      : ToSATBase(bm), incremental(incremental_), toCNF(bm->UserFlags)
   {
     cb = NULL;
     init();
@@ -90,7 +121,7 @@ public:
 
   ToSATAIG(STPMgr* bm, simplifier::constantBitP::ConstantBitPropagation* cb_,
            ArrayTransformer* at)
-      : ToSATBase(bm), cb(cb_), toCNF(bm->UserFlags)
+      : ToSATBase(bm), cb(cb_), incremental(false), toCNF(bm->UserFlags)
   {
     cb = cb_;
     init();
@@ -99,7 +130,16 @@ public:
 
   ~ToSATAIG();
 
-  void ClearAllTables() { nodeToSATVar.clear(); }
+  // Takes ownership of mgr, which holds root, the bit-blast of input with
+  // the same constant bit propagator that this object was given.
+  void useBitBlasted(const ASTNode& input, BBNodeManagerAIG* mgr,
+                     const BBNodeAIG& root);
+
+  void ClearAllTables()
+  {
+    nodeToSATVar.clear();
+    clear_incremental();
+  }
 
   // Used to read out the satisfiable answer.
   ASTNodeToSATVar& SATVar_to_SymbolIndexMap() { return nodeToSATVar; }
@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include <cmath>
 #include <cassert>
+#include <algorithm>
 #include <map>
 #include "stp/STPManager/STPManager.h"
 #include <list>
@@ -55,19 +56,48 @@ typedef std::vector<ASTNode> ASTVec;
 
 template <class BBNode, class BBNodeManagerT> class BitBlaster;
 
+// The nodes that must be conjoined to the top of a bit-blasted formula.
+// They're only added to while bit-blasting, and read once at the end, so
+// they're kept in a vector, which is sorted and has its duplicates removed
+// when it's read.
+template <class BBNode> class BBSupport
+{
+  vector<BBNode> nodes;
+
+public:
+  void insert(const BBNode& n) { nodes.push_back(n); }
+
+  size_t size() const { return nodes.size(); }
+
+  // In the same order a std::set would give.
+  const vector<BBNode>& get()
+  {
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    return nodes;
+  }
+};
+
 template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
 {
+  typedef BBSupport<BBNode> BBNodeSet;
+
   BBNode BBTrue, BBFalse;
 
   // Memo table for bit blasted terms.  If a node has already been
   // bitblasted, it is mapped to a vector of Boolean formulas for
-  // the
-  std::map<ASTNode, vector<BBNode>> BBTermMemo;
+  // the bits. Entries aren't moved by later insertions, so BBTerm returns
+  // references to them.
+  typedef hash_map<ASTNode, vector<BBNode>, ASTNode::ASTNodeHasher,
+                   ASTNode::ASTNodeEqual> BBTermMemoMap;
+  BBTermMemoMap BBTermMemo;
 
   // Memo table for bit blasted formulas.  If a node has already
   // been bitblasted, it is mapped to a node representing the
   // bitblasted equivalent
-  std::map<ASTNode, BBNode> BBFormMemo;
+  typedef hash_map<ASTNode, BBNode, ASTNode::ASTNodeHasher,
+                   ASTNode::ASTNodeEqual> BBFormMemoMap;
+  BBFormMemoMap BBFormMemo;
 
   // Get vector of Boolean formulas for sum of two
   // vectors of Boolean formulas
@@ -87,45 +117,45 @@ template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
 
   // Multiply.
   vector<BBNode> BBMult(const vector<BBNode>& x, const vector<BBNode>& y,
-                        set<BBNode>& support, const ASTNode& n);
+                        BBNodeSet& support, const ASTNode& n);
   void mult_allPairs(const vector<BBNode>& x, const vector<BBNode>& y,
-                     set<BBNode>& support, vector<list<BBNode>>& products);
+                     BBNodeSet& support, vector<list<BBNode>>& products);
   void mult_Booth(const vector<BBNode>& x_i, const vector<BBNode>& y_i,
-                  set<BBNode>& support, const stp::ASTNode& xN,
+                  BBNodeSet& support, const stp::ASTNode& xN,
                   const stp::ASTNode& yN, vector<list<BBNode>>& products,
                   const ASTNode& n);
   vector<BBNode> mult_normal(const vector<BBNode>& x, const vector<BBNode>& y,
-                             set<BBNode>& support, const ASTNode& n);
+                             BBNodeSet& support, const ASTNode& n);
 
   vector<BBNode> batcher(const vector<BBNode>& in);
   vector<BBNode> mergeSorted(const vector<BBNode>& in1,
                              const vector<BBNode>& in2);
   vector<BBNode> compareOddEven(const vector<BBNode>& in);
 
-  void setColumnsToZero(vector<list<BBNode>>& products, set<BBNode>& support,
+  void setColumnsToZero(vector<list<BBNode>>& products, BBNodeSet& support,
                         const ASTNode& n);
 
-  void sortingNetworkAdd(set<BBNode>& support, list<BBNode>& current,
+  void sortingNetworkAdd(BBNodeSet& support, list<BBNode>& current,
                          vector<BBNode>& currentSorted,
                          vector<BBNode>& priorSorted);
 
-  vector<BBNode> v6(vector<list<BBNode>>& products, set<BBNode>& support,
+  vector<BBNode> v6(vector<list<BBNode>>& products, BBNodeSet& support,
                     const ASTNode& n);
-  vector<BBNode> v7(vector<list<BBNode>>& products, set<BBNode>& support,
+  vector<BBNode> v7(vector<list<BBNode>>& products, BBNodeSet& support,
                     const ASTNode& n);
-  vector<BBNode> v8(vector<list<BBNode>>& products, set<BBNode>& support,
+  vector<BBNode> v8(vector<list<BBNode>>& products, BBNodeSet& support,
                     const ASTNode& n);
-  vector<BBNode> v9(vector<list<BBNode>>& products, set<BBNode>& support,
+  vector<BBNode> v9(vector<list<BBNode>>& products, BBNodeSet& support,
                     const ASTNode& n);
-  vector<BBNode> v13(vector<list<BBNode>>& products, set<BBNode>& support,
+  vector<BBNode> v13(vector<list<BBNode>>& products, BBNodeSet& support,
                      const ASTNode& n);
 
   vector<BBNode> multWithBounds(const ASTNode& n,
                                 vector<list<BBNode>>& products,
-                                set<BBNode>& toConjoinToTop);
+                                BBNodeSet& toConjoinToTop);
   bool statsFound(const ASTNode& n);
 
-  void mult_BubbleSorterWithBounds(set<BBNode>& support,
+  void mult_BubbleSorterWithBounds(BBNodeSet& support,
                                    list<BBNode>& currentColumn,
                                    vector<BBNode>& currentSorted,
                                    vector<BBNode>& priorSorted,
@@ -133,10 +163,10 @@ template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
                                    const int maxTrue = ((unsigned)~0) >> 1);
 
   void buildAdditionNetworkResult(list<BBNode>& from, list<BBNode>& to,
-                                  set<BBNode>& support, const bool top,
+                                  BBNodeSet& support, const bool top,
                                   const bool empty);
   vector<BBNode> buildAdditionNetworkResult(vector<list<BBNode>>& products,
-                                            set<BBNode>& support,
+                                            BBNodeSet& support,
                                             const ASTNode& n);
 
   vector<BBNode> BBAndBit(const vector<BBNode>& y, BBNode b);
@@ -153,7 +183,7 @@ template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
 
   // Returns vector<BBNode> for result - y.  This destroys "result".
   void BBSub(vector<BBNode>& result, const vector<BBNode>& y,
-             set<BBNode>& support);
+             BBNodeSet& support);
 
   // build ITE's (ITE cond then[i] else[i]) for each i.
   vector<BBNode> BBITE(const BBNode& cond, const vector<BBNode>& thn,
@@ -171,7 +201,7 @@ template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
 
   void BBDivMod(const vector<BBNode>& y, const vector<BBNode>& x,
                 vector<BBNode>& q, vector<BBNode>& r, unsigned int rwidth,
-                set<BBNode>& support);
+                BBNodeSet& support);
 
   // Return formula for majority function of three formulas.
   BBNode Majority(const BBNode& a, const BBNode& b, const BBNode& c);
@@ -185,7 +215,7 @@ template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
                          bool is_signed, bool is_bvlt = false);
 
   // Return bit-blasted form for BVLE, BVGE, BVGT, SBLE, etc.
-  BBNode BBcompare(const ASTNode& form, set<BBNode>& support);
+  BBNode BBcompare(const ASTNode& form, BBNodeSet& support);
 
   void BBLShift(vector<BBNode>& x, unsigned int shift);
   void BBRShift(vector<BBNode>& x, unsigned int shift);
@@ -201,11 +231,11 @@ template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
 
   bool update(const ASTNode& n, const int i,
               simplifier::constantBitP::FixedBits* b, BBNode& bb,
-              set<BBNode>& support);
-  void updateTerm(const ASTNode& n, vector<BBNode>& bb, set<BBNode>& support);
-  void updateForm(const ASTNode& n, BBNode& bb, set<BBNode>& support);
+              BBNodeSet& support);
+  void updateTerm(const ASTNode& n, vector<BBNode>& bb, BBNodeSet& support);
+  void updateForm(const ASTNode& n, BBNode& bb, BBNodeSet& support);
 
-  const BBNode BBForm(const ASTNode& form, set<BBNode>& support);
+  const BBNode BBForm(const ASTNode& form, BBNodeSet& support);
 
   bool isConstant(const vector<BBNode>& v);
   ASTNode getConstant(const vector<BBNode>& v, const ASTNode& n);
@@ -232,13 +262,22 @@ template <class BBNode, class BBNodeManagerT> class BitBlaster // not copyable
 
   ASTNodeSet booth_recoded; // Nodes that have been recoded.
 
+  // Nodes bit-blasted since the clock was last read.
+  unsigned sinceTimeoutCheck;
+  bool timedOut(const ASTNode& n);
+
+  // How deeply BBTerm and BBForm have recursed.
+  unsigned depth;
+  void bitblastBelow(const ASTNode& n, BBNodeSet& support);
+
 public:
   simplifier::constantBitP::ConstantBitPropagation* cb;
 
   // Bit blast a bitvector term.  The term must have a kind for a
   // bitvector term.  Result is a ref to a vector of formula nodes
-  // representing the boolean formula.
-  const vector<BBNode> BBTerm(const ASTNode& term, set<BBNode>& support);
+  // representing the boolean formula. It's the memo table's entry, so it
+  // stays valid until the tables are cleared.
+  const vector<BBNode>& BBTerm(const ASTNode& term, BBNodeSet& support);
 
   BitBlaster(BBNodeManagerT* bnm, Simplifier* _simp, NodeFactory* astNodeF,
              UserDefinedFlags* _uf,
@@ -251,7 +290,9 @@ public:
     bbbvle_variant("1" == _uf->get("bbbvle_variant", "0")),
     upper_multiplication_bound("1" ==_uf->get("upper_multiplication_bound", "0")),
     bvplus_variant("1" == _uf->get("bvplus_variant", "1")),
-    multiplication_variant(_uf->get("multiplication_variant", "7"))
+    multiplication_variant(_uf->get("multiplication_variant", "7")),
+    sinceTimeoutCheck(0),
+    depth(0)
   {
     nf = bnm;
     cb = cb_;
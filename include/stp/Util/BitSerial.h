@@ -0,0 +1,407 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+// The bit at a time versions of the AND, OR, XOR, NOT and EQUALS transfer
+// functions, from before they worked on whole words. test_cbitp checks the
+// word versions give the same answers, and time_cbitp compares their speed.
+
+#ifndef BITSERIAL_H_
+#define BITSERIAL_H_
+
+#include <vector>
+#include "stp/Simplifier/constantBitP/ConstantBitP_TransferFunctions.h"
+#include "stp/Simplifier/constantBitP/ConstantBitP_Utility.h"
+#include "stp/Simplifier/constantBitP/FixedBits.h"
+
+namespace simplifier
+{
+namespace constantBitP
+{
+namespace bitserial
+{
+using std::vector;
+
+inline Result bvXorBothWays(vector<FixedBits*>& operands, FixedBits& output)
+{
+  Result result = NO_CHANGE;
+  const int bitWidth = output.getWidth();
+
+  for (int i = 0; i < bitWidth; i++)
+  {
+    const stats status = getStats(operands, i);
+
+    if (status.unfixed == 0) // if they are all fixed. We know the answer.
+    {
+      bool answer = (status.fixedToOne % 2) != 0;
+
+      if (!output.isFixed(i))
+      {
+        output.setFixed(i, true);
+        output.setValue(i, answer);
+        result = CHANGED;
+      }
+      else if (output.getValue(i) != answer)
+        return CONFLICT;
+    }
+    else if (status.unfixed == 1 && output.isFixed(i))
+    {
+      // If there is just one unfixed, and we have the answer --> We know the
+      // value.
+      bool soFar = ((status.fixedToOne % 2) != 0);
+      if (soFar != output.getValue(i))
+      { // result needs to be flipped.
+        fixUnfixedTo(operands, i, true);
+      }
+      else
+        fixUnfixedTo(operands, i, false);
+      result = CHANGED;
+    }
+  }
+  return result;
+}
+
+// if output bit is true. Fix all the operands.
+// if all the operands are fixed. Fix the output.
+// given 1,1,1,- == 0, fix - to 0.
+inline Result bvAndBothWays(vector<FixedBits*>& operands, FixedBits& output)
+{
+  Result result = NO_CHANGE;
+  const int bitWidth = output.getWidth();
+
+  for (int i = 0; i < bitWidth; i++)
+  {
+    const stats status = getStats(operands, i);
+
+    // output is fixed to one. But an input value is false!
+    if (output.isFixed(i) && output.getValue(i) && status.fixedToZero > 0)
+      return CONFLICT;
+
+    // output is fixed to one. But an input value is false!
+    if (output.isFixed(i) && !output.getValue(i) && status.fixedToZero == 0 &&
+        status.unfixed == 0)
+      return CONFLICT;
+
+    // output is fixed to one. So all should be one.
+    if (output.isFixed(i) && output.getValue(i) && status.unfixed > 0)
+    {
+      fixUnfixedTo(operands, i, true);
+      result = CHANGED;
+    }
+
+    // The output is unfixed. At least one input is false.
+    if (!output.isFixed(i) && status.fixedToZero > 0)
+    {
+      output.setFixed(i, true);
+      output.setValue(i, false);
+      result = CHANGED;
+    }
+
+    // Everything is fixed to one!
+    if (!output.isFixed(i) && status.fixedToZero == 0 && status.unfixed == 0)
+    {
+      output.setFixed(i, true);
+      output.setValue(i, true);
+      result = CHANGED;
+    }
+
+    // If the output is false, and there is a single unfixed value with
+    // everything else true..
+    if (output.isFixed(i) && !output.getValue(i) && status.fixedToZero == 0 &&
+        status.unfixed == 1)
+    {
+      fixUnfixedTo(operands, i, false);
+      result = CHANGED;
+    }
+  }
+  return result;
+}
+
+inline Result bvOrBothWays(vector<FixedBits*>& children, FixedBits& output)
+{
+  Result r = NO_CHANGE;
+  const int numberOfChildren = children.size();
+  const int bitWidth = output.getWidth();
+
+  for (int i = 0; i < bitWidth; i++)
+  {
+    bool answerKnown = output.isFixed(i);
+    bool answer = false;
+    if (answerKnown)
+      answer = output.getValue(i);
+
+    int unks = 0;
+    int ones = 0;
+    int zeroes = 0;
+
+    for (int j = 0; j < numberOfChildren; j++)
+    {
+      assert(output.getWidth() == children[j]->getWidth());
+
+      if (!children[j]->isFixed(i))
+        unks++;
+      else if (children[j]->getValue(i))
+        ones++;
+      else
+        zeroes++;
+    }
+
+    if (ones > 0) // Atleast a single one found!
+
+    {
+      if (answerKnown && !answer)
+        return CONFLICT;
+
+      if (!answerKnown)
+      {
+        output.setFixed(i, true);
+        output.setValue(i, true);
+        r = CHANGED;
+      }
+    }
+
+    if (zeroes == numberOfChildren) // all zeroes.
+
+    {
+      if (answerKnown && answer)
+        return CONFLICT;
+
+      if (!answerKnown)
+      {
+        r = CHANGED;
+        output.setFixed(i, true);
+        output.setValue(i, false);
+      }
+    }
+
+    if (answerKnown && !answer) // known false
+
+    {
+      if (ones > 0)
+        return CONFLICT;
+
+      // set all the column to false.
+
+      for (int j = 0; j < numberOfChildren; j++)
+      {
+        if (!children[j]->isFixed(i))
+        {
+          r = CHANGED;
+          children[j]->setFixed(i, true);
+          children[j]->setValue(i, false);
+        }
+      }
+    }
+
+    if (unks == 1 && answerKnown && answer &&
+        (zeroes == (numberOfChildren - 1)))
+    {
+      // A single unknown, everything else is false. The answer is true. So the
+      // unknown is true.
+
+      for (int j = 0; j < numberOfChildren; j++)
+      {
+        if (!children[j]->isFixed(i))
+        {
+          r = CHANGED;
+          children[j]->setFixed(i, true);
+          children[j]->setValue(i, true);
+        }
+      }
+    }
+  }
+  return r;
+}
+
+inline Result bvNotBothWays(FixedBits& a, FixedBits& output)
+{
+  assert(a.getWidth() == output.getWidth());
+  const int bitWidth = a.getWidth();
+
+  Result result = NO_CHANGE;
+
+  for (int i = 0; i < bitWidth; i++)
+  {
+    // error if they are the same.
+    if (a.isFixed(i) && output.isFixed(i) &&
+        (a.getValue(i) == output.getValue(i)))
+    {
+      return CONFLICT;
+    }
+
+    if (a.isFixed(i) && !output.isFixed(i))
+    {
+      output.setFixed(i, true);
+      output.setValue(i, !a.getValue(i));
+      result = CHANGED;
+    }
+
+    if (output.isFixed(i) && !a.isFixed(i))
+    {
+      a.setFixed(i, true);
+      a.setValue(i, !output.getValue(i));
+      result = CHANGED;
+    }
+  }
+  return result;
+}
+
+inline Result bvEqualsBothWays(FixedBits& a, FixedBits& b, FixedBits& output)
+{
+  assert(a.getWidth() == b.getWidth());
+  assert(1 == output.getWidth());
+
+  const int childWidth = a.getWidth();
+
+  Result r = NO_CHANGE;
+
+  bool allSame = true;
+  bool definatelyFalse = false;
+
+  for (int i = 0; i < childWidth; i++)
+  {
+    // if both fixed
+    if (a.isFixed(i) && b.isFixed(i))
+    {
+      // And have different values.
+      if (a.getValue(i) != b.getValue(i))
+      {
+        definatelyFalse = true;
+        break;
+      }
+      else
+      {
+        allSame &= true;
+        continue;
+      }
+    }
+    allSame &= false;
+  }
+
+  if (definatelyFalse)
+  {
+    if (output.isFixed(0) && output.getValue(0))
+    {
+      return CONFLICT;
+    }
+    else if (!output.isFixed(0))
+    {
+      output.setFixed(0, true);
+      output.setValue(0, false);
+      r = CHANGED;
+    }
+  }
+  else if (allSame)
+  {
+    if (output.isFixed(0) && !output.getValue(0))
+    {
+      return CONFLICT;
+    }
+    else if (!output.isFixed(0))
+    {
+      output.setFixed(0, true);
+      output.setValue(0, true);
+      r = CHANGED;
+    }
+  }
+
+  if (output.isFixed(0) && output.getValue(0)) // all should be the same.
+  {
+    for (int i = 0; i < childWidth; i++)
+    {
+      if (a.isFixed(i) && b.isFixed(i))
+      {
+        if (a.getValue(i) != b.getValue(i))
+        {
+          return CONFLICT;
+        }
+      }
+      else if (a.isFixed(i) != b.isFixed(i)) // both same but only one is fixed.
+      {
+        if (a.isFixed(i))
+        {
+          b.setFixed(i, true);
+          b.setValue(i, a.getValue(i));
+          r = CHANGED;
+        }
+        else
+        {
+          a.setFixed(i, true);
+          a.setValue(i, b.getValue(i));
+          r = CHANGED;
+        }
+      }
+    }
+  }
+
+  // if the result is fixed to false, there is a single unspecied value, and all
+  // the rest are the same. Fix it to the opposite.
+  if (output.isFixed(0) && !output.getValue(0))
+  {
+    int unknown = 0;
+
+    for (int i = 0; i < childWidth && unknown < 2; i++)
+    {
+      if (!a.isFixed(i))
+        unknown++;
+      if (!b.isFixed(i))
+        unknown++;
+      else if (a.isFixed(i) && b.isFixed(i) && a.getValue(i) != b.getValue(i))
+      {
+        unknown = 10; // hack, don't do the next loop.
+        break;
+      }
+    }
+
+    if (1 == unknown)
+    {
+      for (int i = 0; i < childWidth; i++)
+      {
+        if (!a.isFixed(i))
+        {
+          a.setFixed(i, true);
+          a.setValue(i, !b.getValue(i));
+          r = CHANGED;
+        }
+        if (!b.isFixed(i))
+        {
+          b.setFixed(i, true);
+          b.setValue(i, !a.getValue(i));
+          r = CHANGED;
+        }
+      }
+    }
+  }
+  return r;
+}
+
+inline Result bvEqualsBothWays(vector<FixedBits*>& children, FixedBits& result)
+{
+  return bitserial::bvEqualsBothWays(*(children[0]), *(children[1]), result);
+}
+
+inline Result bvNotBothWays(vector<FixedBits*>& children, FixedBits& result)
+{
+  return bitserial::bvNotBothWays(*(children[0]), result);
+}
+}
+}
+}
+
+#endif
@@ -0,0 +1,141 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+// A pool of fixed sized blocks, each big enough to hold a T. Blocks are carved
+// out of large slabs, so objects allocated one after the other sit next to
+// each other in memory, and released blocks are kept on a free list for reuse
+// rather than being handed back to malloc.
+//
+// The pool only manages memory. Callers construct objects with placement new
+// into allocate(), and call the destructor themselves before release().
+
+#ifndef SLABALLOCATOR_H
+#define SLABALLOCATOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace stp
+{
+
+template <class T> class SlabAllocator
+{
+  union Block
+  {
+    Block* next;
+    char storage[sizeof(T)];
+  };
+
+  enum
+  {
+    first_slab_size = 1024,
+    max_slab_size = 1 << 16
+  };
+
+  std::vector<Block*> slabs;
+
+  // Released blocks, linked through their first word.
+  Block* free_list;
+
+  // The unused tail of the most recent slab.
+  Block* next_unused;
+  Block* slab_end;
+
+  size_t live;
+  size_t reserved_bytes;
+
+  // Not copyable.
+  SlabAllocator(const SlabAllocator&);
+  SlabAllocator& operator=(const SlabAllocator&);
+
+  void newSlab()
+  {
+    size_t size = first_slab_size;
+    if (!slabs.empty())
+    {
+      size = 2 * (slab_end - slabs.back());
+      if (size > max_slab_size)
+        size = max_slab_size;
+    }
+
+    Block* slab = static_cast<Block*>(::operator new(size * sizeof(Block)));
+    slabs.push_back(slab);
+    reserved_bytes += size * sizeof(Block);
+    next_unused = slab;
+    slab_end = slab + size;
+  }
+
+public:
+  SlabAllocator() : free_list(NULL), next_unused(NULL), slab_end(NULL), live(0),
+                    reserved_bytes(0)
+  {
+  }
+
+  // Hands the slabs back in one go. If some objects are still alive their
+  // memory can't be reclaimed, so the slabs are kept, as a node that was
+  // allocated individually would have been.
+  ~SlabAllocator()
+  {
+    if (live != 0)
+      return;
+
+    for (size_t i = 0; i < slabs.size(); i++)
+      ::operator delete(slabs[i]);
+  }
+
+  void* allocate()
+  {
+    live++;
+
+    if (free_list != NULL)
+    {
+      Block* b = free_list;
+      free_list = b->next;
+      return b;
+    }
+
+    if (next_unused == slab_end)
+      newSlab();
+
+    return next_unused++;
+  }
+
+  void release(T* t)
+  {
+    assert(live > 0);
+    live--;
+
+    Block* b = reinterpret_cast<Block*>(t);
+    b->next = free_list;
+    free_list = b;
+  }
+
+  // Number of blocks currently handed out.
+  size_t size() const { return live; }
+
+  // Bytes obtained from the system for slabs.
+  size_t reserved() const { return reserved_bytes; }
+};
+
+} // end namespace stp
+
+#endif
@@ -73,7 +73,25 @@ enum ifaceflag_t
   MS,
   SMS,
   CMS4,
-  MSP
+  MSP,
+  /*! INCREMENTAL: boolean, default false. Keep one SAT solver for all
+    queries. Formulas that stay asserted are only converted to CNF once, and
+    the solver keeps what it has learnt between queries. */
+  INCREMENTAL,
+  /*! PORTFOLIO: int, the number of SAT solvers to race against each other
+    on separate threads. The first answer is used. Zero or less goes back
+    to plain MiniSat. */
+  PORTFOLIO,
+  /*! ARRAY_ENCODING: int, how array reads are related to each other.
+    0 (the default) adds the axioms lazily by abstraction refinement, 1 adds
+    them all up front as nested ITEs, which is quadratic in the number of
+    reads, and 2 adds them up front through a sorting network on the read
+    indexes, which is O(n log^2 n). */
+  ARRAY_ENCODING,
+  /*! PROFILE: boolean, default false. Record the time spent in each pass
+    of a query, with node counts, cache, CNF and SAT statistics. See
+    vc_printProfileToBuffer(). */
+  PROFILE
 
 };
 void vc_setInterfaceFlags(VC vc, enum ifaceflag_t f, int param_value);
@@ -204,6 +222,11 @@ void vc_printQueryStateToBuffer(VC vc, Expr e, char** buf, unsigned long* len,
 //! Similar to vc_printQueryStateToBuffer()
 void vc_printCounterExampleToBuffer(VC vc, char** buf, unsigned long* len);
 
+//! Prints what was recorded for the last query as a JSON object.
+/*! Needs the PROFILE interface flag. The buffer is allocated with malloc(),
+  so free it with free(). */
+void vc_printProfileToBuffer(VC vc, char** buf, unsigned long* len);
+
 //! Prints query to stdout.
 void vc_printQuery(VC vc);
 
@@ -224,13 +247,10 @@ Expr vc_simplify(VC vc, Expr e);
 // returns 2 -> then ERROR
 // returns 3 -> then TIMEOUT
 
-// NB. The timeout is a soft timeout, use the -g flag for a hard timeout that
-// will abort automatically. The soft timeout is checked sometimes in the code,
-// and if the time has passed, then "timeout" will be returned. It's only
-// checked
-// sometimes though, so the actual timeout may be larger. Cryptominisat doesn't
-// check
-// the timeout yet..
+// NB. The timeout is in milliseconds of wall-clock time, -1 means no limit.
+// It's checked between and during the simplification passes, during
+// bit-blasting, and the SAT solver is interrupted when it passes, so
+// "timeout" is returned shortly after the time is up.
 
 // The C-language doesn't allow default arguments, so to get it compiling, I've
 // split it into two functions.
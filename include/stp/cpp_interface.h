@@ -27,7 +27,10 @@ THE SOFTWARE.
 
 #include "stp/AST/AST.h"
 #include "stp/AST/NodeFactory/NodeFactory.h"
+#include <cstdio>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -48,6 +51,13 @@ class Cpp_interface
   bool print_success;
   bool ignoreCheckSatRequest;
 
+  // True when the counterexample held by the solver is a model of the last
+  // check-sat, so get-value and get-model can be answered without solving.
+  bool modelAvailable;
+
+  // The answer to the most recent check-sat.
+  SOLVER_RETURN_TYPE lastResult;
+
   // Used to cache prior queries.
   struct Entry
   {
@@ -73,6 +83,10 @@ class Cpp_interface
   vector<Entry> cache;
   vector<vector<ASTNode>> symbols;
 
+  // Symbols whose scope has been popped. They may live on in the manager,
+  // but the parser treats them as undeclared.
+  ASTNodeSet poppedSymbols;
+
   struct Function
   {
     ASTVec params;
@@ -82,9 +96,27 @@ class Cpp_interface
 
   hash_map<std::string, Function> functions;
 
+  // The values the SMT-LIB2 parser has allocated and not yet deleted. An
+  // error unwinds the parser past its own deletes, so parseSMTLIB2() frees
+  // whatever is left. NULL when no SMT-LIB2 parse is running.
+  struct ParserValues
+  {
+    std::set<ASTNode*> nodes;
+    std::set<ASTVec*> vecs;
+    std::set<std::string*> strings;
+  };
+  ParserValues* parserValues;
+
   void checkInvariant();
   void init();
 
+  // With --incremental the solver is kept between check-sats rather than
+  // being reset.
+  bool isIncremental() const;
+  SOLVER_RETURN_TYPE solve(const ASTVec& conjuncts);
+  void markSatisfiable(const ASTVec& assertionsSMT2);
+  void printResult(SOLVER_RETURN_TYPE result);
+
 public:
   std::unique_ptr<LETMgr> letMgr;
   NodeFactory* nf;
@@ -150,7 +182,20 @@ public:
   ASTNode* newNode(const ASTNode& copyIn);
 
   void deleteNode(ASTNode* n);
+  ASTVec* newVec();
+  void deleteVec(ASTVec* v);
+  std::string* newString(const std::string& s);
+  void deleteString(std::string* s);
+
+  // Called by parseSMTLIB2() around the parse.
+  void startTrackingParserValues();
+  void freeParserValues();
+
   void addSymbol(ASTNode& s);
+
+  // Declares a symbol of the given sort in the current scope.
+  ASTNode declareSymbol(const char* const name, unsigned indexWidth,
+                        unsigned valueWidth);
   void success();
 
   // Resets the tables used by STP, but keeps all the nodes that have been
@@ -171,10 +216,34 @@ public:
 
   void checkSat(const ASTVec& assertionsSMT2);
 
+  SOLVER_RETURN_TYPE getLastResult() const { return lastResult; }
+
+  // Checks the assertions together with the assumptions. The assumptions are
+  // forgotten afterwards.
+  void checkSatAssuming(const ASTVec& assertionsSMT2,
+                        const ASTVec& assumptions);
+
+  // Print the values of terms, or the whole model, from the last satisfiable
+  // check-sat.
+  void getValue(const ASTVec& terms);
+  void getModel();
+
+  // Pops all the levels, and removes the assertions from the base level.
+  void resetAssertions();
+
   void deleteGlobal();
 
   void cleanUp();
 };
+
+// Parses SMT-LIB2 from "in" (stdin if NULL), passing the commands to
+// GlobalParserInterface. The SMT-LIB2 parser is reentrant, so each thread can
+// parse with its own interface at the same time.
+int parseSMTLIB2(FILE* in);
+
+// The CVC and SMT-LIB1 parsers keep their state in globals, so only one
+// thread at a time can use them. Hold this for the whole parse.
+std::mutex& globalParserMutex();
 }
 
 #endif
@@ -28,19 +28,61 @@ namespace stp
 {
 const ASTVec ASTBVConst::astbv_empty_children;
 
-ASTBVConst::ASTBVConst(const ASTBVConst& sym) : ASTInternal(sym._kind)
+ASTBVConst::ASTBVConst(const ASTBVConst& sym) : ASTBVConst(sym, NULL)
 {
-  _bvconst = CONSTANTBV::BitVector_Clone(sym._bvconst);
+}
+
+ASTBVConst::ASTBVConst(const ASTBVConst& sym, STPMgr* mgr)
+    : ASTInternal(sym._kind)
+{
+  _mgr = mgr;
   _value_width = sym._value_width;
   cbv_managed_outside = false;
+  _value = 0;
+  if (isSmall())
+    setInline(sym._value);
+  else
+    _bvconst = CONSTANTBV::BitVector_Clone(sym._bvconst);
+}
+
+// Lays out a CBV holding the value in _inline_bv, the way
+// CONSTANTBV::BitVector_Create would on the heap.
+void ASTBVConst::setInline(uint64_t value)
+{
+  assert(isSmall());
+  assert(CONSTANTBV::BitVector_Word_Bits() == 32);
+
+  if (_value_width < 64)
+    value &= ((uint64_t)1 << _value_width) - 1;
+  _value = value;
+
+  _bvconst = _inline_bv + 3;
+  bits_(_bvconst) = _value_width;
+  size_(_bvconst) = CONSTANTBV::BitVector_Size(_value_width);
+  mask_(_bvconst) = CONSTANTBV::BitVector_Mask(_value_width);
+  _bvconst[0] = (unsigned int)value;
+  _bvconst[1] = (unsigned int)(value >> 32);
+}
+
+uint64_t ASTBVConst::readSmall(const CBV bv) const
+{
+  assert(isSmall());
+  assert(bits_(bv) == _value_width);
+  uint64_t result = bv[0] & (size_(bv) == 1 ? mask_(bv) : ~0u);
+  if (size_(bv) > 1)
+    result |= ((uint64_t)(bv[1] & mask_(bv))) << 32;
+  return result;
 }
 
 // Call this when deleting a node that has been stored in the the
 // unique table
 void ASTBVConst::CleanUp()
 {
-  (GlobalParserBM)->_bvconst_unique_table.erase(this);
-  delete this;
+  STPMgr* mgr = _mgr;
+  assert(mgr != NULL);
+  mgr->_bvconst_unique_table.erase(this);
+  this->~ASTBVConst();
+  mgr->_bvconst_pool.release(this);
 } 
 
 // Print function for bvconst -- return _bvconst value in bin
@@ -51,7 +93,7 @@ void ASTBVConst::nodeprint(ostream& os, bool c_friendly)
   unsigned char* res;
   const char* prefix;
 
-  if ((GlobalSTP->bm)->UserFlags.print_binary_flag)
+  if (_mgr->UserFlags.print_binary_flag)
   {
     res = CONSTANTBV::BitVector_to_Bin(_bvconst);
     if (c_friendly)
@@ -104,17 +146,20 @@ CBV ASTBVConst::GetBVConst() const
 
 size_t ASTBVConst::ASTBVConstHasher::operator()(const ASTBVConst* bvc) const
 {
+  if (bvc->isSmall())
+  {
+    const uint64_t h =
+        (bvc->_value ^ ((uint64_t)bvc->_value_width << 58)) *
+        0x9E3779B97F4A7C15ULL;
+    return (size_t)(h ^ (h >> 32));
+  }
   return CONSTANTBV::BitVector_Hash(bvc->_bvconst);
 } 
 
 bool ASTBVConst::ASTBVConstEqual::operator()(const ASTBVConst* bvc1,
                                              const ASTBVConst* bvc2) const
 {
-  if (bvc1->_value_width != bvc2->_value_width)
-  {
-    return false;
-  }
-  return (0 == CONSTANTBV::BitVector_Compare(bvc1->_bvconst, bvc2->_bvconst));
+  return *bvc1 == *bvc2;
 }
 
 } //end of namespace
@@ -34,8 +34,25 @@ namespace stp
 // the unique table
 void ASTInterior::CleanUp()
 {
-  (GlobalParserBM)->_interior_unique_table.erase(this);
-  delete this;
+  STPMgr* mgr = _mgr;
+  assert(mgr != NULL);
+  mgr->_interior_unique_table.erase(this);
+
+  // Destroying the children can drop their last references too. Those nodes
+  // are queued here and freed by the outermost call.
+  mgr->_interior_cleanup_pending.push_back(this);
+  if (mgr->_interior_cleanup_running)
+    return;
+
+  mgr->_interior_cleanup_running = true;
+  while (!mgr->_interior_cleanup_pending.empty())
+  {
+    ASTInterior* n = mgr->_interior_cleanup_pending.back();
+    mgr->_interior_cleanup_pending.pop_back();
+    n->~ASTInterior();
+    mgr->_interior_pool.release(n);
+  }
+  mgr->_interior_cleanup_running = false;
 } 
 
 // Returns kinds.  "lispprinter" handles printing of parenthesis
@@ -54,8 +71,13 @@ void ASTInterior::nodeprint(ostream& os, bool c_friendly)
 size_t ASTInterior::ASTInteriorHasher::
 operator()(const ASTInterior* int_node_ptr) const
 {
-  size_t hashval = ((size_t)int_node_ptr->GetKind());
-  const ASTVec& ch = int_node_ptr->GetChildren();
+  return (*this)(Key(int_node_ptr->GetKind(), int_node_ptr->GetChildren()));
+}
+
+size_t ASTInterior::ASTInteriorHasher::operator()(const Key& key) const
+{
+  size_t hashval = ((size_t)key.kind);
+  const ASTVec& ch = key.children;
   ASTVec::const_iterator iend = ch.end();
   for (ASTVec::const_iterator i = ch.begin(); i != iend; i++)
   {
@@ -78,4 +100,11 @@ operator()(const ASTInterior* int_node_ptr1,
   return (*int_node_ptr1 == *int_node_ptr2);
 }
 
+bool ASTInterior::ASTInteriorEqual::operator()(const ASTInterior* int_node_ptr,
+                                               const Key& key) const
+{
+  return ((int_node_ptr->_kind == key.kind) &&
+          (int_node_ptr->_children == key.children));
+}
+
 } // end of namespace
@@ -28,12 +28,12 @@ THE SOFTWARE.
 
 namespace stp
 {
-uint8_t ASTNode::getIteration() const
+uint32_t ASTNode::getIteration() const
 {
   return _int_node_ptr->iteration;
 }
 
-void ASTNode::setIteration(uint8_t v) const
+void ASTNode::setIteration(uint32_t v) const
 {
   _int_node_ptr->iteration = v;
 }
@@ -136,7 +136,9 @@ ASTNode::~ASTNode()
 
 STPMgr* ASTNode::GetSTPMgr() const
 {
-  return GlobalParserBM;
+  if (_int_node_ptr == NULL)
+    return GlobalParserBM;
+  return _int_node_ptr->GetSTPMgr();
 }
 
 // Print the node
@@ -166,6 +168,12 @@ CBV ASTNode::GetBVConst() const
   return ((ASTBVConst*)_int_node_ptr)->GetBVConst();
 }
 
+uint64_t ASTNode::GetSmallBVConst() const
+{
+  assert(BVCONST == GetKind() && GetValueWidth() <= 64);
+  return ((ASTBVConst*)_int_node_ptr)->GetSmallValue();
+}
+
 unsigned int ASTNode::GetUnsignedConst() const
 {
   const ASTNode& n = *this;
@@ -45,9 +45,12 @@ void ASTSymbol::nodeprint(ostream& os, bool c_friendly)
 // unique table
 void ASTSymbol::CleanUp()
 {
-  (GlobalParserBM)->_symbol_unique_table.erase(this);
+  STPMgr* mgr = _mgr;
+  assert(mgr != NULL);
+  mgr->_symbol_unique_table.erase(this);
   free((char*)this->_name);
-  delete this;
+  this->~ASTSymbol();
+  mgr->_symbol_pool.release(this);
 }
 
 } // end of namespace
@@ -345,44 +345,51 @@ void checkChildrenAreBV(const ASTVec& v, const ASTNode& n)
  * AND,OR operations are not
  * flattened multiple times.
  */
+// These walk the nested nodes with their own stack of child lists, so that
+// long chains don't overflow the native stack.
 void FlattenKindNoDuplicates(const Kind k, const ASTVec& children,
                              ASTVec& flat_children,
                              ASTNodeSet& alreadyFlattened)
 {
-  const ASTVec::const_iterator ch_end = children.end();
-  for (ASTVec::const_iterator it = children.begin(); it != ch_end; it++)
+  vector<std::pair<const ASTVec*, size_t>> todo;
+  todo.push_back(std::make_pair(&children, (size_t)0));
+  while (!todo.empty())
   {
-    const Kind ck = it->GetKind();
-    if (k == ck)
+    const ASTVec& v = *todo.back().first;
+    const size_t i = todo.back().second++;
+    if (i == v.size())
     {
-      if (alreadyFlattened.find(*it) == alreadyFlattened.end())
-      {
-        alreadyFlattened.insert(*it);
-        FlattenKindNoDuplicates(k, it->GetChildren(), flat_children,
-                                alreadyFlattened);
-      }
-    }
-    else
-    {
-      flat_children.push_back(*it);
+      todo.pop_back();
+      continue;
     }
+
+    const ASTNode& n = v[i];
+    if (k != n.GetKind())
+      flat_children.push_back(n);
+    else if (alreadyFlattened.insert(n).second)
+      todo.push_back(std::make_pair(&n.GetChildren(), (size_t)0));
   }
 }
 
 void FlattenKind(const Kind k, const ASTVec& children, ASTVec& flat_children)
 {
-  ASTVec::const_iterator ch_end = children.end();
-  for (ASTVec::const_iterator it = children.begin(); it != ch_end; it++)
+  vector<std::pair<const ASTVec*, size_t>> todo;
+  todo.push_back(std::make_pair(&children, (size_t)0));
+  while (!todo.empty())
   {
-    Kind ck = it->GetKind();
-    if (k == ck)
+    const ASTVec& v = *todo.back().first;
+    const size_t i = todo.back().second++;
+    if (i == v.size())
     {
-      FlattenKind(k, it->GetChildren(), flat_children);
+      todo.pop_back();
+      continue;
     }
+
+    const ASTNode& n = v[i];
+    if (k != n.GetKind())
+      flat_children.push_back(n);
     else
-    {
-      flat_children.push_back(*it);
-    }
+      todo.push_back(std::make_pair(&n.GetChildren(), (size_t)0));
   }
 }
 
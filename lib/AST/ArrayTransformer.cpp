@@ -64,6 +64,36 @@ ASTNode ArrayTransformer::TransformFormula_TopLevel(const ASTNode& form)
   if (bm->UserFlags.stats_flag)
     printArrayStats();
 
+  // Relate the reads of each array that was read from, through a sorting
+  // network on the read indexes.
+  if (!arraysToSort.empty())
+  {
+    ASTVec axioms;
+    axioms.push_back(result);
+    for (std::set<ASTNode>::const_iterator it = arraysToSort.begin();
+         it != arraysToSort.end(); it++)
+    {
+      const arrTypeMap& reads = arrayToIndexToRead[*it];
+      ASTVec indexes, values;
+      bool allConstant = true;
+      for (arrTypeMap::const_iterator it2 = reads.begin(); it2 != reads.end();
+           it2++)
+      {
+        indexes.push_back(it2->first);
+        values.push_back(it2->second.symbol);
+        allConstant &= it2->first.isConstant();
+      }
+
+      // Distinct constant indexes never need relating.
+      if (indexes.size() > 1 && !allConstant)
+        axioms.push_back(SortedReadCongruence(indexes, values));
+    }
+    arraysToSort.clear();
+
+    if (axioms.size() > 1)
+      result = nf->CreateNode(AND, axioms);
+  }
+
   // This establishes equalities between every indexes, and a fresh variable.
   if (!bm->UserFlags.ackermannisation)
   {
@@ -504,6 +534,64 @@ ASTNode ArrayTransformer::TransformTerm(const ASTNode& term)
   return result;
 } 
 
+/* Nested ITEs relate the k-th read of an array to all the reads before it,
+ * which is quadratic in the number of reads. Instead, the reads are passed
+ * through an odd-even merge sorting network keyed on the index, after which
+ * reads with equal indexes are adjacent. So it's enough to constrain each
+ * read to equal its neighbour when their indexes are equal. This takes
+ * O(n log^2 n) comparators.
+ */
+ASTNode ArrayTransformer::SortedReadCongruence(ASTVec indexes, ASTVec values)
+{
+  assert(indexes.size() == values.size());
+  const int n = indexes.size();
+  const unsigned indexWidth = indexes[0].GetValueWidth();
+  const unsigned valueWidth = values[0].GetValueWidth();
+
+  long comparators = 0;
+  for (int p = 1; p < n; p <<= 1)
+    for (int k = p; k >= 1; k >>= 1)
+      for (int j = k % p; j + k < n; j += 2 * k)
+        for (int i = 0; i < k && i + j + k < n; i++)
+        {
+          if ((i + j) / (2 * p) != (i + j + k) / (2 * p))
+            continue;
+
+          const int a = i + j;
+          const int b = i + j + k;
+          const ASTNode inOrder = nf->CreateNode(BVLE, indexes[a], indexes[b]);
+
+          const ASTNode lowIndex =
+              nf->CreateTerm(ITE, indexWidth, inOrder, indexes[a], indexes[b]);
+          const ASTNode highIndex =
+              nf->CreateTerm(ITE, indexWidth, inOrder, indexes[b], indexes[a]);
+          const ASTNode lowValue =
+              nf->CreateTerm(ITE, valueWidth, inOrder, values[a], values[b]);
+          const ASTNode highValue =
+              nf->CreateTerm(ITE, valueWidth, inOrder, values[b], values[a]);
+
+          indexes[a] = lowIndex;
+          indexes[b] = highIndex;
+          values[a] = lowValue;
+          values[b] = highValue;
+          comparators++;
+        }
+
+  runTimes->addCounter("Array sorting comparators", comparators);
+
+  ASTVec axioms;
+  for (int i = 0; i + 1 < n; i++)
+  {
+    const ASTNode sameIndex = nf->CreateNode(EQ, indexes[i], indexes[i + 1]);
+    const ASTNode sameValue = nf->CreateNode(EQ, values[i], values[i + 1]);
+    axioms.push_back(nf->CreateNode(IMPLIES, sameIndex, sameValue));
+  }
+
+  if (axioms.size() == 1)
+    return axioms[0];
+  return nf->CreateNode(AND, axioms);
+}
+
 /* This function transforms Array Reads, Read over Writes, Read over
  * ITEs into flattened form.
  *
@@ -575,6 +663,12 @@ ASTNode ArrayTransformer::TransformArrayRead(const ASTNode& term)
         // result is a variable here; it is an ite in the
         // else-branch
       }
+      else if (bm->UserFlags.sorted_ackermannisation)
+      {
+        // result stays a variable. The congruence axioms are added once
+        // all the reads of the formula have been seen.
+        arraysToSort.insert(arrName);
+      }
       else if (bm->UserFlags.isSet("old_ack", "0"))
       {
 
@@ -44,16 +44,11 @@ ASTNode HashingNodeFactory::CreateNode(const Kind kind,
     return back_children[0][0];
   }
 
-  ASTVec children(back_children);
   // The Bitvector solver seems to expect constants on the RHS, variables on the
   // LHS. We leave the order of equals children as we find them.
-  if (isCommutative(kind) && kind != AND)
-  {
-    SortByArith(children);
-  }
+  const bool sortChildren = isCommutative(kind) && kind != AND;
 
-  ASTInterior* n_ptr = new ASTInterior(kind, children);
-  ASTNode n(bm.LookupOrCreateInterior(n_ptr));
+  ASTNode n(bm.LookupOrCreateInterior(kind, back_children, sortChildren));
   return n;
 }
 
@@ -888,6 +888,8 @@ ASTNode SimplifyingNodeFactory::CreateSimpleFormITE(const ASTVec& children)
 // simplify things like:
 // read(write(write(A,1,2),2,3),4) cheaply.
 // The "children" that are passed should be the children of a READ.
+// Runs of writes to constant indexes are skipped with STPMgr::writeChains, so
+// a read of a constant index costs a lookup rather than a walk.
 ASTNode SimplifyingNodeFactory::chaseRead(const ASTVec& children,
                                           unsigned int width)
 {
@@ -910,8 +912,14 @@ ASTNode SimplifyingNodeFactory::chaseRead(const ASTVec& children,
     }
     else if (read_is_const && stp::BVCONST == write_index.GetKind())
     {
-      // They are definately different. Ignore this.
-      // cerr << "+";
+      // They are definately different. Jump to the last write to the read
+      // index, or else past all the writes to constants.
+      ASTNode below;
+      ASTNode value = bm.writeChains.lookup(write, readIndex, below);
+      if (!value.IsNull())
+        return value;
+      write = below;
+      continue;
     }
     else
     {
@@ -60,7 +60,12 @@ long RunTimes::getCurrentTime()
 {
   timeval t;
   gettimeofday(&t, NULL);
-  return (1000 * t.tv_sec) + (t.tv_usec / 1000);
+  return (1000000 * t.tv_sec) + t.tv_usec;
+}
+
+long RunTimes::getCPUTime()
+{
+  return (long)(cpuTime() * 1000000);
 }
 
 void RunTimes::print()
@@ -68,33 +73,32 @@ void RunTimes::print()
   if (0 != category_stack.size())
   {
     std::cerr << "size:" << category_stack.size() << std::endl;
-    std::cerr << "top:" << CategoryNames[category_stack.top().first]
+    std::cerr << "top:" << CategoryNames[category_stack.top().category]
               << std::endl;
     stp::FatalError("category stack is not yet empty!!");
   }
 
   std::ostringstream result;
   result << "statistics\n";
-  std::map<Category, int>::const_iterator it1 = counts.begin();
-  std::map<Category, long>::const_iterator it2 = times.begin();
 
-  int cummulative_ms = 0;
+  long cummulative_ms = 0;
 
-  while (it1 != counts.end())
+  for (int c = 0; c < CategoryCount; c++)
   {
-    int time_ms = 0;
-    if ((it2 = times.find(it1->first)) != times.end())
-      time_ms = it2->second;
-
-    if (time_ms != 0)
+    const long time_ms = times[c] / 1000;
+    if (counts[c] != 0 && time_ms != 0)
     {
-      result << " " << CategoryNames[it1->first] << ": " << it1->second;
+      result << " " << CategoryNames[c] << ": " << counts[c];
       result << " [" << time_ms << "ms]";
       result << std::endl;
       cummulative_ms += time_ms;
     }
-    it1++;
   }
+
+  for (std::map<std::string, long>::const_iterator it = counters.begin();
+       it != counters.end(); it++)
+    result << " " << it->first << ": " << it->second << std::endl;
+
   std::cerr << result.str();
   std::cerr << std::fixed;
   std::cerr.precision(2);
@@ -107,47 +111,100 @@ void RunTimes::print()
   clear();
 }
 
-void RunTimes::addTime(Category c, long milliseconds)
+static void printJSONString(std::ostream& os, const std::string& s)
 {
-  std::map<Category, long>::iterator it;
-  if ((it = times.find(c)) == times.end())
+  os << '"';
+  for (size_t i = 0; i < s.size(); i++)
   {
-    times[c] = milliseconds;
-  }
-  else
-  {
-    it->second += milliseconds;
+    const unsigned char c = s[i];
+    if (c == '"' || c == '\\')
+      os << '\\' << c;
+    else if (c < 0x20)
+      os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c
+         << std::dec << std::setfill(' ');
+    else
+      os << c;
   }
+  os << '"';
 }
 
-void RunTimes::addCount(Category c)
+void RunTimes::printJSON(std::ostream& os)
 {
-  std::map<Category, int>::iterator it;
-  if ((it = counts.find(c)) == counts.end())
+  os << "{\"passes\":{";
+  bool first = true;
+  for (int c = 0; c < CategoryCount; c++)
+  {
+    if (counts[c] == 0)
+      continue;
+    if (!first)
+      os << ",";
+    first = false;
+    printJSONString(os, CategoryNames[c]);
+    os << ":{\"count\":" << counts[c] << ",\"wall_us\":" << times[c];
+    if (profiling)
+      os << ",\"cpu_us\":" << cpuTimes[c];
+    os << "}";
+  }
+
+  os << "},\"nodes\":[";
+  for (size_t i = 0; i < nodeCounts.size(); i++)
   {
-    counts[c] = 1;
+    if (i > 0)
+      os << ",";
+    os << "{\"stage\":";
+    printJSONString(os, nodeCounts[i].first);
+    os << ",\"nodes\":" << nodeCounts[i].second << "}";
   }
-  else
+
+  os << "],\"counters\":{";
+  for (std::map<std::string, long>::const_iterator it = counters.begin();
+       it != counters.end(); it++)
   {
-    it->second++;
+    if (it != counters.begin())
+      os << ",";
+    printJSONString(os, it->first);
+    os << ":" << it->second;
   }
+
+  os << "},\"peak_memory_bytes\":" << (long)memUsedPeak() << "}" << std::endl;
+}
+
+void RunTimes::addCount(Category c)
+{
+  counts[c]++;
+}
+
+void RunTimes::addCounter(const std::string& name, long amount)
+{
+  counters[name] += amount;
+}
+
+void RunTimes::addNodeCount(const std::string& stage, long nodes)
+{
+  nodeCounts.push_back(std::make_pair(stage, nodes));
 }
 
 void RunTimes::stop(Category c)
 {
   Element e = category_stack.top();
   category_stack.pop();
-  if (e.first != c)
+  if (e.category != c)
   {
-    std::cerr << e.first;
+    std::cerr << e.category;
     std::cerr << c;
     stp::FatalError("Don't match");
   }
-  addTime(c, getCurrentTime() - e.second);
+  times[c] += getCurrentTime() - e.wall;
+  if (profiling)
+    cpuTimes[c] += getCPUTime() - e.cpu;
   addCount(c);
 }
 
 void RunTimes::start(Category c)
 {
-  category_stack.push(std::make_pair(c, getCurrentTime()));
+  Element e;
+  e.category = c;
+  e.wall = getCurrentTime();
+  e.cpu = profiling ? getCPUTime() : 0;
+  category_stack.push(e);
 }
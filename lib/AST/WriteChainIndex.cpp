@@ -0,0 +1,116 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+
+#include "stp/AST/WriteChainIndex.h"
+#include <algorithm>
+
+namespace stp
+{
+
+static bool beforeWrite(unsigned depth, const std::pair<unsigned, ASTNode>& w)
+{
+  return depth < w.first;
+}
+
+// Indexes "write" and any writes under it that aren't indexed yet.
+WriteChainIndex::Position WriteChainIndex::add(const ASTNode& write)
+{
+  assert(write.GetKind() == WRITE && write[1].isConstant());
+
+  // Walk down until reaching an indexed write, or the end of the run of
+  // constant-index writes. Iterative, because chains can be very long.
+  ASTVec pending;
+  Position under = {NULL, 0};
+  ASTNode n = write;
+  while (true)
+  {
+    PositionMap::const_iterator it = positions.find(n);
+    if (it != positions.end())
+    {
+      under = it->second;
+      break;
+    }
+    pending.push_back(n);
+
+    const ASTNode next = n[0];
+    n = next;
+    if (n.GetKind() != WRITE || !n[1].isConstant())
+      break;
+  }
+
+  if (pending.empty())
+    return under;
+
+  // Extend the segment if the writes go on from its top. Otherwise the
+  // writes start a new segment over "n".
+  Segment* s = under.segment;
+  unsigned depth = under.depth;
+  if (s == NULL || s->top != n)
+  {
+    s = new Segment;
+    s->base = n;
+    segments.push_back(s);
+    depth = 0;
+  }
+
+  for (ASTVec::const_reverse_iterator it = pending.rbegin();
+       it != pending.rend(); it++)
+  {
+    depth++;
+    s->writes[(*it)[1]].push_back(std::make_pair(depth, (*it)[2]));
+    s->top = *it;
+    Position p = {s, depth};
+    positions[*it] = p;
+  }
+
+  Position p = {s, depth};
+  return p;
+}
+
+ASTNode WriteChainIndex::lookup(const ASTNode& write, const ASTNode& index,
+                                ASTNode& below)
+{
+  assert(index.isConstant());
+  const Position p = add(write);
+
+  IndexToWrites::const_iterator it = p.segment->writes.find(index);
+  if (it != p.segment->writes.end())
+  {
+    const Writes& w = it->second;
+    Writes::const_iterator last =
+        std::upper_bound(w.begin(), w.end(), p.depth, beforeWrite);
+    if (last != w.begin())
+      return (last - 1)->second;
+  }
+
+  below = p.segment->base;
+  return ASTNode();
+}
+
+void WriteChainIndex::clear()
+{
+  positions.clear();
+  for (size_t i = 0; i < segments.size(); i++)
+    delete segments[i];
+  segments.clear();
+}
+
+} // end of namespace
@@ -182,19 +182,17 @@ Minisat::Var getEquals(SATSolver& SatSolver, const ASTNode& a, const ASTNode& b,
  *
  * SATBased_ArrayReadRefinement()
  *
- * What it really does is, for each array, loop over each index i.
- * inside that loop, it finds all the true and false axioms with i
- * as first index.  When it's got them all, it adds the false axioms
- * to the formula and re-solves, and returns if the result is
- * correct.  Otherwise, it goes on to the next index.
+ * Each round evaluates the index and the value of every read in the
+ * current model, and groups the reads of each array by the value of
+ * their index. A read whose value differs from the first read in its
+ * group violates the axiom (i=j) -> (A[i]=A[j]), so that axiom is
+ * added. Only violated axioms are added, and the same solver is then
+ * called again, until the model is good or the problem is unsat.
  *
- * If it gets through all the indices without a correct result
- * (which I think is impossible), it then solves with all the true
- * axioms, too.
- *
- * This is not the most obvious way to do it, and I don't know how
- * it compares with other approaches (e.g., one false axiom at a
- * time or all the false axioms each time).
+ * An axiom that has been added holds in every later model, so each
+ * round adds at least one new axiom and the loop terminates. If a
+ * model is bogus without violating any read axiom, all the axioms
+ * that haven't been added yet are added at once.
  *****************************************************************/
 struct AxiomToBe
 {
@@ -207,12 +205,14 @@ struct AxiomToBe
   }
   ASTNode index0, index1;
   ASTNode value0, value1;
+};
 
-  int numberOfConstants() const
-  {
-    return ((index0.isConstant() ? 1 : 0) + (index1.isConstant() ? 1 : 0) +
-            (index0.isConstant() ? 1 : 0) + (index1.isConstant() ? 1 : 0));
-  }
+// The reads of one array, in the order that axioms are made for them.
+struct ReadsOfArray
+{
+  ASTVec indexes;       // The index expressions.
+  ASTVec index_symbols; // Symbols constrained to equal the index expressions.
+  ASTVec symbols;       // The fresh symbol for each read.
 };
 
 void applyAxiomToSAT(SATSolver& SatSolver, AxiomToBe& toBe,
@@ -238,6 +238,15 @@ void applyAxiomsToSolver(ToSATBase::ASTNodeToSATVar& satVar,
   toBe.clear();
 }
 
+// Identifies the axiom between the i-th and j-th reads of an array, i < j.
+// Not by their symbols, because reads from constant arrays share them: the
+// "symbol" of such a read can be its constant value.
+uint64_t axiomKey(size_t i, size_t j)
+{
+  assert(i < j);
+  return ((uint64_t)i << 32) | (uint32_t)j;
+}
+
 bool sortBySize(const pair<ASTNode, ArrayTransformer::arrTypeMap>& a,
                 const pair<ASTNode, ArrayTransformer::arrTypeMap>& b)
 {
@@ -254,140 +263,151 @@ bool sortByIndexConstants(const pair<ASTNode, ArrayTransformer::ArrayRead>& a,
   return aCount > bCount;
 }
 
-bool sortbyConstants(const AxiomToBe& a, const AxiomToBe& b)
-{
-  return a.numberOfConstants() > b.numberOfConstants();
-}
-
 SOLVER_RETURN_TYPE
 AbsRefine_CounterExample::SATBased_ArrayReadRefinement(
     SATSolver& SatSolver, const ASTNode& inputAlreadyInSAT,
     const ASTNode& original_input, ToSATBase* tosat)
 {
-  vector<AxiomToBe> RemainingAxiomsVec;
-  vector<AxiomToBe> FalseAxiomsVec;
   // NB. Because we stop this timer before entering the SAT solver, the count
   // it produces isn't the number of times Array Read Refinement was entered.
   bm->GetRunTimes()->start(RunTimes::ArrayReadRefinement);
-  /// Check the arrays with the least indexes first.
 
+  /// Check the arrays with the least indexes first.
   vector<pair<ASTNode, ArrayTransformer::arrTypeMap>> arrayToIndex;
   arrayToIndex.insert(arrayToIndex.begin(),
                       ArrayTransform->arrayToIndexToRead.begin(),
                       ArrayTransform->arrayToIndexToRead.end());
   sort(arrayToIndex.begin(), arrayToIndex.end(), sortBySize);
 
-  // In these loops we try to construct Leibnitz axioms and add it to
-  // the solve(). We add only those axioms that are false in the
-  // current counterexample. we keep adding the axioms until there
-  // are no more axioms to add
-  //
-  // for each array, fetch its list of indices seen so far
-  for (vector<pair<ASTNode, ArrayTransformer::arrTypeMap>>::const_iterator
-           iset = arrayToIndex.begin(),
-           iset_end = arrayToIndex.end();
-       iset != iset_end; iset++)
+  vector<ReadsOfArray> arrays(arrayToIndex.size());
+  for (size_t a = 0; a < arrayToIndex.size(); a++)
   {
-    const map<ASTNode, ArrayTransformer::ArrayRead>& mapper = iset->second;
-
-    vector<ASTNode> listOfIndices;
-    listOfIndices.reserve(mapper.size());
-
-    // Make a vector of the read symbols.
-    ASTVec read_node_symbols;
-    read_node_symbols.reserve(listOfIndices.size());
-
-    vector<Kind> jKind;
-    jKind.reserve(mapper.size());
-
-    vector<ASTNode> concreteIndexes;
-    concreteIndexes.reserve(mapper.size());
-
-    vector<ASTNode> concreteValues;
-    concreteValues.reserve(mapper.size());
-
-    ASTVec index_symbols;
+    const map<ASTNode, ArrayTransformer::ArrayRead>& mapper =
+        arrayToIndex[a].second;
 
     vector<pair<ASTNode, ArrayTransformer::ArrayRead>> indexToRead;
     indexToRead.insert(indexToRead.begin(), mapper.begin(), mapper.end());
     sort(indexToRead.begin(), indexToRead.end(), sortByIndexConstants);
 
+    ReadsOfArray& reads = arrays[a];
+    reads.indexes.reserve(mapper.size());
+    reads.index_symbols.reserve(mapper.size());
+    reads.symbols.reserve(mapper.size());
+
     for (vector<pair<ASTNode, ArrayTransformer::ArrayRead>>::const_iterator it =
              indexToRead.begin();
          it != indexToRead.end(); it++)
     {
-      const ASTNode& the_index = it->first;
-      listOfIndices.push_back(the_index);
+      reads.indexes.push_back(it->first);
+      reads.index_symbols.push_back(it->second.index_symbol);
+      reads.symbols.push_back(it->second.symbol);
 
-      ASTNode arrsym = it->second.symbol;
-      read_node_symbols.push_back(arrsym);
+      assert(reads.symbols[0].GetValueWidth() ==
+             it->second.symbol.GetValueWidth());
+      assert(reads.indexes[0].GetValueWidth() == it->first.GetValueWidth());
+    }
+  }
 
-      index_symbols.push_back(it->second.index_symbol);
+  // The axioms of each array that are already in the solver.
+  vector<hash_set<uint64_t>> added(arrays.size());
 
-      assert(read_node_symbols[0].GetValueWidth() == arrsym.GetValueWidth());
-      assert(listOfIndices[0].GetValueWidth() == the_index.GetValueWidth());
+  // The first read of the current array whose index has a given value.
+  hash_map<ASTNode, size_t, ASTNode::ASTNodeHasher, ASTNode::ASTNodeEqual>
+      firstWithIndex;
 
-      jKind.push_back(the_index.GetKind());
+  vector<AxiomToBe> FalseAxiomsVec;
+  ASTVec concreteValues;
 
-      concreteIndexes.push_back(TermToConstTermUsingModel(the_index));
-      concreteValues.push_back(TermToConstTermUsingModel(arrsym));
+  while (true)
+  {
+    if (bm->checkTimeout())
+    {
+      bm->GetRunTimes()->stop(RunTimes::ArrayReadRefinement);
+      return SOLVER_TIMEOUT;
     }
 
-    assert(listOfIndices.size() == mapper.size());
+    for (size_t a = 0; a < arrays.size(); a++)
+    {
+      const ReadsOfArray& reads = arrays[a];
+      firstWithIndex.clear();
+      concreteValues.resize(reads.symbols.size());
 
-    // loop over the list of indices for the array and create LA,
-    // and add to inputAlreadyInSAT
-    for (size_t i = 0; i < listOfIndices.size(); i++)
+      for (size_t i = 0; i < reads.symbols.size(); i++)
+      {
+        const ASTNode concreteIndex =
+            TermToConstTermUsingModel(reads.indexes[i]);
+        concreteValues[i] = TermToConstTermUsingModel(reads.symbols[i]);
+
+        std::pair<hash_map<ASTNode, size_t, ASTNode::ASTNodeHasher,
+                           ASTNode::ASTNodeEqual>::iterator,
+                  bool> it =
+            firstWithIndex.insert(std::make_pair(concreteIndex, i));
+        if (it.second)
+          continue;
+
+        const size_t first = it.first->second;
+        if (concreteValues[first] == concreteValues[i])
+          continue;
+
+        if (!added[a].insert(axiomKey(first, i)).second)
+          continue;
+
+        FalseAxiomsVec.push_back(
+            AxiomToBe(reads.index_symbols[first], reads.index_symbols[i],
+                      reads.symbols[first], reads.symbols[i]));
+      }
+    }
+
+    if (FalseAxiomsVec.empty())
+      break;
+
+    bm->GetRunTimes()->addCounter("Array read axioms", FalseAxiomsVec.size());
+    bm->GetRunTimes()->addCounter("Array read refinement rounds");
+
+    ToSATBase::ASTNodeToSATVar& satVar = tosat->SATVar_to_SymbolIndexMap();
+    applyAxiomsToSolver(satVar, FalseAxiomsVec, SatSolver);
+
+    bm->GetRunTimes()->stop(RunTimes::ArrayReadRefinement);
+    SOLVER_RETURN_TYPE res2 =
+        CallSAT_ResultCheck(SatSolver, ASTTrue, original_input, tosat, true);
+
+    if (SOLVER_UNDECIDED != res2)
+      return res2;
+    bm->GetRunTimes()->start(RunTimes::ArrayReadRefinement);
+  }
+
+  // The model is bogus but no read axiom is false in it. Add the rest.
+  vector<AxiomToBe> RemainingAxiomsVec;
+  for (size_t a = 0; a < arrays.size(); a++)
+  {
+    const ReadsOfArray& reads = arrays[a];
+    for (size_t i = 0; i < reads.indexes.size(); i++)
     {
-      const ASTNode& index_i = listOfIndices[i];
-      const Kind iKind = index_i.GetKind();
+      const ASTNode& index_i = reads.indexes[i];
 
-      // Create all distinct pairs of indexes.
-      for (size_t j = i + 1; j < listOfIndices.size(); j++)
+      for (size_t j = i + 1; j < reads.indexes.size(); j++)
       {
-        const ASTNode& index_j = listOfIndices[j];
+        const ASTNode& index_j = reads.indexes[j];
 
         // If the index is a constant, and different, then there's no reason to
         // check.
-        // Sometimes we get the same index stored multiple times in the array.
-        // Not sure why...
-        if (BVCONST == iKind && jKind[j] == BVCONST && index_i != index_j)
+        if (BVCONST == index_i.GetKind() && BVCONST == index_j.GetKind() &&
+            index_i != index_j)
           continue;
 
         if (ASTFalse == simp->CreateSimplifiedEQ(index_i, index_j))
           continue; // shortcut.
 
-        AxiomToBe o(index_symbols[i], index_symbols[j], read_node_symbols[i],
-                    read_node_symbols[j]);
-
-        if (concreteIndexes[i] == concreteIndexes[j] &&
-            concreteValues[i] != concreteValues[j])
-        {
-          FalseAxiomsVec.push_back(o);
-          // ToSATBase::ASTNodeToSATVar	& satVar =
-          // tosat->SATVar_to_SymbolIndexMap();
-          // applyAxiomsToSolver(satVar, FalseAxiomsVec, SatSolver);
-        }
-        else
-          RemainingAxiomsVec.push_back(o);
-      }
-      if (FalseAxiomsVec.size() > 0)
-      {
-        ToSATBase::ASTNodeToSATVar& satVar = tosat->SATVar_to_SymbolIndexMap();
-        applyAxiomsToSolver(satVar, FalseAxiomsVec, SatSolver);
-
-        SOLVER_RETURN_TYPE res2;
-        bm->GetRunTimes()->stop(RunTimes::ArrayReadRefinement);
-        res2 = CallSAT_ResultCheck(SatSolver, ASTTrue, original_input, tosat,
-                                   true);
+        if (added[a].count(axiomKey(i, j)) > 0)
+          continue;
 
-        if (SOLVER_UNDECIDED != res2)
-          return res2;
-        bm->GetRunTimes()->start(RunTimes::ArrayReadRefinement);
+        RemainingAxiomsVec.push_back(
+            AxiomToBe(reads.index_symbols[i], reads.index_symbols[j],
+                      reads.symbols[i], reads.symbols[j]));
       }
     }
   }
-#if 1
+
   if (RemainingAxiomsVec.size() > 0)
   {
     if (bm->UserFlags.stats_flag)
@@ -395,53 +415,16 @@ AbsRefine_CounterExample::SATBased_ArrayReadRefinement(
       std::cout << "Adding all the remaining " << RemainingAxiomsVec.size()
                 << " read axioms " << std::endl;
     }
+    bm->GetRunTimes()->addCounter("Array read axioms",
+                                  RemainingAxiomsVec.size());
+    bm->GetRunTimes()->addCounter("Array read refinement rounds");
+
     ToSATBase::ASTNodeToSATVar& satVar = tosat->SATVar_to_SymbolIndexMap();
     applyAxiomsToSolver(satVar, RemainingAxiomsVec, SatSolver);
 
     bm->GetRunTimes()->stop(RunTimes::ArrayReadRefinement);
     return CallSAT_ResultCheck(SatSolver, ASTTrue, original_input, tosat, true);
   }
-// For difficult problems, I suspec this is a better way to do it.
-// However because it can cause an extra three SAT solver calls, it slows down
-// easy problems.
-#else
-  if (RemainingAxiomsVec.size() > 0)
-  {
-    // Add the axioms in order of how many constants there are in each.
-
-    ToSATBase::ASTNodeToSATVar& satVar = tosat->SATVar_to_SymbolIndexMap();
-    sort(RemainingAxiomsVec.begin(), RemainingAxiomsVec.end(), sortbyConstants);
-    int current_position = 0;
-    for (int n_const = 4; n_const >= 0; n_const--)
-    {
-      bool added = false;
-      while (current_position < RemainingAxiomsVec.size() &&
-             RemainingAxiomsVec[current_position].numberOfConstants() ==
-                 n_const)
-      {
-        AxiomToBe& toBe = RemainingAxiomsVec[current_position];
-        applyAxiomToSAT(SatSolver, toBe, satVar);
-        current_position++;
-        added = true;
-      }
-      if (!added)
-        continue;
-      bm->GetRunTimes()->stop(RunTimes::ArrayReadRefinement);
-      SOLVER_RETURN_TYPE res2;
-      res2 =
-          CallSAT_ResultCheck(SatSolver, ASTTrue, original_input, tosat, true);
-      if (SOLVER_UNDECIDED != res2)
-        return res2;
-
-      bm->GetRunTimes()->start(RunTimes::ArrayReadRefinement);
-    }
-    assert(current_position == RemainingAxiomsVec.size());
-    RemainingAxiomsVec.clear();
-    assert(SOLVER_UNDECIDED == CallSAT_ResultCheck(SatSolver, ASTTrue,
-                                                   original_input, tosat,
-                                                   true));
-  }
-#endif
 
   bm->GetRunTimes()->stop(RunTimes::ArrayReadRefinement);
   return SOLVER_UNDECIDED;
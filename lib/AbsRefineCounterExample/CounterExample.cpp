@@ -169,7 +169,8 @@ ASTNode AbsRefine_CounterExample::TermToConstTermUsingModel(const ASTNode& term,
   ASTNodeMap::const_iterator it1;
   if ((it1 = CounterExampleMap.find(term)) != CounterExampleMap.end())
   {
-    const ASTNode& val = it1->second;
+    // A copy, the recursion below adds to CounterExampleMap.
+    const ASTNode val = it1->second;
     if (BVCONST != val.GetKind())
     {
       // CounterExampleMap has two maps rolled into
@@ -274,8 +275,8 @@ ASTNode AbsRefine_CounterExample::TermToConstTermUsingModel(const ASTNode& term,
       {
         // index has a const value in the CounterExampleMap
         // ASTNode indexVal = CounterExampleMap[index];
-        ASTNode indexVal =
-            TermToConstTermUsingModel(CounterExampleMap[index], ArrayReadFlag);
+        const ASTNode mapped = CounterExampleMap[index];
+        ASTNode indexVal = TermToConstTermUsingModel(mapped, ArrayReadFlag);
         modelentry =
             bm->CreateTerm(READ, arrName.GetValueWidth(), arrName, indexVal);
       }
@@ -295,8 +296,8 @@ ASTNode AbsRefine_CounterExample::TermToConstTermUsingModel(const ASTNode& term,
       // if a value exists in the CounterExampleMap then return it
       if (CounterExampleMap.find(modelentry) != CounterExampleMap.end())
       {
-        output = TermToConstTermUsingModel(CounterExampleMap[modelentry],
-                                           ArrayReadFlag);
+        const ASTNode mapped = CounterExampleMap[modelentry];
+        output = TermToConstTermUsingModel(mapped, ArrayReadFlag);
       }
       else if (ArrayReadFlag)
       {
@@ -377,7 +378,8 @@ AbsRefine_CounterExample::Expand_ReadOverWrite_UsingModel(const ASTNode& term,
   ASTNodeMap::iterator it1;
   if ((it1 = CounterExampleMap.find(term)) != CounterExampleMap.end())
   {
-    const ASTNode& val = it1->second;
+    // A copy, the recursion below adds to CounterExampleMap.
+    const ASTNode val = it1->second;
     if (BVCONST != val.GetKind())
     {
       // recursion is fine here. There are two maps that are checked
@@ -647,12 +649,30 @@ ASTNode AbsRefine_CounterExample::GetCounterExample(bool t, const ASTNode& expr)
   ASTNodeMap::iterator it;
   ASTNode output;
   if ((it = CounterExampleMap.find(expr)) != CounterExampleMap.end())
-    output = TermToConstTermUsingModel(CounterExampleMap[expr], false);
+  {
+    const ASTNode mapped = it->second;
+    output = TermToConstTermUsingModel(mapped, false);
+  }
   else
     output = bm->CreateZeroConst(expr.GetValueWidth());
   return output;
 } 
 
+/* FUNCTION: evaluates 'expr', a formula or a bitvector term, under the
+ * counterexample. Unlike GetCounterExample(), compound terms are evaluated
+ * rather than looked up. Symbols that aren't in the model can take any
+ * value, and are given zero.
+ */
+ASTNode AbsRefine_CounterExample::EvaluateUsingModel(const ASTNode& expr)
+{
+  assert(expr.GetType() != ARRAY_TYPE);
+
+  if (BOOLEAN_TYPE == expr.GetType())
+    return ComputeFormulaUsingModel(expr);
+
+  return TermToConstTermUsingModel(expr, false);
+}
+
 // FUNCTION: queries the counterexample, and returns the number of array
 // locations for e
 std::vector<std::pair<ASTNode, ASTNode>>
@@ -34,15 +34,19 @@ THE SOFTWARE.
 
 namespace stp
 {
-enum inputStatus input_status = NOT_DECLARED;
+// These are per thread, so that each thread can parse and solve with its own
+// instance.
+thread_local enum inputStatus input_status = NOT_DECLARED;
 
 // Originally just used by the parser, now used elesewhere.
-STP* GlobalSTP;
-STPMgr* GlobalParserBM;
+thread_local STP* GlobalSTP;
+thread_local STPMgr* GlobalParserBM;
 
 // Used exclusively for parsing.
-Cpp_interface* GlobalParserInterface;
+thread_local Cpp_interface* GlobalParserInterface;
 
+// Shared by all the threads. It's expected to be registered once, before any
+// solving starts.
 // FIXME: This isn't in Globals.h so how can anyone use this?
 void (*vc_error_hdlr)(const char* err_msg) = 0;
 
@@ -56,14 +56,34 @@ typedef stp::BVSolver* bvsolverstar;
 typedef stp::AbsRefine_CounterExample* ctrexamplestar;
 typedef stp::ASTVec nodelist;
 typedef stp::CompleteCounterExample* CompleteCEStar;
-stp::ASTVec* decls = NULL;
-SimplifyingNodeFactory* simpNF = NULL;
 // vector<stp::ASTNode *> created_exprs;
 
-// persist holds a copy of ASTNodes so that the reference count of
-// objects we have pointers to doesn't hit zero.
-vector<stp::ASTNode*> persist;
-bool cinterface_exprdelete_on_flag = true;
+// What the C interface keeps for each validity checker. It lives with the
+// VC rather than in globals so that threads can each use their own VC.
+class CInterfaceSTP : public stp::STP
+{
+public:
+  CInterfaceSTP(bmstar b, simpstar s, bvsolverstar bsolv,
+                stp::ArrayTransformer* a, stp::ToSATBase* ts,
+                ctrexamplestar ce)
+      : stp::STP(b, s, bsolv, a, ts, ce), simpNF(NULL), exprdelete_on(true)
+  {
+  }
+
+  // Variables declared through the interface, for printing.
+  stp::ASTVec decls;
+  SimplifyingNodeFactory* simpNF;
+
+  // persist holds a copy of ASTNodes so that the reference count of
+  // objects we have pointers to doesn't hit zero.
+  vector<stp::ASTNode*> persist;
+  bool exprdelete_on;
+};
+
+static CInterfaceSTP* cinterface(VC vc)
+{
+  return static_cast<CInterfaceSTP*>((stpstar)vc);
+}
 
 // GLOBAL FUNCTION: parser
 extern int cvcparse(void*);
@@ -89,7 +109,7 @@ void vc_setInterfaceFlags(VC vc, enum ifaceflag_t f, int param_value)
   switch (f)
   {
     case EXPRDELETE:
-      cinterface_exprdelete_on_flag = param_value != 0;
+      cinterface(vc)->exprdelete_on = param_value != 0;
       break;
     case MS:
       b->UserFlags.solver_to_use = stp::UserDefinedFlags::MINISAT_SOLVER;
@@ -106,6 +126,25 @@ void vc_setInterfaceFlags(VC vc, enum ifaceflag_t f, int param_value)
       //Array-based Minisat has been replaced with normal MiniSat
       b->UserFlags.solver_to_use = stp::UserDefinedFlags::MINISAT_SOLVER;
       break;
+    case INCREMENTAL:
+      b->UserFlags.incremental_flag = param_value != 0;
+      break;
+    case PORTFOLIO:
+      if (param_value > 0)
+      {
+        b->UserFlags.solver_to_use = stp::UserDefinedFlags::PORTFOLIO_SOLVER;
+        b->UserFlags.portfolio_workers = param_value;
+      }
+      else
+        b->UserFlags.solver_to_use = stp::UserDefinedFlags::MINISAT_SOLVER;
+      break;
+    case ARRAY_ENCODING:
+      b->UserFlags.ackermannisation = param_value != 0;
+      b->UserFlags.sorted_ackermannisation = param_value == 2;
+      break;
+    case PROFILE:
+      b->GetRunTimes()->setProfiling(param_value != 0);
+      break;
     default:
       stp::FatalError(
           "C_interface: vc_setInterfaceFlags: Unrecognized flag\n");
@@ -139,17 +178,18 @@ VC vc_createValidityChecker(void)
       new stp::AbsRefine_CounterExample(bm, simp, arrayTransformer);
 
   stp::GlobalParserBM = bm;
-  stpstar stpObj =
-      new stp::STP(bm, simp, bvsolver, arrayTransformer, tosat, Ctr_Example);
+  CInterfaceSTP* stpObj =
+      new CInterfaceSTP(bm, simp, bvsolver, arrayTransformer, tosat,
+                        Ctr_Example);
 
-  simpNF = new SimplifyingNodeFactory(*(bm->hashingNodeFactory), *bm);
-  bm->defaultNodeFactory = simpNF;
+  stpObj->simpNF = new SimplifyingNodeFactory(*(bm->hashingNodeFactory), *bm);
+  bm->defaultNodeFactory = stpObj->simpNF;
 
   stp::GlobalSTP = stpObj;
-  decls = new stp::ASTVec();
   // created_exprs.clear();
-  vc_setFlags(stpObj, 'd');
-  return (VC)stpObj;
+  VC vc = (VC)(stpstar)stpObj;
+  vc_setFlags(vc, 'd');
+  return vc;
 }
 
 // Expr I/O
@@ -216,7 +256,8 @@ void vc_printExprFile(VC vc, Expr e, int fd)
 
 static void vc_printVarDeclsToStream(VC vc, ostream& os)
 {
-  for (stp::ASTVec::iterator i = decls->begin(), iend = decls->end();
+  stp::ASTVec& decls = cinterface(vc)->decls;
+  for (stp::ASTVec::iterator i = decls.begin(), iend = decls.end();
        i != iend; i++)
   {
     node a = *i;
@@ -250,7 +291,7 @@ void vc_printVarDecls(VC vc)
 
 void vc_clearDecls(VC vc)
 {
-  decls->clear();
+  cinterface(vc)->decls.clear();
 }
 
 static void vc_printAssertsToStream(VC vc, ostream& os, int simplify_print)
@@ -351,6 +392,30 @@ void vc_printCounterExampleToBuffer(VC vc, char** buf, unsigned long* len)
   memcpy(*buf, cstr, size);
 }
 
+void vc_printProfileToBuffer(VC vc, char** buf, unsigned long* len)
+{
+  assert(vc);
+  assert(buf);
+  assert(len);
+  bmstar b = (bmstar)(((stpstar)vc)->bm);
+
+  std::ostringstream os;
+  b->GetRunTimes()->printJSON(os);
+
+  // convert to a c buffer
+  string s = os.str();
+  const char* cstr = s.c_str();
+  unsigned long size = s.size() + 1; // number of chars + terminating null
+  *buf = (char*)malloc(size);
+  if (!(*buf))
+  {
+    fprintf(stderr, "malloc(%lu) failed.", size);
+    assert(*buf);
+  }
+  *len = size;
+  memcpy(*buf, cstr, size);
+}
+
 void vc_printExprToBuffer(VC vc, Expr e, char** buf, unsigned long* len)
 {
   stringstream os;
@@ -383,11 +448,11 @@ void vc_printQuery(VC vc)
   os << ");" << endl;
 }
 
-nodestar persistNode(node n)
+nodestar persistNode(VC vc, node n)
 {
   nodestar np = new node(n);
-  if (cinterface_exprdelete_on_flag)
-    persist.push_back(np);
+  if (cinterface(vc)->exprdelete_on)
+    cinterface(vc)->persist.push_back(np);
   return np;
 }
 
@@ -417,7 +482,7 @@ Type vc_arrayType(VC vc, Type typeIndex, Type typeData)
   }
   node output = b->CreateNode(stp::ARRAY, (*ti)[0], (*td)[0]);
 
-  return persistNode(output);
+  return persistNode(vc, output);
 }
 
 //! Create an expression for the value of array at the given index
@@ -510,7 +575,11 @@ int vc_query_with_timeout(VC vc, Expr e, int timeout_ms)
   const stp::ASTVec v = b->GetAsserts();
   node o;
   int output;
-  stpObj->bm->UserFlags.timeout_max_conflicts = timeout_ms;
+  stpObj->bm->UserFlags.timeout_max_time = timeout_ms;
+
+  // So that the profile is of this query only.
+  if (b->GetRunTimes()->isProfiling())
+    b->GetRunTimes()->clear();
   if (!v.empty())
   {
     if (v.size() == 1)
@@ -690,7 +759,7 @@ Expr vc_varExpr1(VC vc, const char* name, int indexwidth, int valuewidth)
   assert(BVTypeCheck(*output));
 
   // store the decls in a vector for printing purposes
-  decls->push_back(o);
+  cinterface(vc)->decls.push_back(o);
   return output;
 }
 
@@ -727,7 +796,7 @@ Expr vc_varExpr(VC vc, const char* name, Type type)
   assert(BVTypeCheck(*output));
 
   // store the decls in a vector for printing purposes
-  decls->push_back(o);
+  cinterface(vc)->decls.push_back(o);
   return output;
 }
 
@@ -753,7 +822,7 @@ Expr vc_boolType(VC vc)
   bmstar b = (bmstar)(((stpstar)vc)->bm);
 
   node output = b->CreateNode(stp::BOOLEAN);
-  return persistNode(output);
+  return persistNode(vc, output);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1004,7 +1073,7 @@ Type vc_bvType(VC vc, int num_bits)
 
   node e = b->CreateBVConst(32, num_bits);
   node output = (b->CreateNode(stp::BITVECTOR, e));
-  return persistNode(output);
+  return persistNode(vc, output);
 }
 
 Type vc_bv32Type(VC vc)
@@ -1049,7 +1118,7 @@ Expr vc_bvConstExprFromInt(VC vc, int n_bits, unsigned int value)
   }
   node n = b->CreateBVConst(n_bits, v);
   assert(BVTypeCheck(n));
-  return persistNode(n);
+  return persistNode(vc, n);
 }
 
 Expr vc_bvConstExprFromLL(VC vc, int n_bits, unsigned long long value)
@@ -1559,6 +1628,9 @@ unsigned long long int getBVUnsignedLongLong(Expr e)
     stp::FatalError("getBVUnsigned: Attempting to extract int value"
                      "from a NON-constant BITVECTOR: ",
                      *a);
+  if (a->GetValueWidth() <= 64)
+    return a->GetSmallBVConst();
+
   unsigned* bv = a->GetBVConst();
 
   char* str_bv = (char*)CONSTANTBV::BitVector_to_Bin(bv);
@@ -1708,6 +1780,7 @@ Expr vc_parseExpr(VC vc, const char* infile)
   stp::Cpp_interface pi(*b, b->defaultNodeFactory);
   stp::GlobalParserInterface = &pi;
 
+  std::lock_guard<std::mutex> lock(stp::globalParserMutex());
   stp::ASTVec* AssertsQuery = new stp::ASTVec;
   if (b->UserFlags.smtlib1_parser_flag)
   {
@@ -1841,8 +1914,10 @@ void vc_Destroy(VC vc)
   //     delete aaa;
   //   }
 
-  if (cinterface_exprdelete_on_flag)
+  CInterfaceSTP* stpObj = cinterface(vc);
+  if (stpObj->exprdelete_on)
   {
+    vector<nodestar>& persist = stpObj->persist;
     for (vector<nodestar>::iterator it = persist.begin(); it != persist.end();
          it++)
       delete *it;
@@ -1851,11 +1926,14 @@ void vc_Destroy(VC vc)
 
   Cnf_ClearMemory();
 
-  delete decls;
-  delete (stpstar) vc;
-  stp::GlobalSTP = NULL;
-  delete stp::GlobalParserBM;
-  stp::GlobalParserBM = NULL;
+  bmstar b = stpObj->bm;
+  SimplifyingNodeFactory* simpNF = stpObj->simpNF;
+  if (stp::GlobalSTP == stpObj)
+    stp::GlobalSTP = NULL;
+  if (stp::GlobalParserBM == b)
+    stp::GlobalParserBM = NULL;
+  delete stpObj;
+  delete b;
   delete simpNF;
 }
 
@@ -1971,6 +2049,7 @@ int vc_parseMemExpr(VC vc, const char* s, Expr* oquery, Expr* oasserts)
   stp::Cpp_interface pi(*b, b->defaultNodeFactory);
   stp::GlobalParserInterface = &pi;
 
+  std::lock_guard<std::mutex> lock(stp::globalParserMutex());
   stp::ASTVec AssertsQuery;
   if (b->UserFlags.smtlib1_parser_flag)
   {
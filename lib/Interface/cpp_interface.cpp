@@ -27,14 +27,61 @@ THE SOFTWARE.
 #include "stp/STPManager/STPManager.h"
 #include "stp/STPManager/STP.h"
 #include "stp/Parser/LetMgr.h"
+#include "stp/Printer/printers.h"
 #include <cassert>
 
 using std::cerr;
 using std::cout;
 using std::endl;
 
+extern int smt2lex_init(void** scanner);
+extern void smt2set_in(FILE* in, void* scanner);
+extern int smt2lex_destroy(void* scanner);
+extern int smt2parse(void* scanner);
+
 namespace stp
 {
+namespace
+{
+// Errors are thrown through the parser, so the scanner and the parser's
+// values are released here rather than after smt2parse() returns.
+class SMTLIB2Scanner
+{
+  Cpp_interface* parser;
+
+  SMTLIB2Scanner(const SMTLIB2Scanner&);
+  SMTLIB2Scanner& operator=(const SMTLIB2Scanner&);
+
+public:
+  void* scanner;
+
+  explicit SMTLIB2Scanner(FILE* in) : parser(GlobalParserInterface)
+  {
+    smt2lex_init(&scanner);
+    smt2set_in(in, scanner);
+    parser->startTrackingParserValues();
+  }
+
+  ~SMTLIB2Scanner()
+  {
+    parser->freeParserValues();
+    smt2lex_destroy(scanner);
+  }
+};
+}
+
+int parseSMTLIB2(FILE* in)
+{
+  SMTLIB2Scanner s(in);
+  return smt2parse(s.scanner);
+}
+
+std::mutex& globalParserMutex()
+{
+  static std::mutex m;
+  return m;
+}
+
 void Cpp_interface::checkInvariant()
 {
   assert(bm.getAssertLevel() == cache.size());
@@ -54,6 +101,14 @@ void Cpp_interface::init()
 
   print_success = false;
   ignoreCheckSatRequest = false;
+  modelAvailable = false;
+  lastResult = SOLVER_UNDECIDED;
+  parserValues = NULL;
+}
+
+bool Cpp_interface::isIncremental() const
+{
+  return bm.UserFlags.incremental_flag;
 }
 
 Cpp_interface::Cpp_interface(STPMgr& bm_, NodeFactory* factory)
@@ -89,6 +144,7 @@ UserDefinedFlags& Cpp_interface::getUserFlags()
 
 void Cpp_interface::AddAssert(const ASTNode& assert)
 {
+  modelAvailable = false;
   bm.AddAssert(assert);
 }
 
@@ -232,7 +288,7 @@ bool Cpp_interface::LookupSymbol(const char* const name, ASTNode& output)
 
 bool Cpp_interface::isSymbolAlreadyDeclared(char* name)
 {
-  return bm.LookupSymbol(name);
+  return isSymbolAlreadyDeclared(string(name));
 }
 
 void Cpp_interface::setPrintSuccess(bool ps)
@@ -242,7 +298,9 @@ void Cpp_interface::setPrintSuccess(bool ps)
 
 bool Cpp_interface::isSymbolAlreadyDeclared(string name)
 {
-  return bm.LookupSymbol(name.c_str());
+  ASTNode s;
+  return bm.LookupSymbol(name.c_str(), s) &&
+         poppedSymbols.find(s) == poppedSymbols.end();
 }
 
 ASTNode* Cpp_interface::newNode(const Kind k, const ASTNode& n0,
@@ -259,23 +317,105 @@ ASTNode* Cpp_interface::newNode(const Kind k, const int width,
 
 ASTNode* Cpp_interface::newNode(const ASTNode& copyIn)
 {
-  return new ASTNode(copyIn);
+  ASTNode* n = new ASTNode(copyIn);
+  if (parserValues != NULL)
+    parserValues->nodes.insert(n);
+  return n;
 }
 
 void Cpp_interface::deleteNode(ASTNode* n)
 {
+  if (parserValues != NULL)
+    parserValues->nodes.erase(n);
   delete n;
 }
 
+ASTVec* Cpp_interface::newVec()
+{
+  ASTVec* v = new ASTVec;
+  if (parserValues != NULL)
+    parserValues->vecs.insert(v);
+  return v;
+}
+
+void Cpp_interface::deleteVec(ASTVec* v)
+{
+  if (parserValues != NULL)
+    parserValues->vecs.erase(v);
+  delete v;
+}
+
+std::string* Cpp_interface::newString(const std::string& s)
+{
+  std::string* str = new std::string(s);
+  if (parserValues != NULL)
+    parserValues->strings.insert(str);
+  return str;
+}
+
+void Cpp_interface::deleteString(std::string* s)
+{
+  if (parserValues != NULL)
+    parserValues->strings.erase(s);
+  delete s;
+}
+
+void Cpp_interface::startTrackingParserValues()
+{
+  assert(parserValues == NULL);
+  parserValues = new ParserValues;
+}
+
+void Cpp_interface::freeParserValues()
+{
+  if (parserValues == NULL)
+    return;
+
+  ParserValues* values = parserValues;
+  parserValues = NULL;
+
+  for (std::set<ASTNode*>::iterator it = values->nodes.begin();
+       it != values->nodes.end(); it++)
+    delete *it;
+  for (std::set<ASTVec*>::iterator it = values->vecs.begin();
+       it != values->vecs.end(); it++)
+    delete *it;
+  for (std::set<std::string*>::iterator it = values->strings.begin();
+       it != values->strings.end(); it++)
+    delete *it;
+  delete values;
+}
+
 void Cpp_interface::addSymbol(ASTNode& s)
 {
   symbols.back().push_back(s);
   letMgr->_parser_symbol_table.insert(s);
 }
 
+ASTNode Cpp_interface::declareSymbol(const char* const name,
+                                     unsigned indexWidth, unsigned valueWidth)
+{
+  ASTNode s = bm.LookupOrCreateSymbol(name);
+  if (poppedSymbols.erase(s) > 0 &&
+      (s.GetIndexWidth() != indexWidth || s.GetValueWidth() != valueWidth))
+  {
+    // Symbols are unique by name, so this changes the sort of the node that
+    // was popped. The solver may still hold it, and what it derived from it,
+    // at the old sort.
+    modelAvailable = false;
+    GlobalSTP->ResetIncremental();
+    resetSolver();
+  }
+
+  s.SetIndexWidth(indexWidth);
+  s.SetValueWidth(valueWidth);
+  addSymbol(s);
+  return s;
+}
+
 void Cpp_interface::success()
 {
-  if (print_success)
+  if (print_success && bm.UserFlags.print_output_flag)
   {
     cout << "success" << endl;
     flush(cout);
@@ -284,6 +424,7 @@ void Cpp_interface::success()
 
 void Cpp_interface::resetSolver()
 {
+  modelAvailable = false;
   bm.ClearAllTables();
   GlobalSTP->ClearAllTables();
 }
@@ -308,13 +449,20 @@ void Cpp_interface::pop()
   bm.Pop();
 
   // These tables might hold references to symbols that have been
-  // removed.
-  resetSolver();
+  // removed. In an incremental session they're kept, the conjuncts of the
+  // popped level just aren't assumed in later queries.
+  if (isIncremental())
+    modelAvailable = false;
+  else
+    resetSolver();
 
   cache.erase(cache.end() - 1);
   ASTVec& current = symbols.back();
   for (size_t i = 0, size = current.size(); i < size; ++i)
+  {
     letMgr->_parser_symbol_table.erase(current[i]);
+    poppedSymbols.insert(current[i]);
+  }
 
   symbols.erase(symbols.end() - 1);
   checkInvariant();
@@ -330,6 +478,29 @@ void Cpp_interface::push()
 
   bm.Push();
   symbols.push_back(ASTVec());
+  modelAvailable = false;
+
+  checkInvariant();
+}
+
+void Cpp_interface::resetAssertions()
+{
+  while (symbols.size() > 1)
+    pop();
+
+  bm.Pop();
+  bm.Push();
+  cache.back() = Entry(SOLVER_UNDECIDED);
+
+  ASTVec& current = symbols.back();
+  for (size_t i = 0, size = current.size(); i < size; ++i)
+    letMgr->_parser_symbol_table.erase(current[i]);
+  current.clear();
+
+  if (isIncremental())
+    modelAvailable = false;
+  else
+    resetSolver();
 
   checkInvariant();
 }
@@ -348,6 +519,65 @@ void Cpp_interface::printStatus()
   cerr << endl;
 }
 
+// Solves the conjunction. In an incremental session the conjuncts are passed
+// to the solver separately, so that an assertion keeps its activation literal
+// (and everything derived from it) when other assertions are added.
+SOLVER_RETURN_TYPE Cpp_interface::solve(const ASTVec& conjuncts)
+{
+  ASTVec c;
+  if (isIncremental())
+    c = FlattenKind(AND, conjuncts);
+  else
+  {
+    resetSolver();
+    c = conjuncts;
+  }
+
+  ASTNode query;
+  if (c.size() > 1)
+    query = nf->CreateNode(AND, c);
+  else if (c.size() == 1)
+    query = c[0];
+  else
+    query = bm.ASTTrue;
+
+  SOLVER_RETURN_TYPE result = GlobalSTP->TopLevelSTP(query, bm.ASTFalse);
+  modelAvailable = (result == SOLVER_SATISFIABLE);
+  return result;
+}
+
+// It's satisfiable, so everything beneath it is satisfiable too.
+void Cpp_interface::markSatisfiable(const ASTVec& assertionsSMT2)
+{
+  Entry& last_run = cache.back();
+  last_run = Entry(SOLVER_SATISFIABLE);
+  last_run.node_number = assertionsSMT2.back().GetNodeNum();
+
+  for (size_t i = 0; i < cache.size(); i++)
+  {
+    assert(cache[i].result != SOLVER_UNSATISFIABLE);
+    cache[i].result = SOLVER_SATISFIABLE;
+  }
+}
+
+void Cpp_interface::printResult(SOLVER_RETURN_TYPE result)
+{
+  lastResult = result;
+
+  if (bm.GetRunTimes()->isProfiling())
+  {
+    bm.GetRunTimes()->printJSON(std::cerr);
+    bm.GetRunTimes()->clear();
+  }
+
+  if (bm.UserFlags.quick_statistics_flag)
+  {
+    bm.GetRunTimes()->print();
+  }
+
+  (GlobalSTP->tosat)->PrintOutput(result);
+}
+
 // Does some simple caching of prior results.
 void Cpp_interface::checkSat(const ASTVec& assertionsSMT2)
 {
@@ -368,48 +598,139 @@ void Cpp_interface::checkSat(const ASTVec& assertionsSMT2)
     last_run.result = SOLVER_UNDECIDED;
   }
 
+  // The model has gone if the solver was reset, or was used for a different
+  // query since.
+  if (last_run.result == SOLVER_SATISFIABLE && !modelAvailable)
+    last_run.result = SOLVER_UNDECIDED;
+
   // We might have run this query before, or it might already be shown to be
-  // unsat. If it was sat,
-  // we've stored the result (but not the model), so we can shortcut and return
-  // what we know.
+  // unsat. If it was sat, the model from that run is still held by the
+  // solver, so we can shortcut and return what we know.
   if (!((last_run.result == SOLVER_SATISFIABLE) ||
         last_run.result == SOLVER_UNSATISFIABLE))
   {
-    resetSolver();
+    SOLVER_RETURN_TYPE last_result = solve(assertionsSMT2);
 
-    ASTNode query;
-
-    if (assertionsSMT2.size() > 1)
-      query = nf->CreateNode(AND, assertionsSMT2);
-    else if (assertionsSMT2.size() == 1)
-      query = assertionsSMT2[0];
+    // Store away the answer. Might be timeout, or error though..
+    if (last_result == SOLVER_SATISFIABLE)
+      markSatisfiable(assertionsSMT2);
     else
-      query = bm.ASTTrue;
+    {
+      last_run = Entry(last_result);
+      last_run.node_number = assertionsSMT2.back().GetNodeNum();
+    }
+  }
 
-    SOLVER_RETURN_TYPE last_result = GlobalSTP->TopLevelSTP(query, bm.ASTFalse);
+  printResult(last_run.result);
+  bm.GetRunTimes()->start(RunTimes::Parsing);
+}
 
-    // Store away the answer. Might be timeout, or error though..
-    last_run = Entry(last_result);
-    last_run.node_number = assertionsSMT2.back().GetNodeNum();
+void Cpp_interface::checkSatAssuming(const ASTVec& assertionsSMT2,
+                                     const ASTVec& assumptions)
+{
+  if (ignoreCheckSatRequest)
+    return;
 
-    // It's satisfiable, so everything beneath it is satisfiable too.
-    if (last_result == SOLVER_SATISFIABLE)
+  bm.GetRunTimes()->stop(RunTimes::Parsing);
+
+  checkInvariant();
+  assert(assertionsSMT2.size() == cache.size());
+
+  SOLVER_RETURN_TYPE result;
+  if (cache.back().result == SOLVER_UNSATISFIABLE)
+  {
+    // Assuming more can't make it satisfiable.
+    result = SOLVER_UNSATISFIABLE;
+    modelAvailable = false;
+  }
+  else
+  {
+    ASTVec conjuncts(assertionsSMT2);
+    conjuncts.insert(conjuncts.end(), assumptions.begin(), assumptions.end());
+    result = solve(conjuncts);
+
+    // A model of the assertions and the assumptions is a model of the
+    // assertions too. Unsatisfiable might be due to the assumptions though.
+    if (result == SOLVER_SATISFIABLE)
+      markSatisfiable(assertionsSMT2);
+  }
+
+  printResult(result);
+  bm.GetRunTimes()->start(RunTimes::Parsing);
+}
+
+void Cpp_interface::getValue(const ASTVec& terms)
+{
+  // Output is off when several instances share cout, e.g. in batch mode.
+  if (!bm.UserFlags.print_output_flag)
+    return;
+
+  if (!modelAvailable)
+  {
+    cout << "(error \"get-value requires a satisfiable check-sat\")" << endl;
+    return;
+  }
+
+  // SMT-LIB 2.0 has no literal for array values. Checked before anything
+  // is printed, so the reply is either all the values or just the error.
+  for (size_t i = 0, size = terms.size(); i < size; ++i)
+    if (terms[i].GetType() == ARRAY_TYPE)
     {
-      for (size_t i = 0; i < cache.size(); i++)
-      {
-        assert(cache[i].result != SOLVER_UNSATISFIABLE);
-        cache[i].result = SOLVER_SATISFIABLE;
-      }
+      cout << "(error \"get-value: values of arrays can't be printed\")"
+           << endl;
+      return;
     }
+
+  cout << "(";
+  for (size_t i = 0, size = terms.size(); i < size; ++i)
+  {
+    const ASTNode& t = terms[i];
+    if (i > 0)
+      cout << endl << " ";
+    cout << "(";
+    printer::SMTLIB2_Print(cout, t);
+    cout << " ";
+    const ASTNode value = GlobalSTP->Ctr_Example->EvaluateUsingModel(t);
+    printer::SMTLIB2_Print(cout, value);
+    cout << ")";
   }
+  cout << ")" << endl;
+}
 
-  if (bm.UserFlags.quick_statistics_flag)
+void Cpp_interface::getModel()
+{
+  if (!bm.UserFlags.print_output_flag)
+    return;
+
+  if (!modelAvailable)
   {
-    bm.GetRunTimes()->print();
+    cout << "(error \"get-model requires a satisfiable check-sat\")" << endl;
+    return;
   }
 
-  (GlobalSTP->tosat)->PrintOutput(last_run.result);
-  bm.GetRunTimes()->start(RunTimes::Parsing);
+  cout << "(model" << endl;
+  for (size_t i = 0, size = symbols.size(); i < size; ++i)
+  {
+    const ASTVec& level = symbols[i];
+    for (size_t j = 0, jsize = level.size(); j < jsize; ++j)
+    {
+      const ASTNode& s = level[j];
+      // SMT-LIB 2.0 has no literal for array values.
+      if (s.GetType() == ARRAY_TYPE)
+        continue;
+
+      cout << "  (define-fun ";
+      printer::SMTLIB2_Print(cout, s);
+      if (s.GetType() == BOOLEAN_TYPE)
+        cout << " () Bool ";
+      else
+        cout << " () (_ BitVec " << s.GetValueWidth() << ") ";
+      const ASTNode value = GlobalSTP->Ctr_Example->GetCounterExample(true, s);
+      printer::SMTLIB2_Print(cout, value);
+      cout << ")" << endl;
+    }
+  }
+  cout << ")" << endl;
 }
 
 // This method sets up some of the globally required data.
@@ -441,5 +762,6 @@ void Cpp_interface::cleanUp()
   letMgr->cleanupParserSymbolTable();
   cache.clear();
   symbols.clear();
+  poppedSymbols.clear();
 }
 }
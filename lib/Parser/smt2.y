@@ -46,6 +46,7 @@
 
 #include "stp/cpp_interface.h"
 #include "stp/Parser/LetMgr.h"
+#include "stp/STPManager/UserDefinedFlags.h"
 
   using namespace stp;
   using std::cout;
@@ -56,13 +57,16 @@
   // compile error)
 #undef __GNUC_MINOR__
 
-  extern char* smt2text;
-  extern int smt2lineno;
-  extern int smt2lex(void);
+  // The scanner is reentrant, its state is passed around as "scanner".
+  extern int smt2get_lineno(void* scanner);
+  extern char* smt2get_text(void* scanner);
 
-  int yyerror(const char *s) {
-    cout << "syntax error: line " << smt2lineno << "\n" << s << endl;
-    cout << "  token: " << smt2text << endl;
+  int yyerror(void* scanner, const char *s) {
+    // Without output, e.g. in batch mode, the message goes to the error handler.
+    if (!GlobalParserInterface->getUserFlags().print_output_flag)
+      FatalError(s);
+    cout << "syntax error: line " << smt2get_lineno(scanner) << "\n" << s << endl;
+    cout << "  token: " << smt2get_text(scanner) << endl;
     FatalError("");
     return 1;
   }
@@ -83,6 +87,14 @@
   std::string *str;
 };
 
+%code {
+  extern int smt2lex(YYSTYPE* lvalp, void* scanner);
+}
+
+%define api.pure
+%lex-param {void* scanner}
+%parse-param {void* scanner}
+
 %start cmd
 
 %type <node> status
@@ -187,6 +199,10 @@
 %token FORMULA_TOK
 %token PUSH_TOK
 %token POP_TOK
+%token CHECK_SAT_ASSUMING_TOK
+%token GET_VALUE_TOK
+%token GET_MODEL_TOK
+%token RESET_ASSERTIONS_TOK
 
  /* Functions for QF_AUFBV. */
 %token SELECT_TOK;
@@ -218,20 +234,43 @@ cmdi:
     {
         GlobalParserInterface->checkSat(GlobalParserInterface->getAssertVector());
     }
+|    LPAREN_TOK CHECK_SAT_ASSUMING_TOK LPAREN_TOK an_formulas RPAREN_TOK RPAREN_TOK
+    {
+        GlobalParserInterface->checkSatAssuming(GlobalParserInterface->getAssertVector(), *$4);
+        GlobalParserInterface->deleteVec($4);
+    }
+|    LPAREN_TOK CHECK_SAT_ASSUMING_TOK LPAREN_TOK RPAREN_TOK RPAREN_TOK
+    {
+        GlobalParserInterface->checkSat(GlobalParserInterface->getAssertVector());
+    }
+|    LPAREN_TOK GET_VALUE_TOK LPAREN_TOK an_mixed RPAREN_TOK RPAREN_TOK
+    {
+        GlobalParserInterface->getValue(*$4);
+        GlobalParserInterface->deleteVec($4);
+    }
+|    LPAREN_TOK GET_MODEL_TOK RPAREN_TOK
+    {
+        GlobalParserInterface->getModel();
+    }
+|    LPAREN_TOK RESET_ASSERTIONS_TOK RPAREN_TOK
+    {
+        GlobalParserInterface->resetAssertions();
+        GlobalParserInterface->success();
+    }
 |
     LPAREN_TOK LOGIC_TOK STRING_TOK RPAREN_TOK
     {
       if (!(0 == strcmp($3->c_str(),"QF_BV") ||
             0 == strcmp($3->c_str(),"QF_ABV") ||
             0 == strcmp($3->c_str(),"QF_AUFBV"))) {
-        yyerror("Wrong input logic:");
+        yyerror(scanner, "Wrong input logic:");
       }
       GlobalParserInterface->success();
-      delete $3;
+      GlobalParserInterface->deleteString($3);
     }
 |    LPAREN_TOK NOTES_TOK attribute STRING_TOK RPAREN_TOK
     {
-    delete $4;
+    GlobalParserInterface->deleteString($4);
     }
 |    LPAREN_TOK OPTION_TOK attribute RPAREN_TOK
     {
@@ -274,26 +313,23 @@ cmdi:
 function_param:
 LPAREN_TOK STRING_TOK LPAREN_TOK UNDERSCORE_TOK BITVEC_TOK NUMERAL_TOK RPAREN_TOK RPAREN_TOK
 {
-  $$ = new ASTNode(GlobalParserInterface->LookupOrCreateSymbol($2->c_str()));
-  GlobalParserInterface->addSymbol(*$$);
-  $$->SetIndexWidth(0);
-  $$->SetValueWidth($6);
-  delete $2;
+  $$ = GlobalParserInterface->newNode(GlobalParserInterface->declareSymbol($2->c_str(), 0, $6));
+  GlobalParserInterface->deleteString($2);
 };
 
 /* Returns a vector of parameters.*/
 function_params:
 function_param
 {
-  $$ = new ASTVec;
+  $$ = GlobalParserInterface->newVec();
   $$->push_back(*$1);
-  delete $1;
+  GlobalParserInterface->deleteNode($1);
 }
 | function_params function_param
 {
   $$ = $1;
   $$->push_back(*$2);
-  delete $2;
+  GlobalParserInterface->deleteNode($2);
 };
 
 
@@ -304,7 +340,7 @@ STRING_TOK LPAREN_TOK function_params RPAREN_TOK LPAREN_TOK UNDERSCORE_TOK BITVE
   {
     char msg [100];
     sprintf(msg, "Different bit-widths specified: %d %d", $10->GetValueWidth(), $8);
-    yyerror(msg);
+    yyerror(scanner, msg);
   }
 
   GlobalParserInterface->storeFunction(*$1, *$3, *$10);
@@ -313,9 +349,9 @@ STRING_TOK LPAREN_TOK function_params RPAREN_TOK LPAREN_TOK UNDERSCORE_TOK BITVE
   for (size_t i = 0; i < $3->size(); i++)
     GlobalParserInterface->removeSymbol((*$3)[i]);
 
-  delete $1;
-  delete $3;
-  delete $10;
+  GlobalParserInterface->deleteString($1);
+  GlobalParserInterface->deleteVec($3);
+  GlobalParserInterface->deleteNode($10);
 }
 |
 STRING_TOK LPAREN_TOK function_params RPAREN_TOK BOOL_TOK an_formula 
@@ -326,9 +362,9 @@ STRING_TOK LPAREN_TOK function_params RPAREN_TOK BOOL_TOK an_formula
   for (size_t i = 0; i < $3->size(); i++)
    GlobalParserInterface->removeSymbol((*$3)[i]);
 
-  delete $1;
-  delete $3;
-  delete $6;
+  GlobalParserInterface->deleteString($1);
+  GlobalParserInterface->deleteVec($3);
+  GlobalParserInterface->deleteNode($6);
 }
 |
 STRING_TOK LPAREN_TOK RPAREN_TOK BOOL_TOK an_formula
@@ -336,8 +372,8 @@ STRING_TOK LPAREN_TOK RPAREN_TOK BOOL_TOK an_formula
   ASTVec empty;
   GlobalParserInterface->storeFunction(*$1, empty, *$5);
 
-  delete $1;
-  delete $5;
+  GlobalParserInterface->deleteString($1);
+  GlobalParserInterface->deleteNode($5);
 }
 |
 STRING_TOK LPAREN_TOK RPAREN_TOK LPAREN_TOK UNDERSCORE_TOK BITVEC_TOK NUMERAL_TOK RPAREN_TOK an_term 
@@ -346,14 +382,14 @@ STRING_TOK LPAREN_TOK RPAREN_TOK LPAREN_TOK UNDERSCORE_TOK BITVEC_TOK NUMERAL_TO
   {
     char msg [100];
     sprintf(msg, "Different bit-widths specified: %d %d", $9->GetValueWidth(), $7);
-    yyerror(msg);
+    yyerror(scanner, msg);
   }
 
   ASTVec empty;
   GlobalParserInterface->storeFunction(*$1,empty, *$9);
 
-  delete $1;
-  delete $9;
+  GlobalParserInterface->deleteString($1);
+  GlobalParserInterface->deleteNode($9);
 }
 ;
 
@@ -370,8 +406,8 @@ STRING_TOK {
   else if (0 == strcmp($1->c_str(), "unknown"))
       input_status = TO_BE_UNKNOWN;
   else 
-      yyerror($1->c_str());
-  delete $1;
+      yyerror(scanner, $1->c_str());
+  GlobalParserInterface->deleteString($1);
   $$ = NULL; 
 }
 ;
@@ -403,49 +439,30 @@ SOURCE_TOK
 var_decl:
 STRING_TOK LPAREN_TOK RPAREN_TOK LPAREN_TOK UNDERSCORE_TOK BITVEC_TOK NUMERAL_TOK RPAREN_TOK
 {
-  ASTNode s = GlobalParserInterface->LookupOrCreateSymbol($1->c_str());
-  GlobalParserInterface->addSymbol(s);
-  //Sort_symbs has the indexwidth/valuewidth. Set those fields in
-  //var
-  s.SetIndexWidth(0);
-  s.SetValueWidth($7);
-  delete $1;
+  GlobalParserInterface->declareSymbol($1->c_str(), 0, $7);
+  GlobalParserInterface->deleteString($1);
 }
 | STRING_TOK LPAREN_TOK RPAREN_TOK BOOL_TOK
 {
-  ASTNode s = GlobalParserInterface->LookupOrCreateSymbol($1->c_str());
-  s.SetIndexWidth(0);
-  s.SetValueWidth(0);
-  GlobalParserInterface->addSymbol(s);
-  delete $1;
+  GlobalParserInterface->declareSymbol($1->c_str(), 0, 0);
+  GlobalParserInterface->deleteString($1);
 }
 | STRING_TOK LPAREN_TOK RPAREN_TOK LPAREN_TOK ARRAY_TOK LPAREN_TOK UNDERSCORE_TOK BITVEC_TOK NUMERAL_TOK RPAREN_TOK LPAREN_TOK UNDERSCORE_TOK BITVEC_TOK NUMERAL_TOK RPAREN_TOK RPAREN_TOK
 {
-  ASTNode s = GlobalParserInterface->LookupOrCreateSymbol($1->c_str());
-  GlobalParserInterface->addSymbol(s);
   unsigned int index_len = $9;
   unsigned int value_len = $14;
-  if(index_len > 0) {
-    s.SetIndexWidth($9);
-  }
-  else {
-    FatalError("Fatal Error: parsing: BITVECTORS must be of positive length: \n");
-  }
-
-  if(value_len > 0) {
-    s.SetValueWidth($14);
-  }
-  else {
+  if (index_len == 0 || value_len == 0) {
     FatalError("Fatal Error: parsing: BITVECTORS must be of positive length: \n");
   }
-  delete $1;
+  GlobalParserInterface->declareSymbol($1->c_str(), index_len, value_len);
+  GlobalParserInterface->deleteString($1);
 }
 ;
 
 an_mixed:
 an_formula
 {
-  $$ = new ASTVec;
+  $$ = GlobalParserInterface->newVec();
   if ($1 != NULL) {
     $$->push_back(*$1);
     GlobalParserInterface->deleteNode($1);
@@ -454,7 +471,7 @@ an_formula
 |
 an_term
 {
-  $$ = new ASTVec;
+  $$ = GlobalParserInterface->newVec();
   if ($1 != NULL) {
     $$->push_back(*$1);
     GlobalParserInterface->deleteNode($1);
@@ -484,7 +501,7 @@ an_mixed an_term
 an_formulas:
 an_formula
 {
-  $$ = new ASTVec;
+  $$ = GlobalParserInterface->newVec();
   if ($1 != NULL) {
     $$->push_back(*$1);
     GlobalParserInterface->deleteNode($1);
@@ -551,7 +568,7 @@ TRUE_TOK
     GlobalParserInterface->newNode(forms[0]) :
     GlobalParserInterface->newNode(GlobalParserInterface->CreateNode(AND, forms));
 
-  delete $3;
+  GlobalParserInterface->deleteVec($3);
 }
 | LPAREN_TOK DISTINCT_TOK an_formulas RPAREN_TOK
 {
@@ -575,7 +592,7 @@ TRUE_TOK
     GlobalParserInterface->newNode(forms[0]) :
     GlobalParserInterface->newNode(GlobalParserInterface->CreateNode(AND, forms));
 
-  delete $3;
+  GlobalParserInterface->deleteVec($3);
 }
 | LPAREN_TOK BVSLT_TOK an_term an_term RPAREN_TOK
 {
@@ -658,12 +675,12 @@ TRUE_TOK
 | LPAREN_TOK AND_TOK an_formulas RPAREN_TOK
 {
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->CreateNode(AND, *$3));
-  delete $3;
+  GlobalParserInterface->deleteVec($3);
 }
 | LPAREN_TOK OR_TOK an_formulas RPAREN_TOK
 {
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->CreateNode(OR, *$3));
-  delete $3;
+  GlobalParserInterface->deleteVec($3);
 }
 | LPAREN_TOK XOR_TOK an_formula an_formula RPAREN_TOK
 {
@@ -686,14 +703,14 @@ TRUE_TOK
 | LPAREN_TOK BOOLEAN_FUNCTIONID_TOK an_mixed RPAREN_TOK
 {
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->applyFunction(*$2,*$3));
-  delete $2;
-  delete $3;
+  GlobalParserInterface->deleteString($2);
+  GlobalParserInterface->deleteVec($3);
 }
 | BOOLEAN_FUNCTIONID_TOK
 {
   ASTVec empty;
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->applyFunction(*$1,empty));
-  delete $1;
+  GlobalParserInterface->deleteString($1);
 }
 ;
 
@@ -712,7 +729,7 @@ let: LPAREN_TOK STRING_TOK an_formula RPAREN_TOK
   //2. Ensure that LET variables are not
   //2. defined more than once
   GlobalParserInterface->letMgr->LetExprMgr(*$2,*$3);
-  delete $2;
+  GlobalParserInterface->deleteString($2);
   GlobalParserInterface->deleteNode( $3);
 }
 | LPAREN_TOK STRING_TOK an_term RPAREN_TOK
@@ -726,7 +743,7 @@ let: LPAREN_TOK STRING_TOK an_formula RPAREN_TOK
   //2. Ensure that LET variables are not
   //2. defined more than once
   GlobalParserInterface->letMgr->LetExprMgr(*$2,*$3);
-  delete $2;
+  GlobalParserInterface->deleteString($2);
   GlobalParserInterface->deleteNode( $3);
 
 }
@@ -735,7 +752,7 @@ let: LPAREN_TOK STRING_TOK an_formula RPAREN_TOK
 an_terms: 
 an_term
 {
-  $$ = new ASTVec;
+  $$ = GlobalParserInterface->newVec();
   if ($1 != NULL) {
     $$->push_back(*$1);
     GlobalParserInterface->deleteNode( $1);
@@ -794,10 +811,10 @@ TERMID_TOK
 {
   int width = $4 - $5 + 1;
   if (width < 0)
-    yyerror("Negative width in extract");
+    yyerror(scanner, "Negative width in extract");
       
   if((unsigned)$4 >= $7->GetValueWidth())
-    yyerror("Parsing: Wrong width in BVEXTRACT\n");                      
+    yyerror(scanner, "Parsing: Wrong width in BVEXTRACT\n");                      
       
   ASTNode hi  =  GlobalParserInterface->CreateBVConst(32, $4);
   ASTNode low =  GlobalParserInterface->CreateBVConst(32, $5);
@@ -1085,31 +1102,31 @@ TERMID_TOK
 {
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->CreateBVConst(*$2, 10, $3));
   $$->SetValueWidth($3);
-  delete $2;
+  GlobalParserInterface->deleteString($2);
 }
 | BVCONST_HEXIDECIMAL_TOK
 {
   unsigned width = $1->length()*4;
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->CreateBVConst(*$1, 16, width));
   $$->SetValueWidth(width);
-  delete $1;
+  GlobalParserInterface->deleteString($1);
 }
 | BVCONST_BINARY_TOK
 {
   unsigned width = $1->length();
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->CreateBVConst(*$1, 2, width));
   $$->SetValueWidth(width);
-  delete $1;
+  GlobalParserInterface->deleteString($1);
 }
 | LPAREN_TOK BITVECTOR_FUNCTIONID_TOK an_mixed RPAREN_TOK
 {
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->applyFunction(*$2,*$3));
 
   if ($$->GetType() != BITVECTOR_TYPE)
-      yyerror("Must be bitvector type");
+      yyerror(scanner, "Must be bitvector type");
 
-  delete $2;
-  delete $3;
+  GlobalParserInterface->deleteString($2);
+  GlobalParserInterface->deleteVec($3);
 }
 | BITVECTOR_FUNCTIONID_TOK
 {
@@ -1117,9 +1134,9 @@ TERMID_TOK
   $$ = GlobalParserInterface->newNode(GlobalParserInterface->applyFunction(*$1,empty));
 
   if ($$->GetType() != BITVECTOR_TYPE)
-    yyerror("Must be bitvector type");
+    yyerror(scanner, "Must be bitvector type");
 
-  delete $1;
+  GlobalParserInterface->deleteString($1);
 }
 | LPAREN_TOK LET_TOK LPAREN_TOK lets RPAREN_TOK an_term RPAREN_TOK
 {
@@ -71,6 +71,16 @@ void SMTLIB2_PrintBack(ostream& os, const ASTNode& n, const bool definately_bv)
   // os << "(exit)\n";
 }
 
+// Without lets, and on one line, for answering get-value. SMTLIB_Print()
+// would end the line.
+void SMTLIB2_Print(ostream& os, const ASTNode& n)
+{
+  NodeLetVarMap.clear();
+  NodeLetVarVec.clear();
+  NodeLetVarMap1.clear();
+  SMTLIB2_Print1(os, n, 0, false);
+}
+
 void printVarDeclsToStream(ASTNodeSet& symbols, ostream& os)
 {
   for (ASTNodeSet::const_iterator i = symbols.begin(), iend = symbols.end();
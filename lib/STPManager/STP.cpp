@@ -34,6 +34,7 @@ THE SOFTWARE.
 
 #include "stp/Sat/SimplifyingMinisat.h"
 #include "stp/Sat/MinisatCore.h"
+#include "stp/Sat/PortfolioSolver.h"
 
 #include "stp/Simplifier/RemoveUnconstrained.h"
 #include "stp/Simplifier/FindPureLiterals.h"
@@ -94,6 +95,9 @@ SATSolver* STP::get_new_sat_solver()
     case UserDefinedFlags::MINISAT_SOLVER:
       newS = new MinisatCore;
       break;
+    case UserDefinedFlags::PORTFOLIO_SOLVER:
+      newS = new PortfolioSolver(bm->UserFlags.portfolio_workers);
+      break;
     default:
       std::cerr << "ERROR: Undefined solver to use." << endl;
       exit(-1);
@@ -103,6 +107,132 @@ SATSolver* STP::get_new_sat_solver()
   return newS;
 }
 
+STP::~STP()
+{
+  ClearAllTables();
+
+  delete persistentToSAT;
+  persistentToSAT = NULL;
+
+  delete persistentSolver;
+  persistentSolver = NULL;
+
+  delete Ctr_Example;
+  Ctr_Example = NULL;
+
+  delete arrayTransformer;
+  arrayTransformer = NULL;
+
+  delete tosat;
+  tosat = NULL;
+
+  delete simp;
+  simp = NULL;
+  // delete bm;
+}
+
+void STP::ResetIncremental()
+{
+  incrementalPreprocessed.clear();
+
+  delete persistentToSAT;
+  persistentToSAT = NULL;
+
+  delete persistentSolver;
+  persistentSolver = NULL;
+}
+
+bool STP::useIncremental() const
+{
+  return bm->UserFlags.incremental_flag &&
+         !bm->UserFlags.isSet("traditional-cnf", "0");
+}
+
+// The transformations applied here must give an equivalent formula, since the
+// result is kept and reused in later queries where other formulas are
+// asserted.
+ASTNode STP::preprocessIncremental(const ASTNode& conjunct)
+{
+  ASTNodeMap::const_iterator it = incrementalPreprocessed.find(conjunct);
+  if (it != incrementalPreprocessed.end())
+    return it->second;
+
+  ASTNode result = conjunct;
+  if (bm->UserFlags.optimize_flag)
+    result = simp->SimplifyFormula_TopLevel(result, false);
+
+  // Array reads are replaced by ITEs over fresh variables. Because the
+  // transformer's tables are kept, reads in later conjuncts are related to
+  // the reads that have been seen before. The sorted encoding needs all the
+  // reads up front, so it can't be used here.
+  bm->UserFlags.ackermannisation = true;
+  const bool sorted = bm->UserFlags.sorted_ackermannisation;
+  bm->UserFlags.sorted_ackermannisation = false;
+  result = arrayTransformer->TransformFormula_TopLevel(result);
+  bm->UserFlags.sorted_ackermannisation = sorted;
+
+  incrementalPreprocessed.insert(std::make_pair(conjunct, result));
+  return result;
+}
+
+SOLVER_RETURN_TYPE STP::TopLevelSTPIncremental(const ASTNode& inputasserts,
+                                               const ASTNode& query,
+                                               const ASTNode& original_input)
+{
+  if (persistentSolver == NULL)
+  {
+    persistentSolver = get_new_sat_solver();
+    if (bm->UserFlags.stats_flag)
+      persistentSolver->setVerbosity(1);
+
+    if (bm->UserFlags.random_seed_flag)
+      persistentSolver->setSeed(bm->UserFlags.random_seed);
+
+    persistentToSAT = new ToSATAIG(bm, arrayTransformer, true);
+  }
+  persistentSolver->setMaxConflicts(bm->UserFlags.timeout_max_conflicts);
+
+  ASTVec conjuncts;
+  if (inputasserts.GetKind() == AND)
+    conjuncts = inputasserts.GetChildren();
+  else
+    conjuncts.push_back(inputasserts);
+
+  if (query != bm->ASTFalse)
+    conjuncts.push_back(bm->CreateNode(NOT, query));
+
+  ASTVec processed;
+  processed.reserve(conjuncts.size());
+  for (ASTVec::const_iterator it = conjuncts.begin(); it != conjuncts.end();
+       it++)
+  {
+    if (bm->checkTimeout())
+      return SOLVER_TIMEOUT;
+
+    processed.push_back(preprocessIncremental(*it));
+  }
+
+  const ASTNode inputToSat =
+      (processed.size() == 1)
+          ? processed[0]
+          : bm->hashingNodeFactory->CreateNode(AND, processed);
+
+  if (bm->GetRunTimes()->isProfiling())
+    simp->recordCacheStatus();
+
+  SOLVER_RETURN_TYPE res = Ctr_Example->CallSAT_ResultCheck(
+      *persistentSolver, inputToSat, original_input, persistentToSAT, false);
+
+  if (SOLVER_UNDECIDED == res)
+    FatalError("TopLevelSTPIncremental: the model returned by the SAT solver"
+               " doesn't satisfy the input");
+
+  if (SOLVER_TIMEOUT != res)
+    CountersAndStats("print_func_stats", bm);
+
+  return res;
+}
+
 // The absolute TopLevel function that invokes STP on the input
 // formula
 SOLVER_RETURN_TYPE STP::TopLevelSTP(
@@ -114,6 +244,8 @@ SOLVER_RETURN_TYPE STP::TopLevelSTP(
   // overwrite sometimes.
   bool saved_ack = bm->UserFlags.ackermannisation;
 
+  bm->startTimeout(bm->UserFlags.timeout_max_time);
+
   ASTNode original_input;
   if (query != bm->ASTFalse)
   {
@@ -123,6 +255,14 @@ SOLVER_RETURN_TYPE STP::TopLevelSTP(
     original_input = inputasserts;
   }
 
+  if (useIncremental())
+  {
+    SOLVER_RETURN_TYPE result =
+        TopLevelSTPIncremental(inputasserts, query, original_input);
+    bm->UserFlags.ackermannisation = saved_ack;
+    return result;
+  }
+
   SATSolver* newS = get_new_sat_solver();
   SOLVER_RETURN_TYPE result = solve_by_sat_solver(newS, original_input);
   delete newS;
@@ -131,20 +271,39 @@ SOLVER_RETURN_TYPE STP::TopLevelSTP(
   return result;
 }
 
+STP::SizeReducingState::SizeReducingState(STPMgr& bm)
+    : intervals(new EstablishIntervals(bm))
+{
+}
+
+STP::SizeReducingState::~SizeReducingState()
+{
+  delete intervals;
+}
+
 ASTNode STP::callSizeReducing(ASTNode inputToSat,
                               BVSolver* bvSolver, PropagateEqualities* pe,
+                              SizeReducingState& state,
                               const int initial_difficulty_score,
                               int& actualBBSize)
 {
-  while (true)
+  // Big problems only get a few rounds, the early rounds remove the most.
+  int rounds = -1;
+  if (initial_difficulty_score >= 1000000 &&
+      !bm->UserFlags.isSet("preserving-fixedpoint", "0"))
+    rounds = 3;
+
+  while (rounds-- != 0)
   {
     ASTNode last = inputToSat;
-    inputToSat = sizeReducing(last, bvSolver, pe);
-    if (last == inputToSat)
+    inputToSat = sizeReducing(last, bvSolver, pe, state);
+    if (last == inputToSat || bm->soft_timeout_expired)
       break;
   }
 
   actualBBSize = -1;
+  if (bm->soft_timeout_expired)
+    return inputToSat;
 
   // Expensive, so only want to do it once.
   if (bm->UserFlags.isSet("bitblast-simplification", "1") &&
@@ -157,6 +316,11 @@ ASTNode STP::callSizeReducing(ASTNode inputToSat,
     ASTNodeMap equivs;
     bb.getConsts(inputToSat, fromTo, equivs);
 
+    // The bit-blaster gives up part way through when time runs out, so what
+    // it found can't be trusted.
+    if (bm->soft_timeout_expired)
+      return inputToSat;
+
     if (equivs.size() > 0)
     {
       /* These nodes have equivalent AIG representations, so even though they
@@ -188,9 +352,15 @@ ASTNode STP::callSizeReducing(ASTNode inputToSat,
 }
 
 // These transformations should never increase the size of the DAG.
+// Passes that are skipped because they left the same input unchanged before
+// would have left it unchanged again, so the last round of a fixed point
+// only runs the passes that follow a change.
 ASTNode STP::sizeReducing(ASTNode inputToSat,
-                          BVSolver* bvSolver, PropagateEqualities* pe)
+                          BVSolver* bvSolver, PropagateEqualities* pe,
+                          SizeReducingState& state)
 {
+  if (bm->checkTimeout())
+    return inputToSat;
 
   inputToSat = pe->topLevel(inputToSat, arrayTransformer);
   if (simp->hasUnappliedSubstitutions())
@@ -200,23 +370,35 @@ ASTNode STP::sizeReducing(ASTNode inputToSat,
     bm->ASTNodeStats(pe_message.c_str(), inputToSat);
   }
 
-  if (bm->UserFlags.isSet("enable-unconstrained", "1"))
+  if (bm->UserFlags.isSet("enable-unconstrained", "1") &&
+      inputToSat != state.unconstrainedDone)
   {
     // Remove unconstrained.
+    const ASTNode before = inputToSat;
     RemoveUnconstrained r1(*bm);
     inputToSat = r1.topLevel(inputToSat, simp);
+    if (inputToSat == before)
+      state.unconstrainedDone = before;
     bm->ASTNodeStats(uc_message.c_str(), inputToSat);
   }
 
-  if (bm->UserFlags.isSet("use-intervals", "1"))
+  if (bm->UserFlags.isSet("use-intervals", "1") &&
+      inputToSat != state.intervalsDone)
   {
-    EstablishIntervals intervals(*bm);
-    inputToSat = intervals.topLevel_unsignedIntervals(inputToSat);
+    const ASTNode before = inputToSat;
+    inputToSat = state.intervals->topLevel_unsignedIntervals(inputToSat);
+    if (inputToSat == before)
+      state.intervalsDone = before;
     bm->ASTNodeStats(int_message.c_str(), inputToSat);
   }
 
-  if (bm->UserFlags.bitConstantProp_flag)
+  if (bm->checkTimeout())
+    return inputToSat;
+
+  if (bm->UserFlags.bitConstantProp_flag &&
+      inputToSat != state.bitPropagationDone)
   {
+    const ASTNode before = inputToSat;
     bm->GetRunTimes()->start(RunTimes::ConstantBitPropagation);
     simplifier::constantBitP::ConstantBitPropagation cb(
         simp, bm->defaultNodeFactory, inputToSat);
@@ -233,11 +415,14 @@ ASTNode STP::sizeReducing(ASTNode inputToSat,
       simp->haveAppliedSubstitutionMap();
     }
 
+    if (inputToSat == before)
+      state.bitPropagationDone = before;
     bm->ASTNodeStats(cb_message.c_str(), inputToSat);
   }
 
   // Find pure literals.
-  if (bm->UserFlags.isSet("pure-literals", "1"))
+  if (bm->UserFlags.isSet("pure-literals", "1") &&
+      inputToSat != state.pureLiteralsDone)
   {
     FindPureLiterals fpl;
     bool changed = fpl.topLevel(inputToSat, simp, bm);
@@ -247,12 +432,18 @@ ASTNode STP::sizeReducing(ASTNode inputToSat,
       simp->haveAppliedSubstitutionMap();
       bm->ASTNodeStats(pl_message.c_str(), inputToSat);
     }
+    else
+      state.pureLiteralsDone = inputToSat;
   }
 
-  if (bm->UserFlags.isSet("always-true", "0"))
+  if (bm->UserFlags.isSet("always-true", "0") &&
+      inputToSat != state.alwaysTrueDone)
   {
+    const ASTNode before = inputToSat;
     AlwaysTrue always(simp, bm, bm->defaultNodeFactory);
     inputToSat = always.topLevel(inputToSat);
+    if (inputToSat == before)
+      state.alwaysTrueDone = before;
     bm->ASTNodeStats("After removing always true: ", inputToSat);
   }
 
@@ -282,6 +473,8 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
   std::auto_ptr<PropagateEqualities> pe(
       new PropagateEqualities(simp, bm->defaultNodeFactory, bm));
 
+  SizeReducingState sizeReducingState(*bm);
+
   ASTNode inputToSat = original_input;
 
   // If the number of array reads is small. We rewrite them through.
@@ -314,18 +507,23 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
   }
 
   // Run size reducing just once.
-  inputToSat = sizeReducing(inputToSat, bvSolver.get(), pe.get());
+  inputToSat =
+      sizeReducing(inputToSat, bvSolver.get(), pe.get(), sizeReducingState);
+  if (bm->checkTimeout())
+    return SOLVER_TIMEOUT;
+
   unsigned initial_difficulty_score = difficulty.score(inputToSat);
   int bitblasted_difficulty = -1;
 
-  // Fixed point it if it's not too difficult.
-  // Currently we discards all the state each time sizeReducing is called,
-  // so it's expensive to call.
-  if ((!arrayops && initial_difficulty_score < 1000000) ||
-      bm->UserFlags.isSet("preserving-fixedpoint", "0"))
+  // Fixed point it. The intervals and the passes that had nothing to do are
+  // kept between calls, so later rounds are cheaper than the first.
+  if (!arrayops || bm->UserFlags.isSet("preserving-fixedpoint", "0"))
   {
     inputToSat = callSizeReducing(inputToSat, bvSolver.get(), pe.get(),
-                         initial_difficulty_score, bitblasted_difficulty);
+                                  sizeReducingState, initial_difficulty_score,
+                                  bitblasted_difficulty);
+    if (bm->checkTimeout())
+      return SOLVER_TIMEOUT;
   }
 
   if ((!arrayops || bm->UserFlags.isSet("array-difficulty-reversion", "1")))
@@ -366,7 +564,7 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
   {
     tmp_inputToSAT = inputToSat;
 
-    if (bm->soft_timeout_expired)
+    if (bm->checkTimeout())
       return SOLVER_TIMEOUT;
 
     if (bm->UserFlags.optimize_flag)
@@ -400,26 +598,35 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
     }
   } while (tmp_inputToSAT != inputToSat);
 
-  if (bm->UserFlags.bitConstantProp_flag)
+  // Constant bits and intervals each find things that help the other, so
+  // alternate them for a few rounds while the intervals change the problem.
+  for (int round = 0; round < 3; round++)
   {
-    bm->GetRunTimes()->start(RunTimes::ConstantBitPropagation);
-    simplifier::constantBitP::ConstantBitPropagation cb(
-        simp, bm->defaultNodeFactory, inputToSat);
-    inputToSat = cb.topLevelBothWays(inputToSat);
-    bm->GetRunTimes()->stop(RunTimes::ConstantBitPropagation);
+    if (bm->UserFlags.bitConstantProp_flag)
+    {
+      bm->GetRunTimes()->start(RunTimes::ConstantBitPropagation);
+      simplifier::constantBitP::ConstantBitPropagation cb(
+          simp, bm->defaultNodeFactory, inputToSat);
+      inputToSat = cb.topLevelBothWays(inputToSat);
+      bm->GetRunTimes()->stop(RunTimes::ConstantBitPropagation);
+
+      if (cb.isUnsatisfiable()) {
+        inputToSat = bm->ASTFalse;
+      }
 
-    if (cb.isUnsatisfiable()) {
-      inputToSat = bm->ASTFalse;
+      bm->ASTNodeStats(cb_message.c_str(), inputToSat);
     }
 
-    bm->ASTNodeStats(cb_message.c_str(), inputToSat);
-  }
+    if (!bm->UserFlags.isSet("use-intervals", "1"))
+      break;
 
-  if (bm->UserFlags.isSet("use-intervals", "1"))
-  {
-    EstablishIntervals intervals(*bm);
-    inputToSat = intervals.topLevel_unsignedIntervals(inputToSat);
+    const ASTNode beforeIntervals = inputToSat;
+    inputToSat =
+        sizeReducingState.intervals->topLevel_unsignedIntervals(inputToSat);
     bm->ASTNodeStats(int_message.c_str(), inputToSat);
+
+    if (inputToSat == beforeIntervals || !bm->UserFlags.bitConstantProp_flag)
+      break;
   }
 
   // Find pure literals.
@@ -435,7 +642,7 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
     }
   }
 
-  if (bm->soft_timeout_expired)
+  if (bm->checkTimeout())
     return SOLVER_TIMEOUT;
 
   // Simplify using Ite context
@@ -474,25 +681,53 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
   if (final_difficulty_score > 1.1 * initial_difficulty_score)
     worse = true;
 
-  // It's of course very wasteful to do this! Later I'll make it reuse the
-  // work..We bit-blast again, in order to throw it away, so that we can
-  // measure whether the number of AIG nodes is smaller. The difficulty score
-  // is sometimes completelywrong, the sage-app7 are the motivating examples.
-  // The other way to improve it would be to fix the difficulty scorer!
+  // We bit-blast, so that we can measure whether the number of AIG nodes is
+  // smaller. The difficulty score is sometimes completelywrong, the sage-app7
+  // are the motivating examples. The other way to improve it would be to fix
+  // the difficulty scorer! It's bit-blasted the way ToSATAIG would, with the
+  // constant bit propagator ToSATAIG is then given, so that if the problem is
+  // kept ToSATAIG can use it rather than bit-blasting it again. With
+  // propagation on, bitblasted_difficulty was measured before any constant
+  // bits were fixed, so the comparison leans towards keeping the problem.
+  std::auto_ptr<BBNodeManagerAIG> bitblasted;
+  std::auto_ptr<simplifier::constantBitP::ConstantBitPropagation> bitblastedCB;
+  ASTNode bitblastedInput;
+  BBNodeAIG bitblastedRoot;
   if (!worse && (bitblasted_difficulty != -1))
   {
-    BBNodeManagerAIG bitblast_nodemgr;
-    BitBlaster<BBNodeAIG, BBNodeManagerAIG> bb(
-        &bitblast_nodemgr, simp, bm->defaultNodeFactory, &(bm->UserFlags));
-    bb.BBForm(inputToSat);
-    int newBB = bitblast_nodemgr.totalNumberOfNodes();
-    if (bm->UserFlags.stats_flag)
-      cerr << "Final BB Size:" << newBB << endl;
+    if (bm->UserFlags.bitConstantProp_flag)
+    {
+      bm->GetRunTimes()->start(RunTimes::ConstantBitPropagation);
+      bitblastedCB.reset(new simplifier::constantBitP::ConstantBitPropagation(
+          simp, bm->defaultNodeFactory, inputToSat));
+      bm->GetRunTimes()->stop(RunTimes::ConstantBitPropagation);
+    }
 
-    if (bitblasted_difficulty < newBB)
-      worse = true;
+    // There's nothing to measure if the propagator has found a conflict.
+    if (bitblastedCB.get() == NULL || !bitblastedCB->isUnsatisfiable())
+    {
+      Simplifier bbSimp(bm);
+      bitblasted.reset(new BBNodeManagerAIG());
+      BitBlaster<BBNodeAIG, BBNodeManagerAIG> bb(
+          bitblasted.get(), &bbSimp, bm->defaultNodeFactory, &(bm->UserFlags),
+          bitblastedCB.get());
+      bm->GetRunTimes()->start(RunTimes::BitBlasting);
+      bitblastedRoot = bb.BBForm(inputToSat);
+      bm->GetRunTimes()->stop(RunTimes::BitBlasting);
+
+      int newBB = bitblasted->totalNumberOfNodes();
+      if (bm->UserFlags.stats_flag)
+        cerr << "Final BB Size:" << newBB << endl;
+
+      if (bitblasted_difficulty < newBB)
+        worse = true;
+    }
+    bitblastedInput = inputToSat;
   }
 
+  if (bm->checkTimeout())
+    return SOLVER_TIMEOUT;
+
   if (bm->UserFlags.stats_flag)
   {
     cerr << "Initial Difficulty Score:" << initial_difficulty_score << endl;
@@ -537,6 +772,12 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
   bm->ASTNodeStats("after transformation: ", inputToSat);
   bm->TermsAlreadySeenMap_Clear();
 
+  if (bitblastedInput != inputToSat)
+  {
+    bitblasted.reset(NULL);
+    bitblastedCB.reset(NULL);
+  }
+
   bm->UserFlags.optimize_flag = optimize_enabled;
 
   SOLVER_RETURN_TYPE res;
@@ -545,6 +786,9 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
     bm->counterexample_checking_during_refinement = true;
   }
 
+  if (bm->GetRunTimes()->isProfiling())
+    simp->recordCacheStatus();
+
   // We are about to solve. Clear out all the memory associated with caches
   // that we won't need again.
   simp->ClearCaches();
@@ -566,8 +810,11 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
   if (bm->UserFlags.bitConstantProp_flag)
   {
     bm->GetRunTimes()->start(RunTimes::ConstantBitPropagation);
-    cb = new simplifier::constantBitP::ConstantBitPropagation(
-        simp, bm->defaultNodeFactory, inputToSat);
+    if (bitblastedCB.get() != NULL)
+      cb = bitblastedCB.release();
+    else
+      cb = new simplifier::constantBitP::ConstantBitPropagation(
+          simp, bm->defaultNodeFactory, inputToSat);
     cleaner.reset(cb);
     bm->GetRunTimes()->stop(RunTimes::ConstantBitPropagation);
 
@@ -578,10 +825,12 @@ STP::TopLevelSTPAux(SATSolver& NewSolver, const ASTNode& original_input)
   }
 
   ToSATAIG toSATAIG(bm, cb, arrayTransformer);
+  if (bitblasted.get() != NULL)
+    toSATAIG.useBitBlasted(inputToSat, bitblasted.release(), bitblastedRoot);
   ToSATBase* satBase =
       bm->UserFlags.isSet("traditional-cnf", "0") ? tosat : &toSATAIG;
 
-  if (bm->soft_timeout_expired)
+  if (bm->checkTimeout())
     return SOLVER_TIMEOUT;
 
   // If it doesn't contain array operations, use ABC's CNF generation.
@@ -24,6 +24,7 @@ THE SOFTWARE.
 
 // to get the PRIu64 macro from inttypes, this needs to be defined.
 #include <inttypes.h>
+#include <algorithm>
 #include <cmath>
 #include "stp/STPManager/STPManager.h"
 #include "stp/Printer/SMTLIBPrinter.h"
@@ -34,63 +35,64 @@ namespace stp
 using std::cout;
 using std::endl;
 
-ASTInterior* STPMgr::LookupOrCreateInterior(ASTInterior* n_ptr)
+ASTInterior* STPMgr::LookupOrCreateInterior(Kind kind, const ASTVec& children,
+                                            bool sortChildren)
 {
-  ASTInteriorSet::iterator it = _interior_unique_table.find(n_ptr);
-  if (it == _interior_unique_table.end())
+  // check for undefined nodes.
+  ASTVec::const_iterator it_end = children.end();
+  for (ASTVec::const_iterator it = children.begin(); it != it_end; it++)
   {
-    // Make a new ASTInterior node We want (NOT alpha) always to
-    // have alpha.nodenum + 1.
-    if (n_ptr->GetKind() == NOT)
-    {
-      // The internal node can't be a NOT, because then we'd add
-      // 1 to the NOT's node number, meaning we'd hit an even number,
-      // which could duplicate the next newNodeNum().
-      assert(n_ptr->GetChildren()[0].GetKind() != NOT);
-      n_ptr->SetNodeNum(n_ptr->GetChildren()[0].GetNodeNum() + 1);
-    }
-    else
+    if (it->IsNull())
     {
-      n_ptr->SetNodeNum(NewNodeNum());
+      FatalError("LookupOrCreateInterior:"
+                 "Undefined childnode in LookupOrCreateInterior: ",
+                 ASTUndefined);
     }
-
-    std::pair<ASTInteriorSet::const_iterator, bool> p =
-        _interior_unique_table.insert(n_ptr);
-    return *(p.first);
   }
 
-  // Delete the temporary node, and return the found node.
-  delete n_ptr;
-  return *it;
-}
-
-ASTInterior* STPMgr::CreateInteriorNode(Kind kind,
-                                        // children array of this
-                                        // node will be modified.
-                                        ASTInterior* n_ptr,
-                                        const ASTVec& back_children)
-{
+  // Most lookups find an existing node, so hash and compare the children
+  // where they are, rather than building a node that is immediately deleted.
+  // Only children that need sorting are copied.
+  const ASTVec* key_children = &children;
+  if (sortChildren &&
+      !std::is_sorted(children.begin(), children.end(), arithless))
+  {
+    _sorted_children.assign(children.begin(), children.end());
+    SortByArith(_sorted_children);
+    key_children = &_sorted_children;
+  }
 
-  // insert back_children at end of front_children
-  ASTVec& front_children = n_ptr->_children;
-  front_children.reserve(front_children.size() + back_children.size());
+  const ASTInterior::Key key(kind, *key_children);
+  const unsigned hash = ASTInterior::ASTInteriorHasher()(key);
+  ASTInterior* found = _interior_unique_table.find(key, hash);
+  if (found != NULL)
+  {
+    _sorted_children.clear();
+    return found;
+  }
 
-  front_children.insert(front_children.end(), back_children.begin(),
-                        back_children.end());
+  ASTInterior* n_ptr =
+      new (_interior_pool.allocate()) ASTInterior(kind, *key_children, this);
+  _sorted_children.clear();
+  n_ptr->SetHash(hash);
 
-  // check for undefined nodes.
-  ASTVec::const_iterator it_end = front_children.end();
-  for (ASTVec::const_iterator it = front_children.begin(); it != it_end; it++)
+  // Make a new ASTInterior node We want (NOT alpha) always to
+  // have alpha.nodenum + 1.
+  if (n_ptr->GetKind() == NOT)
   {
-    if (it->IsNull())
-    {
-      FatalError("CreateInteriorNode:"
-                 "Undefined childnode in CreateInteriorNode: ",
-                 ASTUndefined);
-    }
+    // The internal node can't be a NOT, because then we'd add
+    // 1 to the NOT's node number, meaning we'd hit an even number,
+    // which could duplicate the next newNodeNum().
+    assert(n_ptr->GetChildren()[0].GetKind() != NOT);
+    n_ptr->SetNodeNum(n_ptr->GetChildren()[0].GetNodeNum() + 1);
+  }
+  else
+  {
+    n_ptr->SetNodeNum(NewNodeNum());
   }
 
-  return LookupOrCreateInterior(n_ptr);
+  _interior_unique_table.insert(n_ptr);
+  return n_ptr;
 }
 
 ostream& operator<<(ostream& os, const ASTNodeMap& nmap)
@@ -132,24 +134,26 @@ ASTSymbol* STPMgr::LookupOrCreateSymbol(ASTSymbol& s)
   // return s_ptr;
   // Do an explicit lookup to see if we need to create a copy of the
   // string.
-  ASTSymbolSet::const_iterator it = _symbol_unique_table.find(s_ptr);
-  if (it == _symbol_unique_table.end())
+  const unsigned hash = ASTSymbol::ASTSymbolHasher()(s_ptr);
+  ASTSymbol* found = _symbol_unique_table.find(s_ptr, hash);
+  if (found == NULL)
   {
     // Make a new ASTSymbol with duplicated string (can't assign
     // _name because it's const).  Can cast the iterator to
     // non-const -- carefully.
     // std::string strname(s_ptr->GetName());
-    ASTSymbol* s_ptr1 = new ASTSymbol(strdup(s_ptr->GetName()));
+    ASTSymbol* s_ptr1 = new (_symbol_pool.allocate())
+        ASTSymbol(strdup(s_ptr->GetName()), this);
     s_ptr1->SetNodeNum(NewNodeNum());
     s_ptr1->_value_width = s_ptr->_value_width;
-    std::pair<ASTSymbolSet::const_iterator, bool> p =
-        _symbol_unique_table.insert(s_ptr1);
-    return *p.first;
+    s_ptr1->SetHash(hash);
+    _symbol_unique_table.insert(s_ptr1);
+    return s_ptr1;
   }
   else
   {
     // return symbol found in table.
-    return *it;
+    return found;
   }
 } 
 
@@ -157,10 +161,8 @@ bool STPMgr::LookupSymbol(ASTSymbol& s)
 {
   ASTSymbol* s_ptr = &s; // it's a temporary key.
 
-  if (_symbol_unique_table.find(s_ptr) == _symbol_unique_table.end())
-    return false;
-  else
-    return true;
+  return _symbol_unique_table.find(
+             s_ptr, ASTSymbol::ASTSymbolHasher()(s_ptr)) != NULL;
 }
 
 bool STPMgr::LookupSymbol(const char* const name)
@@ -168,19 +170,18 @@ bool STPMgr::LookupSymbol(const char* const name)
   ASTSymbol s(name);
   ASTSymbol* s_ptr = &s; // it's a temporary key.
 
-  if (_symbol_unique_table.find(s_ptr) == _symbol_unique_table.end())
-    return false;
-  else
-    return true;
+  return _symbol_unique_table.find(
+             s_ptr, ASTSymbol::ASTSymbolHasher()(s_ptr)) != NULL;
 }
 
 bool STPMgr::LookupSymbol(const char* const name, ASTNode& output)
 {
   ASTSymbol temp_sym(name);
-  ASTSymbolSet::const_iterator it = _symbol_unique_table.find(&temp_sym);
-  if (it != _symbol_unique_table.end())
+  ASTSymbol* found = _symbol_unique_table.find(
+      &temp_sym, ASTSymbol::ASTSymbolHasher()(&temp_sym));
+  if (found != NULL)
   {
-    output = ASTNode(*it);
+    output = ASTNode(found);
     return true;
   }
   return false;
@@ -196,44 +197,8 @@ ASTNode STPMgr::CreateBVConst(unsigned int width,
                "unsigned long long of width: ",
                ASTUndefined, width);
 
-  // We create a single bvconst that gets reused.
-  if (NULL == CreateBVConstVal)
-    CreateBVConstVal = CONSTANTBV::BitVector_Create(65, true);
-  CreateBVConstVal = CONSTANTBV::BitVector_Resize(CreateBVConstVal, width);
-  CONSTANTBV::BitVector_Empty(CreateBVConstVal);
-
-  unsigned long c_val = (~((unsigned long)0)) & bvconst;
-  unsigned int copied = 0;
-
-  // sizeof(unsigned long) returns the number of bytes in unsigned
-  // long. In order to convert it to bits, we need to shift left by
-  // 3. Hence, sizeof(unsigned long)*8
-
-  // The algo below works as follows: It starts by copying the
-  // lower-order bits of the input "bvconst" in chunks of size =
-  // number of bits in unsigned long. The variable "copied" keeps
-  // track of the number of chunks copied so far
-
-  const int shift_amount = sizeof(unsigned long) * 8;
-  while (copied + shift_amount < width)
-  {
-    CONSTANTBV::BitVector_Chunk_Store(CreateBVConstVal, shift_amount, copied,
-                                      c_val);
-    if (shift_amount < (sizeof(bvconst) * 8))
-    {
-      bvconst >>= shift_amount;
-    }
-    else
-    {
-      bvconst = 0;
-    }
-    c_val = (~((unsigned long)0)) & bvconst;
-    copied += shift_amount;
-  }
-  CONSTANTBV::BitVector_Chunk_Store(CreateBVConstVal, width - copied, copied,
-                                    c_val);
-
-  ASTBVConst temp_bvconst(CreateBVConstVal, width, true);
+  // Constants this narrow are stored inline, so no CBV is needed.
+  ASTBVConst temp_bvconst(width, (uint64_t)bvconst);
   return ASTNode(LookupOrCreateBVConst(temp_bvconst));
 }
 
@@ -399,22 +364,22 @@ ASTBVConst* STPMgr::LookupOrCreateBVConst(ASTBVConst& s)
   ASTBVConst* s_ptr = &s; // it's a temporary key.
 
   // Do an explicit lookup to see if we need to create a copy of the string.
-  ASTBVConstSet::const_iterator it;
-  if ((it = _bvconst_unique_table.find(s_ptr)) == _bvconst_unique_table.end())
+  const unsigned hash = ASTBVConst::ASTBVConstHasher()(s_ptr);
+  ASTBVConst* found = _bvconst_unique_table.find(s_ptr, hash);
+  if (found == NULL)
   {
     // Make a new ASTBVConst with duplicated constant.
 
-    ASTBVConst* s_copy = new ASTBVConst(s);
+    ASTBVConst* s_copy = new (_bvconst_pool.allocate()) ASTBVConst(s, this);
     s_copy->SetNodeNum(NewNodeNum());
-
-    std::pair<ASTBVConstSet::const_iterator, bool> p =
-        _bvconst_unique_table.insert(s_copy);
-    return *p.first;
+    s_copy->SetHash(hash);
+    _bvconst_unique_table.insert(s_copy);
+    return s_copy;
   }
   else
   {
     // return constant found in table.
-    return *it;
+    return found;
   }
 }
 
@@ -537,6 +502,23 @@ const ASTVec STPMgr::GetAsserts(void)
 // prints statistics for the ASTNode
 void STPMgr::ASTNodeStats(const char* c, const ASTNode& a)
 {
+  const bool profiling = GetRunTimes()->isProfiling();
+  if (!UserFlags.stats_flag && !profiling)
+    return;
+
+  const unsigned int size = NodeSize(a);
+
+  if (profiling)
+  {
+    // The messages are written for printing, e.g. "After Pure Literals. ".
+    string stage(c);
+    while (!stage.empty() && (stage[stage.size() - 1] == ' ' ||
+                              stage[stage.size() - 1] == '.' ||
+                              stage[stage.size() - 1] == ':'))
+      stage.erase(stage.size() - 1);
+    GetRunTimes()->addNodeCount(stage, size);
+  }
+
   if (!UserFlags.stats_flag)
     return;
 
@@ -544,7 +526,7 @@ void STPMgr::ASTNodeStats(const char* c, const ASTNode& a)
   if (UserFlags.print_nodes_flag)
     cout << a << endl;
 
-  cout << "Node size is: " << NodeSize(a) << endl;
+  cout << "Node size is: " << size << endl;
 }
 
 unsigned int STPMgr::NodeSize(const ASTNode& a)
@@ -625,6 +607,32 @@ ASTNode STPMgr::NewParameterized_BooleanVar(const ASTNode& var,
 } 
 
 // If ASTNode remain with references (somewhere), this will segfault.
+bool STPMgr::Recycle()
+{
+  ClearAllTables();
+
+  printer::NodeLetVarMap.clear();
+  printer::NodeLetVarVec.clear();
+  printer::NodeLetVarMap1.clear();
+
+  while (!_asserts.empty())
+    Pop();
+  _current_query = ASTUndefined;
+
+  Introduced_SymbolsSet.clear();
+  ValidFlag = false;
+  bvdiv_exception_occured = false;
+  counterexample_checking_during_refinement = false;
+  soft_timeout_expired = false;
+  timeout_deadline = -1;
+  runTimes->clear();
+
+  // A symbol left over from the last problem would keep its width. Node
+  // numbers are never reused, and some tables are still keyed by them, so
+  // a manager is only recycled while its numbers stay small.
+  return _symbol_unique_table.size() == 0 && _max_node_num < MaxRecycledNodeNum;
+}
+
 STPMgr::~STPMgr()
 {
   ClearAllTables();
@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include "cryptominisat4/cryptominisat.h"
 #include <vector>
+#include <limits>
 using std::vector;
 
 namespace stp
@@ -55,6 +56,8 @@ void CryptoMinisat4::setMaxConflicts(int64_t max_confl)
 {
   if (max_confl> 0)
     s->set_max_confl(max_confl);
+  else if (max_confl < 0)
+    s->set_max_confl(std::numeric_limits<int64_t>::max());
 }
 
 bool
@@ -73,6 +76,23 @@ CryptoMinisat4::addClause(const vec_literals& ps) // Add a clause to the solver.
   return s->add_clause(real_temp_cl);
 }
 
+// Converts straight from the packed literals, without going through a
+// vec_literals first.
+bool CryptoMinisat4::addClauses(const int* lits, const int* begins, int n)
+{
+  vector<CMSat::Lit>& real_temp_cl = *(vector<CMSat::Lit>*)temp_cl;
+  for (int i = 0; i < n; i++)
+  {
+    real_temp_cl.clear();
+    for (int j = begins[i]; j < begins[i + 1]; j++)
+      real_temp_cl.push_back(CMSat::Lit(lits[j] >> 1, lits[j] & 1));
+
+    if (!s->add_clause(real_temp_cl))
+      return false;
+  }
+  return true;
+}
+
 bool
 CryptoMinisat4::okay() const // FALSE means solver is in a conflicting state
 {
@@ -88,6 +108,29 @@ bool CryptoMinisat4::solve(bool& timeout_expired) // Search without assumptions.
   return ret == CMSat::l_True;
 }
 
+// CryptoMiniSat drops the request when the next search starts, so there's
+// nothing for clearInterrupt() to do.
+void CryptoMinisat4::interrupt()
+{
+  s->interrupt_asap();
+}
+
+bool CryptoMinisat4::solveWithAssumptions(bool& timeout_expired,
+                                          const vec_literals& assumptions)
+{
+  vector<CMSat::Lit> assumps;
+  for (int i = 0; i < assumptions.size(); i++)
+  {
+    assumps.push_back(CMSat::Lit(var(assumptions[i]), sign(assumptions[i])));
+  }
+
+  CMSat::lbool ret = s->solve(&assumps);
+  if (ret == CMSat::l_Undef) {
+    timeout_expired = true;
+  }
+  return ret == CMSat::l_True;
+}
+
 uint8_t CryptoMinisat4::modelValue(uint32_t x) const
 {
   return (s->get_model().at(x) == CMSat::l_True);
@@ -53,7 +53,10 @@ MinisatCore::~MinisatCore()
 
 void MinisatCore::setMaxConflicts(int64_t max_confl)
 {
-  s->setConfBudget(max_confl);
+  if (max_confl < 0)
+    s->budgetOff();
+  else
+    s->setConfBudget(max_confl);
 }
 
 
@@ -83,6 +86,30 @@ bool MinisatCore::solve(bool& timeout_expired) // Search without assumptions.
   return ret == (Minisat::lbool)l_True;
 }
 
+void MinisatCore::interrupt()
+{
+  s->interrupt();
+}
+
+void MinisatCore::clearInterrupt()
+{
+  s->clearInterrupt();
+}
+
+bool MinisatCore::solveWithAssumptions(bool& timeout_expired,
+                                       const vec_literals& assumptions)
+{
+  if (!s->simplify())
+    return false;
+
+  Minisat::lbool ret = s->solveLimited(assumptions);
+  if (ret == (Minisat::lbool)l_Undef) {
+    timeout_expired = true;
+  }
+
+  return ret == (Minisat::lbool)l_True;
+}
+
 uint8_t MinisatCore::modelValue(uint32_t x) const
 {
   return Minisat::toInt(s->modelValue(x));
@@ -103,6 +130,18 @@ void MinisatCore::setSeed(int i)
   s->random_seed = i;
 }
 
+void MinisatCore::setDiversity(int k)
+{
+  if (k == 0)
+    return;
+
+  // Alternate between Luby and geometric restarts, and make some decisions
+  // at random so that the seed matters.
+  s->luby_restart = (k % 2 == 0);
+  s->random_var_freq = 0.02;
+  s->random_seed = k;
+}
+
 unsigned long MinisatCore::nVars() const
 {
   return s->nVars();
@@ -113,6 +152,21 @@ void MinisatCore::printStats() const
   //s->printStats();
 }
 
+uint64_t MinisatCore::nConflicts() const
+{
+  return s->conflicts;
+}
+
+uint64_t MinisatCore::nDecisions() const
+{
+  return s->decisions;
+}
+
+uint64_t MinisatCore::nPropagations() const
+{
+  return s->propagations;
+}
+
 int MinisatCore::nClauses()
 {
   return s->nClauses();
@@ -0,0 +1,260 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+#include "stp/Sat/PortfolioSolver.h"
+#include "stp/Sat/MinisatCore.h"
+#include "stp/Sat/SimplifyingMinisat.h"
+#ifdef USE_CRYPTOMINISAT4
+#include "stp/Sat/CryptoMinisat4.h"
+#endif
+#include <cassert>
+#include <thread>
+
+namespace stp
+{
+
+PortfolioSolver::PortfolioSolver(int number_of_workers)
+    : winner(-1), winner_result(false), interrupted(false)
+{
+  assert(number_of_workers > 0);
+
+#ifdef USE_CRYPTOMINISAT4
+  const int backends = 3;
+#else
+  const int backends = 2;
+#endif
+
+  for (int i = 0; i < number_of_workers; i++)
+  {
+    Worker w;
+    w.diversity = i / backends;
+    w.seedable = true;
+    switch (i % backends)
+    {
+      case 0:
+        w.solver = new MinisatCore;
+        break;
+      case 1:
+        w.solver = new SimplifyingMinisat;
+        break;
+#ifdef USE_CRYPTOMINISAT4
+      case 2:
+        w.solver = new CryptoMinisat4;
+        w.seedable = false;
+        break;
+#endif
+    }
+    w.solver->setDiversity(w.diversity);
+    workers.push_back(w);
+  }
+}
+
+PortfolioSolver::~PortfolioSolver()
+{
+  for (size_t i = 0; i < workers.size(); i++)
+    delete workers[i].solver;
+}
+
+bool PortfolioSolver::addClause(const vec_literals& ps)
+{
+  bool ok = true;
+  for (size_t i = 0; i < workers.size(); i++)
+    ok = workers[i].solver->addClause(ps) && ok;
+  return ok;
+}
+
+bool PortfolioSolver::okay() const
+{
+  for (size_t i = 0; i < workers.size(); i++)
+    if (!workers[i].solver->okay())
+      return false;
+  return true;
+}
+
+void PortfolioSolver::run(size_t i, const vec_literals* assumptions)
+{
+  SATSolver* s = workers[i].solver;
+  bool timeout = false;
+  bool result = (assumptions == NULL) ? s->solve(timeout)
+                                      : s->solveWithAssumptions(timeout,
+                                                                *assumptions);
+
+  std::lock_guard<std::mutex> l(lock);
+  if (timeout || winner != -1)
+    return;
+
+  winner = i;
+  winner_result = result;
+  for (size_t j = 0; j < workers.size(); j++)
+    if (j != i)
+      workers[j].solver->interrupt();
+}
+
+bool PortfolioSolver::search(bool& timeout_expired,
+                             const vec_literals* assumptions)
+{
+  winner = -1;
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < workers.size(); i++)
+    threads.push_back(std::thread(&PortfolioSolver::run, this, i, assumptions));
+  run(0, assumptions);
+  for (size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+
+  if (winner == -1)
+  {
+    timeout_expired = true;
+    return false;
+  }
+
+  // The losers were stopped by us, not by a time limit, so they should be
+  // free to search next time. An interrupt from outside is left for whoever
+  // sent it to clear.
+  if (!interrupted)
+    for (size_t i = 0; i < workers.size(); i++)
+      if ((int)i != winner)
+        workers[i].solver->clearInterrupt();
+
+  return winner_result;
+}
+
+bool PortfolioSolver::solve(bool& timeout_expired)
+{
+  return search(timeout_expired, NULL);
+}
+
+bool PortfolioSolver::solveWithAssumptions(bool& timeout_expired,
+                                           const vec_literals& assumptions)
+{
+  return search(timeout_expired, &assumptions);
+}
+
+void PortfolioSolver::interrupt()
+{
+  interrupted = true;
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].solver->interrupt();
+}
+
+void PortfolioSolver::clearInterrupt()
+{
+  interrupted = false;
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].solver->clearInterrupt();
+}
+
+void PortfolioSolver::setMaxConflicts(int64_t max_confl)
+{
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].solver->setMaxConflicts(max_confl);
+}
+
+bool PortfolioSolver::simplify()
+{
+  bool ok = true;
+  for (size_t i = 0; i < workers.size(); i++)
+    ok = workers[i].solver->simplify() && ok;
+  return ok;
+}
+
+// The backends don't agree on how to encode true and false.
+uint8_t PortfolioSolver::modelValue(uint32_t x) const
+{
+  assert(winner != -1);
+  SATSolver* s = workers[winner].solver;
+  const uint8_t v = s->modelValue(x);
+  if (v == s->true_literal())
+    return ((uint8_t)0);
+  if (v == s->false_literal())
+    return ((uint8_t)1);
+  return ((uint8_t)2);
+}
+
+uint32_t PortfolioSolver::newVar()
+{
+  const uint32_t v = workers[0].solver->newVar();
+  for (size_t i = 1; i < workers.size(); i++)
+  {
+    const uint32_t w = workers[i].solver->newVar();
+    assert(w == v);
+    (void)w;
+  }
+  return v;
+}
+
+void PortfolioSolver::setVerbosity(int v)
+{
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].solver->setVerbosity(v);
+}
+
+unsigned long PortfolioSolver::nVars() const
+{
+  return workers[0].solver->nVars();
+}
+
+void PortfolioSolver::printStats() const
+{
+  if (winner != -1)
+    std::cout << "Portfolio worker " << winner << " of " << workers.size()
+              << " answered" << std::endl;
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].solver->printStats();
+}
+
+// The statistics are summed over the workers, since they all search.
+uint64_t PortfolioSolver::nConflicts() const
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < workers.size(); i++)
+    result += workers[i].solver->nConflicts();
+  return result;
+}
+
+uint64_t PortfolioSolver::nDecisions() const
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < workers.size(); i++)
+    result += workers[i].solver->nDecisions();
+  return result;
+}
+
+uint64_t PortfolioSolver::nPropagations() const
+{
+  uint64_t result = 0;
+  for (size_t i = 0; i < workers.size(); i++)
+    result += workers[i].solver->nPropagations();
+  return result;
+}
+
+void PortfolioSolver::setSeed(int i)
+{
+  for (size_t j = 0; j < workers.size(); j++)
+    if (workers[j].seedable)
+      workers[j].solver->setSeed(i + workers[j].diversity);
+}
+
+void PortfolioSolver::setFrozen(uint32_t x)
+{
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].solver->setFrozen(x);
+}
+}
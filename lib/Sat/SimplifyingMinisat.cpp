@@ -49,6 +49,8 @@ void SimplifyingMinisat::setMaxConflicts(int64_t max_confl)
 {
   if (max_confl> 0)
     s->setConfBudget(max_confl);
+  else if (max_confl < 0)
+    s->budgetOff();
 }
 
 bool SimplifyingMinisat::addClause(
@@ -77,6 +79,30 @@ bool SimplifyingMinisat::solve(bool& timeout_expired) // Search without assumpti
   return s->okay();
 }
 
+void SimplifyingMinisat::interrupt()
+{
+  s->interrupt();
+}
+
+void SimplifyingMinisat::clearInterrupt()
+{
+  s->clearInterrupt();
+}
+
+bool SimplifyingMinisat::solveWithAssumptions(bool& timeout_expired,
+                                              const vec_literals& assumptions)
+{
+  if (!s->simplify())
+    return false;
+
+  Minisat::lbool ret = s->solveLimited(assumptions);
+  if (ret == (Minisat::lbool)l_Undef) {
+    timeout_expired = true;
+  }
+
+  return ret == (Minisat::lbool)l_True;
+}
+
 bool SimplifyingMinisat::simplify() // Removes already satisfied clauses.
 {
   return s->simplify();
@@ -97,6 +123,18 @@ void SimplifyingMinisat::setSeed(int i)
   s->random_seed = i;
 }
 
+void SimplifyingMinisat::setDiversity(int k)
+{
+  if (k == 0)
+    return;
+
+  // Alternate between Luby and geometric restarts, and make some decisions
+  // at random so that the seed matters.
+  s->luby_restart = (k % 2 == 0);
+  s->random_var_freq = 0.02;
+  s->random_seed = k;
+}
+
 uint32_t SimplifyingMinisat::newVar()
 {
   return s->newVar();
@@ -112,6 +150,21 @@ void SimplifyingMinisat::printStats() const
   //s->printStats();
 }
 
+uint64_t SimplifyingMinisat::nConflicts() const
+{
+  return s->conflicts;
+}
+
+uint64_t SimplifyingMinisat::nDecisions() const
+{
+  return s->decisions;
+}
+
+uint64_t SimplifyingMinisat::nPropagations() const
+{
+  return s->propagations;
+}
+
 void SimplifyingMinisat::setFrozen(uint32_t x)
 {
   s->setFrozen(x, true);
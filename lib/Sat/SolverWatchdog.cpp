@@ -1,8 +1,4 @@
 /********************************************************************
- * AUTHORS: Trevor Hansen
- *
- * BEGIN DATE: 06/02/2011
- *
 Permission is hereby granted, free of charge, to any person obtaining a copy
 of this software and associated documentation files (the "Software"), to deal
 in the Software without restriction, including without limitation the rights
@@ -22,9 +18,45 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ********************************************************************/
 
-#include "stp/Simplifier/MutableASTNode.h"
+#include "stp/Sat/SolverWatchdog.h"
+#include <chrono>
+
 namespace stp
 {
 
-vector<MutableASTNode*> MutableASTNode::all;
+SolverWatchdog::SolverWatchdog(SATSolver& s, long milliseconds)
+    : solver(s), finished(false), fired(false)
+{
+  if (milliseconds >= 0)
+    watcher = std::thread(&SolverWatchdog::watch, this, milliseconds);
+}
+
+void SolverWatchdog::watch(long milliseconds)
+{
+  std::unique_lock<std::mutex> l(lock);
+  if (!wake.wait_for(l, std::chrono::milliseconds(milliseconds),
+                     [this] { return finished; }))
+  {
+    fired = true;
+    solver.interrupt();
+  }
+}
+
+SolverWatchdog::~SolverWatchdog()
+{
+  if (!watcher.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> l(lock);
+    finished = true;
+  }
+  wake.notify_one();
+  watcher.join();
+
+  // If the interrupt arrived after the search finished, it would stop the
+  // next search straight away.
+  if (fired)
+    solver.clearInterrupt();
+}
 }
@@ -82,9 +82,6 @@ bool allChildrenAreUnconstrained(vector<MutableASTNode*> children)
   return true;
 }
 
-//Global variable TODO!! This is really bad.
-Simplifier* simplifier_convenient;
-
 ASTNode
 RemoveUnconstrained::replaceParentWithFresh(MutableASTNode& mute,
                                             vector<MutableASTNode*>& variables)
@@ -98,11 +95,12 @@ RemoveUnconstrained::replaceParentWithFresh(MutableASTNode& mute,
 
 //  nb. This avoids the expensive checks that usually updating the substitution
 //  map entails.
-void RemoveUnconstrained::replace(const ASTNode& from, const ASTNode to)
+void RemoveUnconstrained::replace(Simplifier* simplifier, const ASTNode& from,
+                                  const ASTNode to)
 {
   assert(from.GetKind() == SYMBOL);
   assert(from.GetValueWidth() == to.GetValueWidth());
-  simplifier_convenient->UpdateSubstitutionMapFewChecks(from, to);
+  simplifier->UpdateSubstitutionMapFewChecks(from, to);
 }
 
 /* The most complicated handling is for EXTRACTS. If a variable has parents that
@@ -119,7 +117,8 @@ void RemoveUnconstrained::replace(const ASTNode& from, const ASTNode to)
 * we wont
 *  replace the [3:5] (even though it could be).
 */
-void RemoveUnconstrained::splitExtractOnly(vector<MutableASTNode*> extracts)
+void RemoveUnconstrained::splitExtractOnly(vector<MutableASTNode*> extracts,
+                                           Simplifier* simplifier)
 {
   assert(extracts.size() > 0);
 
@@ -187,7 +186,7 @@ void RemoveUnconstrained::splitExtractOnly(vector<MutableASTNode*> extracts)
                              concatVec[i], concat);
     }
 
-    replace(var, concat);
+    replace(simplifier, var, concat);
   }
 }
 
@@ -197,19 +196,17 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
   if (n.GetKind() == SYMBOL)
     return n; // top level is an unconstrained symbol/.
 
-  simplifier_convenient = simplifier;
-
-  MutableASTNode* topMutable = MutableASTNode::build(n);
+  MutableASTNode* topMutable = MutableASTNode::build(n, all);
 
   vector<MutableASTNode*> extracts;
-  topMutable->getDisjointExtractVariables(extracts);
+  MutableASTNode::getDisjointExtractVariables(all, extracts);
   if (extracts.size() > 0)
   {
-    splitExtractOnly(extracts);
+    splitExtractOnly(extracts, simplifier);
   }
 
   vector<MutableASTNode*> variable_array;
-  topMutable->getAllUnconstrainedVariables(variable_array);
+  MutableASTNode::getAllUnconstrainedVariables(all, variable_array);
 
   // We don't want to check some expensive nodes over and over again.
   ASTNodeSet noCheck;
@@ -315,8 +312,8 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
           ASTNode rhs = nf->CreateTerm(BVEXTRACT, children[1].GetValueWidth(),
                                        v, top_rhs, bottom_rhs);
 
-          replace(children[0], lhs);
-          replace(children[1], rhs);
+          replace(simplifier, children[0], lhs);
+          replace(simplifier, children[1], rhs);
         }
       }
       break;
@@ -324,7 +321,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
       case NOT:
       {
         ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-        replace(children[0], nf->CreateNode(NOT, v));
+        replace(simplifier, children[0], nf->CreateNode(NOT, v));
       }
       break;
 
@@ -333,7 +330,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
       {
         assert(numberOfChildren == 1);
         ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-        replace(var, nf->CreateTerm(kind, width, v));
+        replace(simplifier, var, nf->CreateTerm(kind, width, v));
       }
       break;
 
@@ -391,8 +388,8 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
                                        bm.CreateZeroConst(width));
           ASTNode rhs = nf->CreateTerm(ITE, width, v, bm.CreateZeroConst(width),
                                        bm.CreateOneConst(width));
-          replace(children[0], lhs);
-          replace(children[1], rhs);
+          replace(simplifier, children[0], lhs);
+          replace(simplifier, children[1], rhs);
         }
         else if (children[0] == var && children[1].isConstant())
         {
@@ -403,7 +400,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
 
           ASTNode rhs =
               nf->CreateTerm(ITE, width, v, biggestNumber, smallestNumber);
-          replace(var, rhs);
+          replace(simplifier, var, rhs);
         }
         else if (children[1] == var && children[0].isConstant())
         {
@@ -414,7 +411,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
 
           ASTNode rhs =
               nf->CreateTerm(ITE, width, v, smallestNumber, biggestNumber);
-          replace(var, rhs);
+          replace(simplifier, var, rhs);
         }
         else // One side is a variable. The other is anything.
         {
@@ -467,8 +464,8 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
                       NOT, nf->CreateNode(
                                EQ, mutable_children[0]->toASTNode(nf), c2)));
           }
-          replace(var, rhs);
-          MutableASTNode* newN = MutableASTNode::build(n, create);
+          replace(simplifier, var, rhs);
+          MutableASTNode* newN = MutableASTNode::build(n, create, all);
           muteParent.replaceWithAnotherNode(newN);
           // assert(muteParent.checkInvariant());
         }
@@ -494,7 +491,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
             */
             if (already.find(children[i]) == already.end())
             {
-              replace(children[i], v);
+              replace(simplifier, children[i], v);
               already.insert(children[i]);
             }
           }
@@ -530,7 +527,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
         if (kind == XOR)
         {
           ASTNode xorNode = nf->CreateNode(XOR, others);
-          replace(var, nf->CreateNode(XOR, v, xorNode));
+          replace(simplifier, var, nf->CreateNode(XOR, v, xorNode));
         }
         else
         {
@@ -540,7 +537,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
           else
             xorNode = others[0];
 
-          replace(var, nf->CreateTerm(BVXOR, width, v, xorNode));
+          replace(simplifier, var, nf->CreateTerm(BVXOR, width, v, xorNode));
         }
       }
       break;
@@ -555,24 +552,24 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
             children[0] != children[1])
         {
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-          replace(children[0], bm.ASTTrue);
-          replace(children[1], v);
+          replace(simplifier, children[0], bm.ASTTrue);
+          replace(simplifier, children[1], v);
         }
         else if (mutable_children[0]->isUnconstrained() &&
                  mutable_children[2]->isUnconstrained() &&
                  children[0] != children[2])
         {
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-          replace(children[0], bm.ASTFalse);
-          replace(children[2], v);
+          replace(simplifier, children[0], bm.ASTFalse);
+          replace(simplifier, children[2], v);
         }
         else if (mutable_children[1]->isUnconstrained() &&
                  mutable_children[2]->isUnconstrained())
         {
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-          replace(children[1], v);
+          replace(simplifier, children[1], v);
           if (children[1] != children[2])
-            replace(children[2], v);
+            replace(simplifier, children[2], v);
         }
       }
       break;
@@ -586,8 +583,8 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
         {
           assert(children[0] != children[1]);
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-          replace(children[1], bm.CreateZeroConst(width));
-          replace(children[0], v);
+          replace(simplifier, children[1], bm.CreateZeroConst(width));
+          replace(simplifier, children[0], v);
         }
       }
       break;
@@ -601,8 +598,8 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
         {
           assert(children[0] != children[1]);
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-          replace(children[1], bm.CreateZeroConst(width));
-          replace(children[0], v);
+          replace(simplifier, children[1], bm.CreateZeroConst(width));
+          replace(simplifier, children[0], v);
         }
       }
       break;
@@ -615,8 +612,8 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
         {
           assert(children[0] != children[1]);
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-          replace(children[1], bm.CreateOneConst(width));
-          replace(children[0], v);
+          replace(simplifier, children[1], bm.CreateOneConst(width));
+          replace(simplifier, children[0], v);
         }
       }
       break;
@@ -628,8 +625,8 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
             mutable_children[0]->isUnconstrained()) // both are unconstrained
         {
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
-          replace(children[0], bm.CreateOneConst(width));
-          replace(children[1], v);
+          replace(simplifier, children[0], bm.CreateOneConst(width));
+          replace(simplifier, children[1], v);
         }
 
         if (other.isConstant() && simplifier->BVConstIsOdd(other))
@@ -637,7 +634,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
           ASTNode v = replaceParentWithFresh(muteParent, variable_array);
           ASTNode inverse = simplifier->MultiplicativeInverse(other);
           ASTNode rhs = nf->CreateTerm(BVMULT, width, inverse, v);
-          replace(var, rhs);
+          replace(simplifier, var, rhs);
         }
 
         break;
@@ -648,7 +645,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
           ASTNode rhs =
               nf->CreateNode(ITE, v, muteOther->toASTNode(nf),
                              nf->CreateNode(NOT, muteOther->toASTNode(nf)));
-          replace(var, rhs);
+          replace(simplifier, var, rhs);
         }
         break;
         case EQ:
@@ -661,7 +658,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
               nf->CreateTerm(BVPLUS, width, muteOther->toASTNode(nf),
                              bm.CreateOneConst(width)));
 
-          replace(var, rhs);
+          replace(simplifier, var, rhs);
         }
         break;
         case BVSUB:
@@ -677,7 +674,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
           if (children[1] == var)
             rhs = nf->CreateTerm(BVSUB, width, muteOther->toASTNode(nf), v);
 
-          replace(var, rhs);
+          replace(simplifier, var, rhs);
         }
         break;
 
@@ -700,7 +697,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
           else
             rhs = nf->CreateTerm(BVSUB, width, v, other[0]);
 
-          replace(var, rhs);
+          replace(simplifier, var, rhs);
         }
         break;
         case BVEXTRACT:
@@ -740,7 +737,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
           }
 
           assert(newWidth == (long int)operandWidth);
-          replace(var, current);
+          replace(simplifier, var, current);
         }
         break;
         default:
@@ -755,7 +752,7 @@ ASTNode RemoveUnconstrained::topLevel_other(const ASTNode& n,
   }
 
   ASTNode result = topMutable->toASTNode(nf);
-  topMutable->cleanup();
+  MutableASTNode::cleanup(all);
   // cout << result;
   return result;
 }
@@ -119,118 +119,192 @@ ASTNode SubstitutionMap::replace(const ASTNode& n, ASTNodeMap& fromTo,
 // NB: You can't use this to map from "5" to the symbol "x" say.
 // It's optimised for the symbol to something case.
 
-ASTNode SubstitutionMap::replace(const ASTNode& n, ASTNodeMap& fromTo,
-                                 ASTNodeMap& cache, NodeFactory* nf,
-                                 bool stopAtArrays, bool preventInfinite)
+// The traversal uses its own stack, rather than recursing, so that long
+// chains don't overflow the native stack. Nodes are visited in the same
+// order the recursive version visited them, so the result is the same.
+namespace
 {
-  const Kind k = n.GetKind();
-  if (k == BVCONST || k == TRUE || k == FALSE)
-    return n;
-
-  ASTNodeMap::const_iterator it;
-
-  if ((it = cache.find(n)) != cache.end())
-    return it->second;
-
-  if ((it = fromTo.find(n)) != fromTo.end())
-  {
-    const ASTNode& r = it->second;
-    assert(r.GetIndexWidth() == n.GetIndexWidth());
-
-    if (preventInfinite)
-      cache.insert(make_pair(n, r));
-
-    ASTNode replaced =
-        replace(r, fromTo, cache, nf, stopAtArrays, preventInfinite);
-    if (replaced != r)
-    {
-      fromTo.erase(n);
-      fromTo[n] = replaced;
-    }
-
-    if (preventInfinite)
-      cache.erase(n);
-
-    cache.insert(make_pair(n, replaced));
-    return replaced;
-  }
-
-  // These can't be created like regular nodes are
-  if (k == SYMBOL)
-    return n;
-
-  const unsigned int indexWidth = n.GetIndexWidth();
-  if (stopAtArrays && indexWidth > 0) // is an array.
-  {
-    return n;
-  }
-
-  const ASTVec& children = n.GetChildren();
-  assert(children.size() > 0);
-  // Should have no leaves left here.
-
-  ASTVec new_children;
-  new_children.reserve(children.size());
-
-  for (ASTVec::const_iterator it = children.begin(); it != children.end(); it++)
-  {
-    new_children.push_back(
-        replace(*it, fromTo, cache, nf, stopAtArrays, preventInfinite));
-  }
-
-  assert(new_children.size() == children.size());
-
-  // This code short-cuts if the children are the same. Nodes with the same
-  // children,
-  // won't have necessarily given the same node if the simplifyingNodeFactory is
-  // enabled
-  // now, but wasn't enabled when the node was created. Shortcutting saves lots
-  // of time.
-  if (new_children == children)
-  {
-    cache.insert(make_pair(n, n));
-    return n;
-  }
-
-  ASTNode result;
-  const unsigned int valueWidth = n.GetValueWidth();
-
-  if (valueWidth == 0) // n.GetType() == BOOLEAN_TYPE
+struct ReplaceStep
+{
+  enum Kind
   {
-    result = nf->CreateNode(k, new_children);
-  }
-  else
+    VISIT,   // Replace node.
+    MAPPED,  // node maps to mapped, whose replacement is on the result stack.
+    BUILD,   // The replaced children of node are on the result stack.
+    REBUILT  // node's rebuilt version was mapped, its replacement is on top.
+  };
+
+  Kind kind;
+  ASTNode node;
+  ASTNode mapped;
+
+  ReplaceStep(Kind k, const ASTNode& n, const ASTNode& m = ASTNode())
+      : kind(k), node(n), mapped(m)
   {
-    // If the index and value width aren't saved, they are reset sometimes (??)
-    result = nf->CreateArrayTerm(k, indexWidth, valueWidth, new_children);
   }
+};
+}
 
-  // We may have created something that should be mapped. For instance,
-  // if n is READ(A, x), and the fromTo is: {x==0, READ(A,0) == 1}, then
-  // by here the result will be READ(A,0). Which needs to be mapped again..
-  // I hope that this makes it idempotent.
+ASTNode SubstitutionMap::replace(const ASTNode& top, ASTNodeMap& fromTo,
+                                 ASTNodeMap& cache, NodeFactory* nf,
+                                 bool stopAtArrays, bool preventInfinite)
+{
+  vector<ReplaceStep> todo;
+  ASTVec results;
+  todo.push_back(ReplaceStep(ReplaceStep::VISIT, top));
 
-  if (fromTo.find(result) != fromTo.end())
+  while (!todo.empty())
   {
-    // map n->result, if running replace() on result gives us 'n', it will not
-    // infinite loop.
-    // This is only currently required for the bitblast equivalence stuff.
-    if (preventInfinite)
-      cache.insert(make_pair(n, result));
+    const ReplaceStep step = todo.back();
+    todo.pop_back();
+    const ASTNode& n = step.node;
 
-    result = replace(result, fromTo, cache, nf, stopAtArrays, preventInfinite);
+    switch (step.kind)
+    {
+      case ReplaceStep::VISIT:
+      {
+        const Kind k = n.GetKind();
+        if (k == BVCONST || k == TRUE || k == FALSE)
+        {
+          results.push_back(n);
+          break;
+        }
+
+        ASTNodeMap::const_iterator it;
+
+        if ((it = cache.find(n)) != cache.end())
+        {
+          results.push_back(it->second);
+          break;
+        }
+
+        if ((it = fromTo.find(n)) != fromTo.end())
+        {
+          const ASTNode r = it->second;
+          assert(r.GetIndexWidth() == n.GetIndexWidth());
+
+          if (preventInfinite)
+            cache.insert(make_pair(n, r));
+
+          todo.push_back(ReplaceStep(ReplaceStep::MAPPED, n, r));
+          todo.push_back(ReplaceStep(ReplaceStep::VISIT, r));
+          break;
+        }
+
+        // These can't be created like regular nodes are
+        if (k == SYMBOL)
+        {
+          results.push_back(n);
+          break;
+        }
+
+        if (stopAtArrays && n.GetIndexWidth() > 0) // is an array.
+        {
+          results.push_back(n);
+          break;
+        }
+
+        const ASTVec& children = n.GetChildren();
+        assert(children.size() > 0);
+        // Should have no leaves left here.
+
+        // Pushed in reverse, so the first child is replaced first.
+        todo.push_back(ReplaceStep(ReplaceStep::BUILD, n));
+        for (ASTVec::const_reverse_iterator c = children.rbegin();
+             c != children.rend(); c++)
+          todo.push_back(ReplaceStep(ReplaceStep::VISIT, *c));
+        break;
+      }
+
+      case ReplaceStep::MAPPED:
+      {
+        const ASTNode replaced = results.back();
+        if (replaced != step.mapped)
+        {
+          fromTo.erase(n);
+          fromTo[n] = replaced;
+        }
+
+        if (preventInfinite)
+          cache.erase(n);
+
+        cache.insert(make_pair(n, replaced));
+        break;
+      }
+
+      case ReplaceStep::BUILD:
+      {
+        const ASTVec& children = n.GetChildren();
+        ASTVec new_children(results.end() - children.size(), results.end());
+        results.resize(results.size() - children.size());
+
+        // This code short-cuts if the children are the same. Nodes with the
+        // same children, won't have necessarily given the same node if the
+        // simplifyingNodeFactory is enabled now, but wasn't enabled when the
+        // node was created. Shortcutting saves lots of time.
+        if (new_children == children)
+        {
+          cache.insert(make_pair(n, n));
+          results.push_back(n);
+          break;
+        }
+
+        ASTNode result;
+        const unsigned int valueWidth = n.GetValueWidth();
+
+        if (valueWidth == 0) // n.GetType() == BOOLEAN_TYPE
+        {
+          result = nf->CreateNode(n.GetKind(), new_children);
+        }
+        else
+        {
+          // If the index and value width aren't saved, they are reset
+          // sometimes (??)
+          result = nf->CreateArrayTerm(n.GetKind(), n.GetIndexWidth(),
+                                       valueWidth, new_children);
+        }
+
+        // We may have created something that should be mapped. For instance,
+        // if n is READ(A, x), and the fromTo is: {x==0, READ(A,0) == 1}, then
+        // by here the result will be READ(A,0). Which needs to be mapped
+        // again.. I hope that this makes it idempotent.
+        if (fromTo.find(result) != fromTo.end())
+        {
+          // map n->result, if running replace() on result gives us 'n', it
+          // will not infinite loop.
+          // This is only currently required for the bitblast equivalence
+          // stuff.
+          if (preventInfinite)
+            cache.insert(make_pair(n, result));
+
+          todo.push_back(ReplaceStep(ReplaceStep::REBUILT, n));
+          todo.push_back(ReplaceStep(ReplaceStep::VISIT, result));
+          break;
+        }
+
+        results.push_back(result);
+      }
+      // Fall through.
+
+      case ReplaceStep::REBUILT:
+      {
+        const ASTNode& result = results.back();
+        assert(result.GetValueWidth() == n.GetValueWidth());
+        assert(result.GetIndexWidth() == n.GetIndexWidth());
+
+        // If there is already an "n" element in the cache, the maps semantics
+        // are to ignore the next insertion.
+        if (preventInfinite)
+          cache.erase(n);
+
+        cache.insert(make_pair(n, result));
+        break;
+      }
+    }
   }
 
-  assert(result.GetValueWidth() == valueWidth);
-  assert(result.GetIndexWidth() == indexWidth);
-
-  // If there is already an "n" element in the cache, the maps semantics are to
-  // ignore the next insertion.
-  if (preventInfinite)
-    cache.erase(n);
-
-  cache.insert(make_pair(n, result));
-  return result;
+  assert(results.size() == 1);
+  return results.back();
 }
 
 // Adds to the dependency graph that n0 depends on the variables in n1.
@@ -204,7 +204,7 @@ bool VariablesInExpression::VarSeenInTerm(const ASTNode& var,
       symbols->insert(sym.begin(), sym.end());
     }
     TermsAlreadySeenMap.insert(
-        make_pair(symbol_graph[term.GetNodeNum()], symbols));
+        std::make_pair(symbol_graph[term.GetNodeNum()], symbols));
     // cout << "finish" << symbols->size() << endl;
     // cout << "===" << endl;
     result = (symbols->count(var) != 0);
@@ -33,39 +33,79 @@ namespace simplifier
 namespace constantBitP
 {
 
+// These work on 64 bits at a time. The columns (bit positions) are independent,
+// so each word gives the same answer the bit at a time versions did.
+
+namespace
+{
+
+// Summarises a word of the operands. For each bit: whether some operand is
+// fixed to one, to zero, whether at least one / two are unfixed, the parity
+// of the operands fixed to one, and whether every operand is fixed to zero.
+struct WordStats
+{
+  uint64_t someOne, someZero, oneUnfixed, twoUnfixed, parity, allZero;
+
+  WordStats(const vector<FixedBits*>& operands, unsigned w)
+      : someOne(0), someZero(0), oneUnfixed(0), twoUnfixed(0), parity(0),
+        allZero(~(uint64_t)0)
+  {
+    const uint64_t mask = operands[0]->wordMask(w);
+    for (unsigned j = 0, size = operands.size(); j < size; j++)
+    {
+      const uint64_t ones = operands[j]->getOnesWord(w);
+      const uint64_t zeroes = operands[j]->getZeroesWord(w);
+      const uint64_t unfixed = ~operands[j]->getFixedWord(w) & mask;
+
+      someOne |= ones;
+      someZero |= zeroes;
+      allZero &= zeroes;
+      parity ^= ones;
+      twoUnfixed |= oneUnfixed & unfixed;
+      oneUnfixed |= unfixed;
+    }
+  }
+
+  uint64_t exactlyOneUnfixed() const { return oneUnfixed & ~twoUnfixed; }
+};
+
+// Fixes the unfixed bits of every operand that are in mask to v.
+void fixUnfixedTo(vector<FixedBits*>& operands, unsigned w, uint64_t mask,
+                  uint64_t v)
+{
+  for (unsigned j = 0, size = operands.size(); j < size; j++)
+    operands[j]->fixWord(w, mask & ~operands[j]->getFixedWord(w), v);
+}
+}
+
 Result bvXorBothWays(vector<FixedBits*>& operands, FixedBits& output)
 {
   Result result = NO_CHANGE;
-  const int bitWidth = output.getWidth();
 
-  for (int i = 0; i < bitWidth; i++)
+  for (unsigned w = 0; w < output.numberOfWords(); w++)
   {
-    const stats status = getStats(operands, i);
+    const WordStats status(operands, w);
+    const uint64_t outFixed = output.getFixedWord(w);
+    const uint64_t outValue = output.getOnesWord(w);
+    const uint64_t allFixed = ~status.oneUnfixed & output.wordMask(w);
 
-    if (status.unfixed == 0) // if they are all fixed. We know the answer.
-    {
-      bool answer = (status.fixedToOne % 2) != 0;
+    // if they are all fixed. We know the answer.
+    if ((allFixed & outFixed & (outValue ^ status.parity)) != 0)
+      return CONFLICT;
 
-      if (!output.isFixed(i))
-      {
-        output.setFixed(i, true);
-        output.setValue(i, answer);
-        result = CHANGED;
-      }
-      else if (output.getValue(i) != answer)
-        return CONFLICT;
+    const uint64_t fixOutput = allFixed & ~outFixed;
+    if (fixOutput != 0)
+    {
+      output.fixWord(w, fixOutput, status.parity);
+      result = CHANGED;
     }
-    else if (status.unfixed == 1 && output.isFixed(i))
+
+    // If there is just one unfixed, and we have the answer --> We know the
+    // value.
+    const uint64_t fixOperand = status.exactlyOneUnfixed() & outFixed;
+    if (fixOperand != 0)
     {
-      // If there is just one unfixed, and we have the answer --> We know the
-      // value.
-      bool soFar = ((status.fixedToOne % 2) != 0);
-      if (soFar != output.getValue(i))
-      { // result needs to be flipped.
-        fixUnfixedTo(operands, i, true);
-      }
-      else
-        fixUnfixedTo(operands, i, false);
+      fixUnfixedTo(operands, w, fixOperand, status.parity ^ outValue);
       result = CHANGED;
     }
   }
@@ -78,50 +118,48 @@ Result bvXorBothWays(vector<FixedBits*>& operands, FixedBits& output)
 Result bvAndBothWays(vector<FixedBits*>& operands, FixedBits& output)
 {
   Result result = NO_CHANGE;
-  const int bitWidth = output.getWidth();
 
-  for (int i = 0; i < bitWidth; i++)
+  for (unsigned w = 0; w < output.numberOfWords(); w++)
   {
-    const stats status = getStats(operands, i);
+    const WordStats status(operands, w);
+    const uint64_t outOne = output.getOnesWord(w);
+    const uint64_t outZero = output.getZeroesWord(w);
+    const uint64_t outUnfixed = ~output.getFixedWord(w) & output.wordMask(w);
+    const uint64_t allOne = ~status.someZero & ~status.oneUnfixed;
 
     // output is fixed to one. But an input value is false!
-    if (output.isFixed(i) && output.getValue(i) && status.fixedToZero > 0)
+    if ((outOne & status.someZero) != 0)
       return CONFLICT;
 
-    // output is fixed to one. But an input value is false!
-    if (output.isFixed(i) && !output.getValue(i) && status.fixedToZero == 0 &&
-        status.unfixed == 0)
+    // output is fixed to zero. But every input is true!
+    if ((outZero & allOne) != 0)
       return CONFLICT;
 
     // output is fixed to one. So all should be one.
-    if (output.isFixed(i) && output.getValue(i) && status.unfixed > 0)
+    const uint64_t toOne = outOne & status.oneUnfixed;
+    if (toOne != 0)
     {
-      fixUnfixedTo(operands, i, true);
+      fixUnfixedTo(operands, w, toOne, ~(uint64_t)0);
       result = CHANGED;
     }
 
     // The output is unfixed. At least one input is false.
-    if (!output.isFixed(i) && status.fixedToZero > 0)
-    {
-      output.setFixed(i, true);
-      output.setValue(i, false);
-      result = CHANGED;
-    }
-
+    const uint64_t outToZero = outUnfixed & status.someZero;
     // Everything is fixed to one!
-    if (!output.isFixed(i) && status.fixedToZero == 0 && status.unfixed == 0)
+    const uint64_t outToOne = outUnfixed & allOne;
+    if ((outToZero | outToOne) != 0)
     {
-      output.setFixed(i, true);
-      output.setValue(i, true);
+      output.fixWord(w, outToZero | outToOne, outToOne);
       result = CHANGED;
     }
 
     // If the output is false, and there is a single unfixed value with
     // everything else true..
-    if (output.isFixed(i) && !output.getValue(i) && status.fixedToZero == 0 &&
-        status.unfixed == 1)
+    const uint64_t toZero =
+        outZero & ~status.someZero & status.exactlyOneUnfixed();
+    if (toZero != 0)
     {
-      fixUnfixedTo(operands, i, false);
+      fixUnfixedTo(operands, w, toZero, 0);
       result = CHANGED;
     }
   }
@@ -131,94 +169,43 @@ Result bvAndBothWays(vector<FixedBits*>& operands, FixedBits& output)
 Result bvOrBothWays(vector<FixedBits*>& children, FixedBits& output)
 {
   Result r = NO_CHANGE;
-  const int numberOfChildren = children.size();
-  const int bitWidth = output.getWidth();
 
-  for (int i = 0; i < bitWidth; i++)
+  for (unsigned w = 0; w < output.numberOfWords(); w++)
   {
-    bool answerKnown = output.isFixed(i);
-    bool answer = false;
-    if (answerKnown)
-      answer = output.getValue(i);
-
-    int unks = 0;
-    int ones = 0;
-    int zeroes = 0;
-
-    for (int j = 0; j < numberOfChildren; j++)
-    {
-      assert(output.getWidth() == children[j]->getWidth());
-
-      if (!children[j]->isFixed(i))
-        unks++;
-      else if (children[j]->getValue(i))
-        ones++;
-      else
-        zeroes++;
-    }
-
-    if (ones > 0) // Atleast a single one found!
+    const WordStats status(children, w);
+    const uint64_t outOne = output.getOnesWord(w);
+    const uint64_t outZero = output.getZeroesWord(w);
+    const uint64_t outUnfixed = ~output.getFixedWord(w) & output.wordMask(w);
+
+    // Atleast a single one found, but the answer is false. Or all zeroes, but
+    // the answer is true.
+    if ((status.someOne & outZero) != 0 || (status.allZero & outOne) != 0)
+      return CONFLICT;
 
+    const uint64_t outToOne = outUnfixed & status.someOne;
+    const uint64_t outToZero = outUnfixed & status.allZero;
+    if ((outToOne | outToZero) != 0)
     {
-      if (answerKnown && !answer)
-        return CONFLICT;
-
-      if (!answerKnown)
-      {
-        output.setFixed(i, true);
-        output.setValue(i, true);
-        r = CHANGED;
-      }
+      output.fixWord(w, outToOne | outToZero, outToOne);
+      r = CHANGED;
     }
 
-    if (zeroes == numberOfChildren) // all zeroes.
-
+    // known false. Set all the column to false.
+    const uint64_t toZero = outZero & status.oneUnfixed;
+    if (toZero != 0)
     {
-      if (answerKnown && answer)
-        return CONFLICT;
-
-      if (!answerKnown)
-      {
-        r = CHANGED;
-        output.setFixed(i, true);
-        output.setValue(i, false);
-      }
-    }
-
-    if (answerKnown && !answer) // known false
-
-    {
-      if (ones > 0)
-        return CONFLICT;
-
-      // set all the column to false.
-
-      for (int j = 0; j < numberOfChildren; j++)
-      {
-        if (!children[j]->isFixed(i))
-        {
-          r = CHANGED;
-          children[j]->setFixed(i, true);
-          children[j]->setValue(i, false);
-        }
-      }
+      fixUnfixedTo(children, w, toZero, 0);
+      r = CHANGED;
     }
 
-    if (unks == 1 && answerKnown && answer &&
-        (zeroes == (numberOfChildren - 1)))
+    // A single unknown, everything else is false. The answer is true. So the
+    // unknown is true.
+    const uint64_t toOne =
+        outOne & status.exactlyOneUnfixed() & ~status.someOne;
+    if (toOne != 0)
     {
-      // A single unknown, everything else is false. The answer is true. So the
-      // unknown is true.
-
-      for (int j = 0; j < numberOfChildren; j++)
-      {
-        if (!children[j]->isFixed(i))
-        {
-          r = CHANGED;
-          children[j]->setFixed(i, true);
-          children[j]->setValue(i, true);
-        }
-      }
+      fixUnfixedTo(children, w, toOne, ~(uint64_t)0);
+      r = CHANGED;
     }
   }
   return r;
@@ -320,30 +307,29 @@ Result bvImpliesBothWays(vector<FixedBits*>& children, FixedBits& result)
 Result bvNotBothWays(FixedBits& a, FixedBits& output)
 {
   assert(a.getWidth() == output.getWidth());
-  const int bitWidth = a.getWidth();
 
   Result result = NO_CHANGE;
 
-  for (int i = 0; i < bitWidth; i++)
+  for (unsigned w = 0; w < a.numberOfWords(); w++)
   {
+    const uint64_t aFixed = a.getFixedWord(w);
+    const uint64_t outFixed = output.getFixedWord(w);
+
     // error if they are the same.
-    if (a.isFixed(i) && output.isFixed(i) &&
-        (a.getValue(i) == output.getValue(i)))
-    {
+    if ((aFixed & outFixed & ~(a.getOnesWord(w) ^ output.getOnesWord(w))) != 0)
       return CONFLICT;
-    }
 
-    if (a.isFixed(i) && !output.isFixed(i))
+    const uint64_t toOutput = aFixed & ~outFixed;
+    if (toOutput != 0)
     {
-      output.setFixed(i, true);
-      output.setValue(i, !a.getValue(i));
+      output.fixWord(w, toOutput, ~a.getOnesWord(w));
       result = CHANGED;
     }
 
-    if (output.isFixed(i) && !a.isFixed(i))
+    const uint64_t toA = outFixed & ~aFixed;
+    if (toA != 0)
     {
-      a.setFixed(i, true);
-      a.setValue(i, !output.getValue(i));
+      a.fixWord(w, toA, ~output.getOnesWord(w));
       result = CHANGED;
     }
   }
@@ -138,36 +138,21 @@ void destroy(CBV a, CBV b, CBV c, CBV d)
 }
 
 // Fast exit. Without creating min/max.
+// True if the most significant bit where c0 and c1 aren't fixed to the same
+// value is unfixed in both.
 bool fast_exit(FixedBits& c0, FixedBits& c1)
 {
   assert(c0.getWidth() == c1.getWidth());
-  for (int i = (int)c0.getWidth() - 1; i >= 0; i--)
+  for (int w = (int)c0.numberOfWords() - 1; w >= 0; w--)
   {
-    const char c_0 = c0[i];
-    const char c_1 = c1[i];
-
-    if (c_0 == '0')
-    {
-      if (c_1 == '0') {
-        continue;
-      }
-      return false;
-    }
-
-    if (c_0 == '1')
-    {
-      if (c_1 == '1') {
-        continue;
-      }
-      return false;
-    }
-
-    if (c_0 == '*' && c_1 == '*')
-    {
-      return true;
-    }
-
-    return false;
+    const uint64_t same = c0.getFixedWord(w) & c1.getFixedWord(w) &
+                          ~(c0.getOnesWord(w) ^ c1.getOnesWord(w));
+    const uint64_t different = ~same & c0.wordMask(w);
+    if (different == 0)
+      continue;
+
+    const uint64_t top = (uint64_t)1 << topBit64(different);
+    return ((c0.getFixedWord(w) | c1.getFixedWord(w)) & top) == 0;
   }
   return false;
 }
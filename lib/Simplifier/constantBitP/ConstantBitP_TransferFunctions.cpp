@@ -49,31 +49,31 @@ Result bvEqualsBothWays(FixedBits& a, FixedBits& b, FixedBits& output)
   assert(a.getWidth() == b.getWidth());
   assert(1 == output.getWidth());
 
-  const int childWidth = a.getWidth();
+  const unsigned words = a.numberOfWords();
 
   Result r = NO_CHANGE;
 
+  // Works a word at a time. "unfixed" counts the unfixed bits of a and b.
   bool allSame = true;
   bool definatelyFalse = false;
+  unsigned unfixed = 0;
 
-  for (int i = 0; i < childWidth; i++)
+  for (unsigned w = 0; w < words; w++)
   {
-    // if both fixed
-    if (a.isFixed(i) && b.isFixed(i))
+    const uint64_t bothFixed = a.getFixedWord(w) & b.getFixedWord(w);
+
+    // if both fixed, and have different values.
+    if ((bothFixed & (a.getOnesWord(w) ^ b.getOnesWord(w))) != 0)
     {
-      // And have different values.
-      if (a.getValue(i) != b.getValue(i))
-      {
-        definatelyFalse = true;
-        break;
-      }
-      else
-      {
-        allSame &= true;
-        continue;
-      }
+      definatelyFalse = true;
+      break;
     }
-    allSame &= false;
+
+    if (bothFixed != a.wordMask(w))
+      allSame = false;
+
+    unfixed += popcount64(~a.getFixedWord(w) & a.wordMask(w)) +
+               popcount64(~b.getFixedWord(w) & b.wordMask(w));
   }
 
   if (definatelyFalse)
@@ -105,70 +105,44 @@ Result bvEqualsBothWays(FixedBits& a, FixedBits& b, FixedBits& output)
 
   if (output.isFixed(0) && output.getValue(0)) // all should be the same.
   {
-    for (int i = 0; i < childWidth; i++)
+    // definatelyFalse is a CONFLICT, and was returned above.
+    assert(!definatelyFalse);
+
+    // where only one is fixed, fix the other to the same.
+    for (unsigned w = 0; w < words; w++)
     {
-      if (a.isFixed(i) && b.isFixed(i))
+      const uint64_t aFixed = a.getFixedWord(w);
+      const uint64_t bFixed = b.getFixedWord(w);
+
+      if ((aFixed & ~bFixed) != 0)
       {
-        if (a.getValue(i) != b.getValue(i))
-        {
-          return CONFLICT;
-        }
+        b.fixWord(w, aFixed & ~bFixed, a.getOnesWord(w));
+        r = CHANGED;
       }
-      else if (a.isFixed(i) != b.isFixed(i)) // both same but only one is fixed.
+      if ((bFixed & ~aFixed) != 0)
       {
-        if (a.isFixed(i))
-        {
-          b.setFixed(i, true);
-          b.setValue(i, a.getValue(i));
-          r = CHANGED;
-        }
-        else
-        {
-          a.setFixed(i, true);
-          a.setValue(i, b.getValue(i));
-          r = CHANGED;
-        }
+        a.fixWord(w, bFixed & ~aFixed, b.getOnesWord(w));
+        r = CHANGED;
       }
     }
   }
 
   // if the result is fixed to false, there is a single unspecied value, and all
   // the rest are the same. Fix it to the opposite.
-  if (output.isFixed(0) && !output.getValue(0))
+  if (output.isFixed(0) && !output.getValue(0) && !definatelyFalse &&
+      1 == unfixed)
   {
-    int unknown = 0;
-
-    for (int i = 0; i < childWidth && unknown < 2; i++)
+    for (unsigned w = 0; w < words; w++)
     {
-      if (!a.isFixed(i))
-        unknown++;
-      if (!b.isFixed(i))
-        unknown++;
-      else if (a.isFixed(i) && b.isFixed(i) && a.getValue(i) != b.getValue(i))
-      {
-        unknown = 10; // hack, don't do the next loop.
-        break;
-      }
-    }
+      const uint64_t aUnfixed = ~a.getFixedWord(w) & a.wordMask(w);
+      const uint64_t bUnfixed = ~b.getFixedWord(w) & b.wordMask(w);
 
-    if (1 == unknown)
-    {
-      for (int i = 0; i < childWidth; i++)
-      {
-        if (!a.isFixed(i))
-        {
-          a.setFixed(i, true);
-          a.setValue(i, !b.getValue(i));
-          r = CHANGED;
-        }
-        if (!b.isFixed(i))
-        {
-          b.setFixed(i, true);
-          b.setValue(i, !a.getValue(i));
-          r = CHANGED;
-        }
-      }
+      if (aUnfixed != 0)
+        a.fixWord(w, aUnfixed, ~b.getOnesWord(w));
+      if (bUnfixed != 0)
+        b.fixWord(w, bUnfixed, ~a.getOnesWord(w));
     }
+    r = CHANGED;
   }
   return r;
 }
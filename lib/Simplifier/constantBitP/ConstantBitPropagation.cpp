@@ -56,7 +56,7 @@ namespace simplifier
 {
 namespace constantBitP
 {
-NodeToFixedBitsMap* PrintingHackfixedMap; // Used when debugging.
+thread_local NodeToFixedBitsMap* PrintingHackfixedMap; // Used when debugging.
 
 Result dispatchToTransferFunctions(const Kind k, vector<FixedBits*>& children,
                                    FixedBits& output, const ASTNode n,
@@ -183,6 +183,7 @@ ConstantBitPropagation::ConstantBitPropagation(stp::Simplifier* _sm,
   status = NO_CHANGE;
   simplifier = _sm;
   nf = _nf;
+  printWorkListStats = top.GetSTPMgr()->UserFlags.stats_flag;
   fixedMap = new NodeToFixedBitsMap(1000); // better to use the function that
                                            // returns the number of nodes..
                                            // whatever that is.
@@ -36,6 +36,215 @@ static void BVConstEvaluatorError(CONSTANTBV::ErrCode e)
   FatalError(ss.c_str());
 }
 
+static uint64_t wordMask(unsigned width)
+{
+  assert(width > 0 && width <= 64);
+  return (width == 64) ? ~(uint64_t)0 : (((uint64_t)1 << width) - 1);
+}
+
+static uint64_t toWord(const ASTNode& n)
+{
+  return n.GetSmallBVConst();
+}
+
+static bool isNegative(uint64_t v, unsigned width)
+{
+  return (v >> (width - 1)) & 1;
+}
+
+// Signed comparison, by flipping the sign bits and comparing unsigned.
+static bool signedLess(uint64_t a, uint64_t b, unsigned width)
+{
+  const uint64_t sign = (uint64_t)1 << (width - 1);
+  return (a ^ sign) < (b ^ sign);
+}
+
+// Evaluates kinds whose bit-vector operands and result are all 64 bits or
+// less using machine words, which avoids creating CBVs. Returns false if
+// the caller should use the general evaluator instead, for instance for a
+// division by zero.
+static bool evaluateWord(STPMgr* bm, const Kind k, const ASTVec& children,
+                         unsigned int width, ASTNode& output)
+{
+  const ASTNode& ASTTrue = bm->ASTTrue;
+  const ASTNode& ASTFalse = bm->ASTFalse;
+
+  for (size_t i = 0; i < children.size(); i++)
+    if (children[i].GetKind() != BVCONST || children[i].GetValueWidth() > 64)
+      return false;
+
+  const unsigned w0 = children[0].GetValueWidth();
+  const uint64_t a = toWord(children[0]);
+  const uint64_t b = children.size() > 1 ? toWord(children[1]) : 0;
+
+  uint64_t result;
+  switch (k)
+  {
+    case BOOLEXTRACT:
+      output = (b < w0 && ((a >> b) & 1)) ? ASTTrue : ASTFalse;
+      return true;
+
+    case EQ:
+      output = (a == b) ? ASTTrue : ASTFalse;
+      return true;
+    case BVLT:
+      output = (a < b) ? ASTTrue : ASTFalse;
+      return true;
+    case BVLE:
+      output = (a <= b) ? ASTTrue : ASTFalse;
+      return true;
+    case BVGT:
+      output = (a > b) ? ASTTrue : ASTFalse;
+      return true;
+    case BVGE:
+      output = (a >= b) ? ASTTrue : ASTFalse;
+      return true;
+    case BVSLT:
+      output = signedLess(a, b, w0) ? ASTTrue : ASTFalse;
+      return true;
+    case BVSLE:
+      output = !signedLess(b, a, w0) ? ASTTrue : ASTFalse;
+      return true;
+    case BVSGT:
+      output = signedLess(b, a, w0) ? ASTTrue : ASTFalse;
+      return true;
+    case BVSGE:
+      output = !signedLess(a, b, w0) ? ASTTrue : ASTFalse;
+      return true;
+
+    case BVEXTRACT:
+    {
+      const unsigned hi = (unsigned)b;
+      const unsigned low = (unsigned)toWord(children[2]);
+      width = hi - low + 1;
+      result = a >> low;
+      break;
+    }
+    case BVCONCAT:
+    {
+      const unsigned w1 = children[1].GetValueWidth();
+      if (w0 + w1 > 64)
+        return false;
+      width = w0 + w1;
+      result = (a << w1) | b;
+      break;
+    }
+    default:
+      if (width > 64)
+        return false;
+  }
+
+  const uint64_t mask = wordMask(width);
+  switch (k)
+  {
+    case BVEXTRACT:
+    case BVCONCAT:
+      break;
+    case BVNEG:
+      result = ~a;
+      break;
+    case BVUMINUS:
+      result = -a;
+      break;
+    case BVSX:
+    case BVZX:
+      result = a;
+      if (k == BVSX && isNegative(a, w0))
+        result |= ~wordMask(w0);
+      break;
+
+    case BVLEFTSHIFT:
+    case BVRIGHTSHIFT:
+    case BVSRSHIFT:
+    {
+      const bool fill = (k == BVSRSHIFT) && isNegative(a, width);
+      if (b >= width)
+        result = fill ? mask : 0;
+      else if (k == BVLEFTSHIFT)
+        result = a << b;
+      else
+      {
+        result = a >> b;
+        if (fill)
+          result |= ~(mask >> b);
+      }
+      break;
+    }
+
+    case BVAND:
+      result = mask;
+      for (size_t i = 0; i < children.size(); i++)
+        result &= toWord(children[i]);
+      break;
+    case BVOR:
+      result = 0;
+      for (size_t i = 0; i < children.size(); i++)
+        result |= toWord(children[i]);
+      break;
+    case BVXOR:
+      result = 0;
+      for (size_t i = 0; i < children.size(); i++)
+        result ^= toWord(children[i]);
+      break;
+    case BVPLUS:
+      result = 0;
+      for (size_t i = 0; i < children.size(); i++)
+        result += toWord(children[i]);
+      break;
+    case BVMULT:
+      result = 1;
+      for (size_t i = 0; i < children.size(); i++)
+        result *= toWord(children[i]);
+      break;
+    case BVSUB:
+      result = a - b;
+      break;
+
+    case BVDIV:
+    case BVMOD:
+      if (b == 0)
+        return false;
+      result = (k == BVDIV) ? (a / b) : (a % b);
+      break;
+
+    // Signed division is done on the magnitudes. The quotient rounds
+    // towards zero, and the remainder takes the sign of the dividend.
+    case SBVDIV:
+    case SBVREM:
+    case SBVMOD:
+    {
+      if (b == 0)
+        return false;
+      const bool negA = isNegative(a, width);
+      const bool negB = isNegative(b, width);
+      const uint64_t absA = (negA ? -a : a) & mask;
+      const uint64_t absB = (negB ? -b : b) & mask;
+      const uint64_t q = absA / absB;
+      const uint64_t r = absA % absB;
+
+      if (k == SBVDIV)
+        result = (negA != negB) ? -q : q;
+      else if (k == SBVREM)
+        result = negA ? -r : r;
+      else if (r == 0 || (!negA && !negB))
+        result = r;
+      else if (negA && !negB)
+        result = b - r;
+      else if (!negA && negB)
+        result = r + b;
+      else
+        result = -r;
+      break;
+    }
+
+    default:
+      return false;
+  }
+
+  output = bm->CreateBVConst(width, result & mask);
+  return true;
+}
+
 // Const evaluator logical and arithmetic operations.
 ASTNode NonMemberBVConstEvaluator(STPMgr* _bm, const Kind k,
                                   const ASTVec& input_children,
@@ -66,6 +275,10 @@ ASTNode NonMemberBVConstEvaluator(STPMgr* _bm, const Kind k,
       children.push_back(NonMemberBVConstEvaluator(input_children[i]));
   }
 
+  if (input_children[0].GetType() == BITVECTOR_TYPE &&
+      evaluateWord(_bm, k, children, inputwidth, OutputNode))
+    return OutputNode;
+
   if ((number_of_children == 2 || number_of_children == 1) &&
     input_children[0].GetType() == BITVECTOR_TYPE)
   {
@@ -49,6 +49,96 @@ namespace stp
 // then all the other arguments have already been simplified, so won't be
 // short-cutted.
 
+// Past this depth of recursion, the nodes below are simplified bottom up
+// first, so that long chains don't overflow the stack. They're simplified
+// without the context (pushed negations, short-cuts over siblings) the
+// recursion would have had, so on deep formulas the result can differ from
+// the purely recursive one. It's still equivalent to the input.
+const unsigned maxSimplifyDepth = 500;
+
+// Counts a level of recursion while it's in scope.
+class Simplifier::Level
+{
+  Simplifier& s;
+
+public:
+  explicit Level(Simplifier& s_) : s(s_) { s.depth++; }
+
+  ~Level()
+  {
+    // The VarConstMap may have changed by the next outermost call.
+    if (--s.depth == 0)
+    {
+      s.varConstResults.clear();
+      s.varConstResultsMap = NULL;
+    }
+  }
+};
+
+// Simplifies the nodes below n, children before parents, using an explicit
+// stack. When the recursion carries on from n it finds them in the simplify
+// map, so it goes no deeper. The children are visited the way SimplifyTerm
+// visits them, flattened for BVAND, BVOR and BVPLUS.
+void Simplifier::simplifyBelow(const ASTNode& n, ASTNodeMap* VarConstMap)
+{
+  // Not zero, which would end the outermost call.
+  const unsigned saved = depth;
+  depth = 1;
+
+  struct Frame
+  {
+    ASTNode node;
+    ASTVec children;
+    size_t next;
+  };
+
+  vector<Frame> todo;
+  ASTNodeSet seen;
+  ASTNode next = n;
+
+  while (true)
+  {
+    if (!next.IsNull())
+    {
+      const Kind k = next.GetKind();
+      Frame f = {next, next.GetChildren(), 0};
+      if (next.GetType() == BITVECTOR_TYPE &&
+          (k == BVAND || k == BVOR || k == BVPLUS))
+        f.children = FlattenKind(k, f.children);
+      todo.push_back(f);
+      next = ASTNode();
+    }
+
+    Frame& top = todo.back();
+    if (top.next < top.children.size())
+    {
+      const ASTNode& c = top.children[top.next++];
+      const types t = c.GetType();
+      const bool cached =
+          (VarConstMap == NULL)
+              ? c.isSimplfied() || SimplifyMap->find(c) != SimplifyMap->end()
+              : varConstResults.find(c) != varConstResults.end();
+      if (!c.isConstant() && c.GetKind() != SYMBOL &&
+          (t == BITVECTOR_TYPE || t == BOOLEAN_TYPE) && !cached &&
+          seen.insert(c).second)
+        next = c;
+      continue;
+    }
+
+    const ASTNode done = top.node;
+    todo.pop_back();
+    if (todo.empty())
+      break; // n is left to the caller.
+
+    if (done.GetType() == BITVECTOR_TYPE)
+      SimplifyTerm(done, VarConstMap);
+    else
+      SimplifyFormula(done, false, VarConstMap);
+  }
+
+  depth = saved;
+}
+
 // is it ITE(p,bv0[1], bv1[1])  OR  ITE(p,bv0[0], bv1[0])
 bool isPropositionToTerm(const ASTNode& n)
 {
@@ -88,7 +178,13 @@ bool Simplifier::CheckSimplifyMap(const ASTNode& key, ASTNode& output,
 {
   if (NULL != VarConstMap)
   {
-    return false;
+    ASTNodeMap::const_iterator it;
+    if (pushNeg || VarConstMap != varConstResultsMap ||
+        (it = varConstResults.find(key)) == varConstResults.end())
+      return false;
+
+    output = it->second;
+    return true;
   }
 
   if (!pushNeg && key.isSimplfied())
@@ -104,6 +200,7 @@ bool Simplifier::CheckSimplifyMap(const ASTNode& key, ASTNode& output,
   if (it != itend)
   {
     output = it->second;
+    cacheHits++;
     CountersAndStats("Successful_CheckSimplifyMap", _bm);
     return true;
   }
@@ -114,10 +211,12 @@ bool Simplifier::CheckSimplifyMap(const ASTNode& key, ASTNode& output,
                  ? ASTTrue
                  : (ASTTrue == it->second) ? ASTFalse
                                            : nf->CreateNode(NOT, it->second);
+    cacheHits++;
     CountersAndStats("2nd_Successful_CheckSimplifyMap", _bm);
     return true;
   }
 
+  cacheMisses++;
   return false;
 }
 
@@ -126,6 +225,13 @@ void Simplifier::UpdateSimplifyMap(const ASTNode& key, const ASTNode& value,
 {
   if (NULL != VarConstMap)
   {
+    // Kept only inside an outermost call, for its one map.
+    if (pushNeg || depth == 0 || 0 == key.Degree())
+      return;
+    if (varConstResultsMap == NULL)
+      varConstResultsMap = VarConstMap;
+    if (varConstResultsMap == VarConstMap)
+      varConstResults[key] = value;
     return;
   }
   assert(!value.IsNull());
@@ -326,6 +432,10 @@ ASTNode Simplifier::SimplifyFormula(const ASTNode& b, bool pushNeg,
   if (CheckSimplifyMap(b, output, pushNeg, VarConstMap))
     return output;
 
+  const Level counted(*this);
+  if (depth > maxSimplifyDepth)
+    simplifyBelow(b, VarConstMap);
+
   Kind kind = b.GetKind();
 
   ASTNode a = b;
@@ -1886,6 +1996,10 @@ ASTNode Simplifier::SimplifyTerm(const ASTNode& actualInputterm,
     // output << endl;
     return output;
   }
+
+  const Level counted(*this);
+  if (depth > maxSimplifyDepth)
+    simplifyBelow(inputterm, VarConstMap);
   //########################################
   //########################################
 
@@ -4105,4 +4219,17 @@ void Simplifier::printCacheStatus()
 
 }
 
+void Simplifier::recordCacheStatus()
+{
+  RunTimes* runTimes = _bm->GetRunTimes();
+  runTimes->addCounter("Simplify cache hits", cacheHits);
+  runTimes->addCounter("Simplify cache misses", cacheMisses);
+  runTimes->addCounter("Simplify cache entries",
+                       SimplifyMap->size() + SimplifyNegMap->size());
+  runTimes->addCounter("Substitution map entries",
+                       substitutionMap.Return_SolverMap()->size());
+  cacheHits = 0;
+  cacheMisses = 0;
+}
+
 } // end of namespace
@@ -101,7 +101,8 @@ void ToCNFAIG::dag_aware_aig_rewrite(
 
 void ToCNFAIG::toCNF(const BBNodeAIG& top, Cnf_Dat_t*& cnfData,
                      ToSATBase::ASTNodeToSATVar& nodeToVars, bool needAbsRef,
-                     BBNodeManagerAIG& mgr)
+                     BBNodeManagerAIG& mgr, Cnf_ClauseSink_t sink,
+                     void* sinkData)
 {
   assert(cnfData == NULL);
 
@@ -127,7 +128,10 @@ void ToCNFAIG::toCNF(const BBNodeAIG& top, Cnf_Dat_t*& cnfData,
 
   if (!uf.isSet("simple-cnf", "0"))
   {
-    cnfData = Cnf_Derive(mgr.aigMgr, 0);
+    if (sink != NULL)
+      cnfData = Cnf_DeriveStream(mgr.aigMgr, 0, sink, sinkData);
+    else
+      cnfData = Cnf_Derive(mgr.aigMgr, 0);
     if (uf.stats_flag)
       cerr << "advanced CNF" << endl;
   }
@@ -25,11 +25,36 @@ THE SOFTWARE.
 #include "stp/ToSat/AIG/ToSATAIG.h"
 #include "stp/Simplifier/constantBitP/ConstantBitPropagation.h"
 #include "stp/Simplifier/simplifier.h"
+#include "stp/Sat/SolverWatchdog.h"
+#include <memory>
 
 namespace stp
 {
 
-int ToSATAIG::cnf_calls = 0;
+thread_local int ToSATAIG::cnf_calls = 0;
+
+// The solvers' statistics are cumulative, so what a search did is the
+// difference from before it.
+struct SearchStats
+{
+  const uint64_t conflicts, decisions, propagations;
+
+  explicit SearchStats(const SATSolver& s)
+      : conflicts(s.nConflicts()), decisions(s.nDecisions()),
+        propagations(s.nPropagations())
+  {
+  }
+
+  void record(RunTimes* runTimes, const SATSolver& s) const
+  {
+    if (!runTimes->isProfiling())
+      return;
+    runTimes->addCounter("SAT conflicts", s.nConflicts() - conflicts);
+    runTimes->addCounter("SAT decisions", s.nDecisions() - decisions);
+    runTimes->addCounter("SAT propagations",
+                         s.nPropagations() - propagations);
+  }
+};
 
 bool ToSATAIG::CallSAT(SATSolver& satSolver, const ASTNode& input,
                        bool needAbsRef)
@@ -37,6 +62,9 @@ bool ToSATAIG::CallSAT(SATSolver& satSolver, const ASTNode& input,
   if (cb != NULL && cb->isUnsatisfiable())
     return false;
 
+  if (incremental)
+    return CallSATIncremental(satSolver, input);
+
   if (!first)
   {
     assert(input == ASTTrue);
@@ -53,11 +81,20 @@ bool ToSATAIG::CallSAT(SATSolver& satSolver, const ASTNode& input,
     return true;
 
   first = false;
-  Cnf_Dat_t* cnfData = bitblast(input, needAbsRef);
+  assert(satSolver.nVars() == 0);
+
+  // Unless the whole CNF is needed for writing out, the clauses go to the
+  // solver as they are derived.
+  const bool stream =
+      !bm->UserFlags.output_CNF_flag && !bm->UserFlags.exit_after_CNF;
+  Cnf_Dat_t* cnfData =
+      bitblast(input, needAbsRef, stream ? &satSolver : NULL);
+  if (cnfData == NULL)
+    return false; // Ran out of time.
   handle_cnf_options(cnfData, needAbsRef);
 
-  assert(satSolver.nVars() == 0);
-  add_cnf_to_solver(satSolver, cnfData);
+  if (cnfData->pClauses != NULL)
+    add_cnf_to_solver(satSolver, cnfData);
 
   if (bm->UserFlags.output_bench_flag) {
     cerr << "Converting to CNF via ABC's AIG package can't yet print out bench "
@@ -70,6 +107,235 @@ bool ToSATAIG::CallSAT(SATSolver& satSolver, const ASTNode& input,
   return runSolver(satSolver);
 }
 
+// Each conjunct of the input gets its own activation variable. The solver is
+// run with the activation variables of the current conjuncts assumed, so
+// that conjuncts from earlier queries that aren't asserted any more are
+// switched off, but the clauses the solver learnt from them are kept.
+bool ToSATAIG::CallSATIncremental(SATSolver& satSolver, const ASTNode& input)
+{
+  const ASTVec conjuncts =
+      (input.GetKind() == AND) ? input.GetChildren() : ASTVec(1, input);
+
+  SATSolver::vec_literals assumptions;
+  for (ASTVec::const_iterator it = conjuncts.begin(); it != conjuncts.end();
+       it++)
+  {
+    if (*it == ASTFalse)
+      return false;
+    if (*it == ASTTrue)
+      continue;
+
+    const uint32_t activationVar = getActivationVar(satSolver, *it);
+    if (bm->soft_timeout_expired)
+      return false;
+
+    assumptions.push(SATSolver::mkLit(activationVar, false));
+  }
+
+  if (bm->GetRunTimes()->isProfiling())
+  {
+    if (incrementalMgr != NULL)
+      bm->GetRunTimes()->addCounter("AIG nodes",
+                                    incrementalMgr->aigMgr->nObjs[AIG_OBJ_AND]);
+    bm->GetRunTimes()->addCounter("CNF variables", satSolver.nVars());
+  }
+
+  const SearchStats before(satSolver);
+  bm->GetRunTimes()->start(RunTimes::Solving);
+  bool result;
+  {
+    SolverWatchdog watchdog(satSolver, bm->timeoutRemaining());
+    result =
+        satSolver.solveWithAssumptions(bm->soft_timeout_expired, assumptions);
+  }
+  bm->GetRunTimes()->stop(RunTimes::Solving);
+  before.record(bm->GetRunTimes(), satSolver);
+
+  if (bm->UserFlags.stats_flag)
+    satSolver.printStats();
+
+  return result;
+}
+
+// Bit-blasts a conjunct that hasn't been seen before into the shared AIG, and
+// adds the clause (activation -> conjunct). The bit-blaster's memo tables
+// are kept, so only the parts of the conjunct that weren't in an earlier
+// conjunct produce new AIG nodes. Without constant bit propagation the
+// support that the bit-blaster conjoins to a formula is implied by the
+// formula's terms alone, so it doesn't matter which conjunct carries it.
+uint32_t ToSATAIG::getActivationVar(SATSolver& satSolver,
+                                    const ASTNode& conjunct)
+{
+  hash_map<ASTNode, uint32_t, ASTNode::ASTNodeHasher,
+           ASTNode::ASTNodeEqual>::const_iterator it = activation.find(conjunct);
+  if (it != activation.end())
+    return it->second;
+
+  if (incrementalBB == NULL)
+  {
+    incrementalSimp = new Simplifier(bm);
+    incrementalMgr = new BBNodeManagerAIG();
+    incrementalBB = new BitBlaster<BBNodeAIG, BBNodeManagerAIG>(
+        incrementalMgr, incrementalSimp, bm->defaultNodeFactory,
+        &bm->UserFlags);
+  }
+
+  bm->GetRunTimes()->start(RunTimes::BitBlasting);
+  const BBNodeAIG BBFormula = incrementalBB->BBForm(conjunct);
+  bm->GetRunTimes()->stop(RunTimes::BitBlasting);
+
+  if (bm->soft_timeout_expired)
+    return 0;
+
+  bm->GetRunTimes()->start(RunTimes::SendingToSAT);
+  map_new_symbols(satSolver);
+  const Minisat::Lit root = encode_aig(satSolver, BBFormula.n);
+
+  const uint32_t activationVar = satSolver.newVar();
+  satSolver.setFrozen(activationVar);
+
+  SATSolver::vec_literals clause;
+  clause.push(SATSolver::mkLit(activationVar, true));
+  clause.push(root);
+  satSolver.addClause(clause);
+  bm->GetRunTimes()->stop(RunTimes::SendingToSAT);
+
+  activation.insert(std::make_pair(conjunct, activationVar));
+  return activationVar;
+}
+
+// Gives a SAT variable to the primary inputs created since the last call.
+// Each primary input is a bit of a symbol, which keeps the same SAT
+// variable for as long as this object lives.
+void ToSATAIG::map_new_symbols(SATSolver& satSolver)
+{
+  Aig_Man_t* aigMgr = incrementalMgr->aigMgr;
+  if (Aig_ManPiNum(aigMgr) == mappedPis)
+    return;
+
+  aigToSATVar.resize(Aig_ManObjNumMax(aigMgr), ~((unsigned)0));
+
+  for (BBNodeManagerAIG::SymbolToBBNode::const_iterator it =
+           incrementalMgr->symbolToBBNode.begin();
+       it != incrementalMgr->symbolToBBNode.end(); it++)
+  {
+    const vector<BBNodeAIG>& b = it->second;
+    vector<unsigned>& v = nodeToSATVar[it->first];
+    if (v.size() == 0)
+      v.resize(b.size(), ~((unsigned)0));
+
+    for (unsigned i = 0; i < b.size(); i++)
+    {
+      if (b[i].IsNull() || b[i].symbol_index < mappedPis)
+        continue;
+
+      if (v[i] == ~((unsigned)0))
+      {
+        v[i] = satSolver.newVar();
+        satSolver.setFrozen(v[i]);
+      }
+      aigToSATVar[Aig_ManPi(aigMgr, b[i].symbol_index)->Id] = v[i];
+    }
+  }
+  mappedPis = Aig_ManPiNum(aigMgr);
+}
+
+// Tseitin encodes the AIG nodes below root that don't have a SAT variable
+// yet. The clauses define each node's variable, so they hold whichever
+// conjuncts are asserted, and aren't guarded by an activation variable.
+Minisat::Lit ToSATAIG::encode_aig(SATSolver& satSolver, Aig_Obj_t* root)
+{
+  Aig_Man_t* aigMgr = incrementalMgr->aigMgr;
+  const unsigned unmapped = ~((unsigned)0);
+  aigToSATVar.resize(Aig_ManObjNumMax(aigMgr), unmapped);
+
+  SATSolver::vec_literals clause;
+  vector<Aig_Obj_t*> stack;
+  stack.push_back(Aig_Regular(root));
+
+  while (!stack.empty())
+  {
+    Aig_Obj_t* n = stack.back();
+    if (aigToSATVar[n->Id] != unmapped)
+    {
+      stack.pop_back();
+      continue;
+    }
+
+    if (Aig_ObjIsConst1(n))
+    {
+      const uint32_t v = satSolver.newVar();
+      satSolver.setFrozen(v);
+      clause.clear();
+      clause.push(SATSolver::mkLit(v, false));
+      satSolver.addClause(clause);
+      aigToSATVar[n->Id] = v;
+      stack.pop_back();
+      continue;
+    }
+
+    // Primary inputs were mapped by map_new_symbols().
+    assert(Aig_ObjIsAnd(n));
+
+    Aig_Obj_t* f0 = Aig_ObjFanin0(n);
+    Aig_Obj_t* f1 = Aig_ObjFanin1(n);
+    if (aigToSATVar[f0->Id] == unmapped || aigToSATVar[f1->Id] == unmapped)
+    {
+      if (aigToSATVar[f0->Id] == unmapped)
+        stack.push_back(f0);
+      if (aigToSATVar[f1->Id] == unmapped)
+        stack.push_back(f1);
+      continue;
+    }
+    stack.pop_back();
+
+    const uint32_t v = satSolver.newVar();
+    satSolver.setFrozen(v);
+    aigToSATVar[n->Id] = v;
+
+    const Minisat::Lit l0 =
+        SATSolver::mkLit(aigToSATVar[f0->Id], Aig_ObjFaninC0(n));
+    const Minisat::Lit l1 =
+        SATSolver::mkLit(aigToSATVar[f1->Id], Aig_ObjFaninC1(n));
+
+    // v <-> (l0 & l1)
+    clause.clear();
+    clause.push(SATSolver::mkLit(v, true));
+    clause.push(l0);
+    satSolver.addClause(clause);
+
+    clause.clear();
+    clause.push(SATSolver::mkLit(v, true));
+    clause.push(l1);
+    satSolver.addClause(clause);
+
+    clause.clear();
+    clause.push(SATSolver::mkLit(v, false));
+    clause.push(~l0);
+    clause.push(~l1);
+    satSolver.addClause(clause);
+  }
+
+  return SATSolver::mkLit(aigToSATVar[Aig_Regular(root)->Id],
+                          Aig_IsComplement(root));
+}
+
+void ToSATAIG::clear_incremental()
+{
+  activation.clear();
+  aigToSATVar.clear();
+  mappedPis = 0;
+
+  delete incrementalBB;
+  incrementalBB = NULL;
+
+  delete incrementalMgr;
+  incrementalMgr = NULL;
+
+  delete incrementalSimp;
+  incrementalSimp = NULL;
+}
+
 void ToSATAIG::release_cnf_memory(Cnf_Dat_t* cnfData)
 {
   // This releases the memory used by the CNF generator, particularly some data
@@ -108,27 +374,90 @@ void ToSATAIG::handle_cnf_options(Cnf_Dat_t* cnfData, bool needAbsRef)
   }
 }
 
-Cnf_Dat_t* ToSATAIG::bitblast(const ASTNode& input, bool needAbsRef)
+// Where ABC sends the clauses when they are streamed.
+struct ClauseStream
 {
-  Simplifier simp(bm);
+  SATSolver* solver;
+  RunTimes* runTimes;
+};
 
-  BBNodeManagerAIG mgr;
-  BitBlaster<BBNodeAIG, BBNodeManagerAIG> bb(
-      &mgr, &simp, bm->defaultNodeFactory, &bm->UserFlags, cb);
+static void stream_clauses(void* data, int nVars, int* lits, int* begins,
+                           int nClauses)
+{
+  ClauseStream* cs = (ClauseStream*)data;
+  cs->runTimes->start(RunTimes::SendingToSAT);
 
-  bm->GetRunTimes()->start(RunTimes::BitBlasting);
-  BBNodeAIG BBFormula = bb.BBForm(input);
-  bm->GetRunTimes()->stop(RunTimes::BitBlasting);
+  while ((int)cs->solver->nVars() < nVars)
+    cs->solver->newVar();
+
+  if (cs->solver->okay())
+    cs->solver->addClauses(lits, begins, nClauses);
+
+  cs->runTimes->stop(RunTimes::SendingToSAT);
+}
+
+Cnf_Dat_t* ToSATAIG::bitblast(const ASTNode& input, bool needAbsRef,
+                              SATSolver* stream)
+{
+  std::auto_ptr<BBNodeManagerAIG> owner;
+  BBNodeAIG BBFormula;
+  const bool reused = bitBlastedMgr != NULL && bitBlastedInput == input;
+  if (reused)
+  {
+    owner.reset(bitBlastedMgr);
+    BBFormula = bitBlastedRoot;
+  }
+  else
+  {
+    delete bitBlastedMgr;
+    owner.reset(new BBNodeManagerAIG());
+    Simplifier simp(bm);
+    BitBlaster<BBNodeAIG, BBNodeManagerAIG> bb(
+        owner.get(), &simp, bm->defaultNodeFactory, &bm->UserFlags, cb);
+
+    bm->GetRunTimes()->start(RunTimes::BitBlasting);
+    BBFormula = bb.BBForm(input);
+    bm->GetRunTimes()->stop(RunTimes::BitBlasting);
+  }
+  bitBlastedMgr = NULL;
+  bitBlastedRoot = BBNodeAIG();
+  bitBlastedInput = ASTNode();
+  BBNodeManagerAIG& mgr = *owner;
+
+  const bool profiling = bm->GetRunTimes()->isProfiling();
+  if (profiling)
+  {
+    bm->GetRunTimes()->addCounter("AIG nodes",
+                                  mgr.aigMgr->nObjs[AIG_OBJ_AND]);
+    if (reused)
+      bm->GetRunTimes()->addCounter("Bit-blasts reused");
+  }
 
   delete cb;
   cb = NULL;
-  bb.cb = NULL;
+
+  if (bm->soft_timeout_expired)
+    return NULL;
 
   bm->GetRunTimes()->start(RunTimes::CNFConversion);
   Cnf_Dat_t* cnfData = NULL;
-  toCNF.toCNF(BBFormula, cnfData, nodeToSATVar, needAbsRef, mgr);
+  ClauseStream cs;
+  cs.solver = stream;
+  cs.runTimes = bm->GetRunTimes();
+  toCNF.toCNF(BBFormula, cnfData, nodeToSATVar, needAbsRef, mgr,
+              (stream != NULL) ? stream_clauses : NULL, &cs);
   bm->GetRunTimes()->stop(RunTimes::CNFConversion);
 
+  if (profiling)
+  {
+    RunTimes* runTimes = bm->GetRunTimes();
+    runTimes->addCounter("AIG nodes after rewriting",
+                         mgr.aigMgr->nObjs[AIG_OBJ_AND]);
+    runTimes->addCounter("CNF variables", cnfData->nVars);
+    runTimes->addCounter("CNF clauses", cnfData->nClauses);
+    runTimes->addCounter("CNF literals", cnfData->nLiterals);
+  }
+
   // Free the memory in the AIGs.
   BBFormula = BBNodeAIG(); // null node
   mgr.stop();
@@ -198,9 +527,14 @@ void ToSATAIG::mark_variables_as_frozen(SATSolver& satSolver)
 
 bool ToSATAIG::runSolver(SATSolver& satSolver)
 {
+  const SearchStats before(satSolver);
   bm->GetRunTimes()->start(RunTimes::Solving);
-  satSolver.solve(bm->soft_timeout_expired);
+  {
+    SolverWatchdog watchdog(satSolver, bm->timeoutRemaining());
+    satSolver.solve(bm->soft_timeout_expired);
+  }
   bm->GetRunTimes()->stop(RunTimes::Solving);
+  before.record(bm->GetRunTimes(), satSolver);
 
   if (bm->UserFlags.stats_flag)
     satSolver.printStats();
@@ -208,8 +542,18 @@ bool ToSATAIG::runSolver(SATSolver& satSolver)
   return satSolver.okay();
 }
 
+void ToSATAIG::useBitBlasted(const ASTNode& input, BBNodeManagerAIG* mgr,
+                             const BBNodeAIG& root)
+{
+  delete bitBlastedMgr;
+  bitBlastedInput = input;
+  bitBlastedMgr = mgr;
+  bitBlastedRoot = root;
+}
+
 ToSATAIG::~ToSATAIG()
 {
   ClearAllTables();
+  delete bitBlastedMgr;
 }
 }
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "stp/STPManager/UserDefinedFlags.h"
 #include "stp/ToSat/ASTNode/ClauseList.h"
 #include "stp/ToSat/ASTNode/ASTtoCNF.h"
+#include "stp/Sat/SolverWatchdog.h"
 
 namespace stp
 {
@@ -151,7 +152,10 @@ bool ToSAT::toSATandSolve(SATSolver& newSolver, ClauseList& cll, bool final,
 
   bm->GetRunTimes()->stop(RunTimes::SendingToSAT);
   bm->GetRunTimes()->start(RunTimes::Solving);
-  newSolver.solve(bm->soft_timeout_expired);
+  {
+    SolverWatchdog watchdog(newSolver, bm->timeoutRemaining());
+    newSolver.solve(bm->soft_timeout_expired);
+  }
   bm->GetRunTimes()->stop(RunTimes::Solving);
   if (bm->UserFlags.stats_flag)
     newSolver.printStats();
@@ -315,6 +319,9 @@ bool ToSAT::CallSAT(SATSolver& SatSolver, const ASTNode& input, bool refinement)
   bm->ASTNodeStats("after bitblasting: ", BBFormula);
   bm->GetRunTimes()->stop(RunTimes::BitBlasting);
 
+  if (bm->soft_timeout_expired)
+    return false;
+
   if (bm->UserFlags.output_bench_flag)
   {
     std::ofstream file;
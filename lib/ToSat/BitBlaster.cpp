@@ -58,8 +58,6 @@ using simplifier::constantBitP::NodeToFixedBitsMap;
 using std::make_pair;
 
 #define BBNodeVec std::vector<BBNode>
-#define BBNodeVecMap std::map<ASTNode, vector<BBNode>>
-#define BBNodeSet std::set<BBNode>
 
 vector<BBNodeAIG> _empty_BBNodeAIGVec;
 
@@ -122,7 +120,7 @@ void BitBlaster<BBNode, BBNodeManagerT>::getConsts(const ASTNode& form,
   assert(support.size() == 0);
 
   {
-    typename std::map<ASTNode, BBNode>::iterator it;
+    typename BBFormMemoMap::iterator it;
     for (it = BBFormMemo.begin(); it != BBFormMemo.end(); it++)
     {
       const ASTNode& n = it->first;
@@ -148,7 +146,7 @@ void BitBlaster<BBNode, BBNodeManagerT>::getConsts(const ASTNode& form,
     }
   }
 
-  typename BBNodeVecMap::iterator it;
+  typename BBTermMemoMap::iterator it;
   for (it = BBTermMemo.begin(); it != BBTermMemo.end(); it++)
   {
     const ASTNode& n = it->first;
@@ -189,7 +187,7 @@ void BitBlaster<BBNode, BBNodeManagerT>::getConsts(const ASTNode& form,
   if (form.GetSTPMgr()->UserFlags.isSet("bb-equiv", "1"))
   {
     hash_map<intptr_t, ASTNode> nodeToFn;
-    typename std::map<ASTNode, BBNode>::iterator it;
+    typename BBFormMemoMap::iterator it;
     for (it = BBFormMemo.begin(); it != BBFormMemo.end(); it++)
     {
       const ASTNode& n = it->first;
@@ -227,7 +225,7 @@ void BitBlaster<BBNode, BBNodeManagerT>::getConsts(const ASTNode& form,
   if (form.GetSTPMgr()->UserFlags.isSet("bb-equiv", "1"))
   {
     M lookup;
-    typename std::map<ASTNode, vector<BBNode>>::iterator it;
+    typename BBTermMemoMap::iterator it;
     for (it = BBTermMemo.begin(); it != BBTermMemo.end(); it++)
     {
       const ASTNode& n = it->first;
@@ -484,13 +482,92 @@ ASTNode BitBlaster<BBNode, BBNodeManagerT>::getConstant(const BBNodeVec& v,
   return ASTNF->CreateConstant(bv, v.size());
 }
 
+// Once the query's time limit has passed, the rest of the bit-blasting is
+// skipped. The results are then meaningless, so callers need to check
+// soft_timeout_expired before using them.
 template <class BBNode, class BBNodeManagerT>
-const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
-                                                           BBNodeSet& support)
+bool BitBlaster<BBNode, BBNodeManagerT>::timedOut(const ASTNode& n)
+{
+  STPMgr* bm = n.GetSTPMgr();
+  if (bm->soft_timeout_expired)
+    return true;
+
+  if (++sinceTimeoutCheck < 1024)
+    return false;
+
+  sinceTimeoutCheck = 0;
+  return bm->checkTimeout();
+}
+
+// Past this depth of recursion, the nodes below are bit-blasted bottom up
+// first, so that long chains don't overflow the stack. Those nodes are then
+// blasted before any constant bits their ancestors would have pushed down,
+// so on deep formulas the circuit can differ from the one the recursion
+// alone builds. It's equisatisfiable, but not necessarily the same.
+const unsigned maxBBDepth = 500;
+
+namespace
+{
+// Counts a level of recursion while it's in scope.
+struct DepthCount
+{
+  unsigned& depth;
+  explicit DepthCount(unsigned& d) : depth(d) { depth++; }
+  ~DepthCount() { depth--; }
+};
+}
+
+// Bit-blasts the nodes below n, children before parents, using an explicit
+// stack. When the recursion carries on from n it finds them memoised, so it
+// goes no deeper.
+template <class BBNode, class BBNodeManagerT>
+void BitBlaster<BBNode, BBNodeManagerT>::bitblastBelow(const ASTNode& n,
+                                                       BBNodeSet& support)
+{
+  const unsigned saved = depth;
+  depth = 0;
+
+  vector<std::pair<ASTNode, size_t>> todo;
+  ASTNodeSet seen;
+  todo.push_back(make_pair(n, (size_t)0));
+
+  while (!todo.empty())
+  {
+    const ASTNode node = todo.back().first;
+    const size_t i = todo.back().second++;
+    if (i < node.Degree())
+    {
+      const ASTNode& c = node[i];
+      const bool memoised = (c.GetType() == BITVECTOR_TYPE)
+                                ? BBTermMemo.find(c) != BBTermMemo.end()
+                                : BBFormMemo.find(c) != BBFormMemo.end();
+      if (!c.isConstant() && c.GetType() != ARRAY_TYPE && !memoised &&
+          seen.insert(c).second)
+        todo.push_back(make_pair(c, (size_t)0));
+      continue;
+    }
+
+    todo.pop_back();
+    if (todo.empty())
+      break; // n is left to the caller.
+
+    if (node.GetType() == BITVECTOR_TYPE)
+      BBTerm(node, support);
+    else
+      BBForm(node, support);
+  }
+
+  depth = saved;
+}
+
+template <class BBNode, class BBNodeManagerT>
+const BBNodeVec&
+BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
+                                           BBNodeSet& support)
 {
   ASTNode term = _term; // mutable local copy.
 
-  typename BBNodeVecMap::iterator it = BBTermMemo.find(term);
+  typename BBTermMemoMap::iterator it = BBTermMemo.find(term);
   if (it != BBTermMemo.end())
   {
     // Constant bit propagation may have updated something.
@@ -498,6 +575,13 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
     return it->second;
   }
 
+  if (timedOut(term))
+    return (BBTermMemo[term] = BBfill(term.GetValueWidth(), BBFalse));
+
+  const DepthCount counted(depth);
+  if (depth > maxBBDepth)
+    bitblastBelow(term, support);
+
   // This block checks if the bitblasting/fixed bits have discovered
   // any new constants. If they've discovered a new constant, then
   // the simplification function is called on a new term with the constant
@@ -510,20 +594,24 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
   if (uf != NULL && uf->optimize_flag && uf->simplify_during_BB_flag)
   {
     const int numberOfChildren = term.Degree();
-    vector<BBNodeVec> ch;
+    vector<const BBNodeVec*> ch;
     ch.reserve(numberOfChildren);
 
+    // The terms point into the memo table. The formulas are held here, it's
+    // reserved so that they don't move.
+    vector<BBNodeVec> forms;
+    forms.reserve(numberOfChildren);
+
     for (int i = 0; i < numberOfChildren; i++)
     {
       if (term[i].GetType() == BITVECTOR_TYPE)
       {
-        ch.push_back(BBTerm(term[i], support));
+        ch.push_back(&BBTerm(term[i], support));
       }
       else if (term[i].GetType() == BOOLEAN_TYPE)
       {
-        BBNodeVec t;
-        t.push_back(BBForm(term[i], support));
-        ch.push_back(t);
+        forms.push_back(BBNodeVec(1, BBForm(term[i], support)));
+        ch.push_back(&forms.back());
       }
       else
         throw "sdfssfa";
@@ -535,7 +623,7 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
       if (term[i].isConstant())
         continue;
 
-      if (isConstant(ch[i]))
+      if (isConstant(*ch[i]))
       {
         // it's only interesting if the child isn't a constant,
         // but the bitblasted version is.
@@ -551,8 +639,8 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
       new_ch.reserve(numberOfChildren);
       for (int i = 0; i < numberOfChildren; i++)
       {
-        if (!term[i].isConstant() && isConstant(ch[i]))
-          new_ch.push_back(getConstant(ch[i], term[i]));
+        if (!term[i].isConstant() && isConstant(*ch[i]))
+          new_ch.push_back(getConstant(*ch[i], term[i]));
         else
           new_ch.push_back(term[i]);
       }
@@ -623,7 +711,7 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
       {
         // Constant bit propagation may have updated something.
         updateTerm(term, it->second, support);
-        return it->second;
+        return (BBTermMemo[_term] = it->second);
       }
     }
   }
@@ -804,9 +892,9 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
       const BBNodeVec& vec1 = BBTerm(term[0], support);
       const BBNodeVec& vec2 = BBTerm(term[1], support);
 
-      BBNodeVec tmp_res(vec2);
-      tmp_res.insert(tmp_res.end(), vec1.begin(), vec1.end());
-      result = tmp_res;
+      result.reserve(vec1.size() + vec2.size());
+      result.insert(result.end(), vec2.begin(), vec2.end());
+      result.insert(result.end(), vec1.begin(), vec1.end());
       break;
     }
     case BVPLUS:
@@ -825,7 +913,7 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
           BBPlus2(tmp_res, tmp, nf->getFalse());
         }
 
-        result = tmp_res;
+        result.swap(tmp_res);
       }
       else
       {
@@ -956,15 +1044,12 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
 
       // Sum is destructively modified in the loop, so make a copy of value
       // returned by BBTerm.
-      BBNodeVec temp = BBTerm(*it, support);
-      BBNodeVec sum(temp); // First operand.
+      BBNodeVec sum(BBTerm(*it, support)); // First operand.
 
       // Iterate over remaining bitvector term operands
       for (++it; it < kids_end; it++)
       {
-        // FIXME FIXME FIXME: Why does using a temp. var change the behavior?
-        temp = BBTerm(*it, support);
-        const BBNodeVec& y = temp;
+        const BBNodeVec& y = BBTerm(*it, support);
 
         assert(y.size() == num_bits);
         for (unsigned i = 0; i < num_bits; i++)
@@ -972,7 +1057,7 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
           sum[i] = nf->CreateNode(bk, sum[i], y[i]);
         }
       }
-      result = sum;
+      result.swap(sum);
       break;
     }
     case SYMBOL:
@@ -1012,6 +1097,11 @@ const BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::BBTerm(const ASTNode& _term,
     check(result, term);
 
   updateTerm(term, result, support);
+
+  // Memoised under the original term too, which is what callers, and
+  // bitblastBelow(), look up.
+  if (term != _term)
+    BBTermMemo[_term] = result;
   return (BBTermMemo[term] = result);
 }
 
@@ -1033,8 +1123,16 @@ const BBNode BitBlaster<BBNode, BBNodeManagerT>::BBForm(const ASTNode& form)
   BBNodeSet support;
   BBNode r = BBForm(form, support);
 
-  vector<BBNode> v;
-  v.insert(v.end(), support.begin(), support.end());
+  // Nodes bit-blasted after the time limit passed have been memoised with
+  // placeholder values. Forget them, so that a later call on the same
+  // bit-blaster doesn't reuse them.
+  if (form.GetSTPMgr()->soft_timeout_expired)
+  {
+    ClearAllTables();
+    return BBFalse;
+  }
+
+  vector<BBNode> v(support.get());
   v.push_back(r);
 
   if (!conjoin_to_top)
@@ -1058,13 +1156,20 @@ template <class BBNode, class BBNodeManagerT>
 const BBNode BitBlaster<BBNode, BBNodeManagerT>::BBForm(const ASTNode& form,
                                                         BBNodeSet& support)
 {
-  typename std::map<ASTNode, BBNode>::iterator it = BBFormMemo.find(form);
+  typename BBFormMemoMap::iterator it = BBFormMemo.find(form);
   if (it != BBFormMemo.end())
   {
     // already there.  Just return it.
     return it->second;
   }
 
+  if (timedOut(form))
+    return BBFalse;
+
+  const DepthCount counted(depth);
+  if (depth > maxBBDepth)
+    bitblastBelow(form, support);
+
   BBNode result;
 
   const Kind k = form.GetKind();
@@ -1101,7 +1206,7 @@ const BBNode BitBlaster<BBNode, BBNodeManagerT>::BBForm(const ASTNode& form,
     case BOOLEXTRACT:
     {
       // exactly two children
-      const BBNodeVec bbchild = BBTerm(form[0], support);
+      const BBNodeVec& bbchild = BBTerm(form[0], support);
       unsigned int index = form[1].GetUnsignedConst();
       result = bbchild[index];
       break;
@@ -1138,8 +1243,8 @@ const BBNode BitBlaster<BBNode, BBNodeManagerT>::BBForm(const ASTNode& form,
 
     case EQ:
     {
-      const BBNodeVec left = BBTerm(form[0], support);
-      const BBNodeVec right = BBTerm(form[1], support);
+      const BBNodeVec& left = BBTerm(form[0], support);
+      const BBNodeVec& right = BBTerm(form[1], support);
       assert(left.size() == right.size());
 
       result = BBEQ(left, right);
@@ -1415,7 +1520,7 @@ const bool debug_multiply = false;
 
 template <class BBNode, class BBNodeManagerT>
 BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::buildAdditionNetworkResult(
-    vector<list<BBNode>>& products, set<BBNode>& support, const ASTNode& n)
+    vector<list<BBNode>>& products, BBNodeSet& support, const ASTNode& n)
 {
   const int bitWidth = n.GetValueWidth();
 
@@ -1448,7 +1553,7 @@ BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::buildAdditionNetworkResult(
 
 template <class BBNode, class BBNodeManagerT>
 void BitBlaster<BBNode, BBNodeManagerT>::buildAdditionNetworkResult(
-    list<BBNode>& from, list<BBNode>& to, set<BBNode>& support,
+    list<BBNode>& from, list<BBNode>& to, BBNodeSet& support,
     const bool at_end, const bool all_false)
 {
 
@@ -1921,7 +2026,7 @@ void BitBlaster<BBNode, BBNodeManagerT>::checkFixed(const BBNodeVec& v,
 // turned on, and upper_multiplication_bound must be set.
 template <class BBNode, class BBNodeManagerT>
 void BitBlaster<BBNode, BBNodeManagerT>::setColumnsToZero(
-    vector<list<BBNode>>& products, set<BBNode>& support, const ASTNode& n)
+    vector<list<BBNode>>& products, BBNodeSet& support, const ASTNode& n)
 {
   const int bitWidth = n.GetValueWidth();
 
@@ -2149,7 +2254,7 @@ void BitBlaster<BBNode, BBNodeManagerT>::sortingNetworkAdd(
 
 template <class BBNode, class BBNodeManagerT>
 BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::v6(vector<list<BBNode>>& products,
-                                                 set<BBNode>& support,
+                                                 BBNodeSet& support,
                                                  const ASTNode& n)
 {
   const int bitWidth = n.GetValueWidth();
@@ -2171,7 +2276,7 @@ BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::v6(vector<list<BBNode>>& products,
 template <class BBNode, class BBNodeManagerT>
 BBNodeVec
 BitBlaster<BBNode, BBNodeManagerT>::v13(vector<list<BBNode>>& products,
-                                        set<BBNode>& support, const ASTNode& n)
+                                        BBNodeSet& support, const ASTNode& n)
 {
   const int bitWidth = n.GetValueWidth();
 
@@ -2247,7 +2352,7 @@ BitBlaster<BBNode, BBNodeManagerT>::v13(vector<list<BBNode>>& products,
 // column+1, and column+2.
 template <class BBNode, class BBNodeManagerT>
 BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::v9(vector<list<BBNode>>& products,
-                                                 set<BBNode>& support,
+                                                 BBNodeSet& support,
                                                  const ASTNode& n)
 {
   const int bitWidth = n.GetValueWidth();
@@ -2322,7 +2427,7 @@ BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::v9(vector<list<BBNode>>& products,
 
 template <class BBNode, class BBNodeManagerT>
 BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::v7(vector<list<BBNode>>& products,
-                                                 set<BBNode>& support,
+                                                 BBNodeSet& support,
                                                  const ASTNode& n)
 {
   const int bitWidth = n.GetValueWidth();
@@ -2392,7 +2497,7 @@ BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::v7(vector<list<BBNode>>& products,
 
 template <class BBNode, class BBNodeManagerT>
 BBNodeVec BitBlaster<BBNode, BBNodeManagerT>::v8(vector<list<BBNode>>& products,
-                                                 set<BBNode>& support,
+                                                 BBNodeSet& support,
                                                  const ASTNode& n)
 {
   const int bitWidth = n.GetValueWidth();
@@ -2958,7 +3063,5 @@ template class BitBlaster<ASTNode, BBNodeManagerASTNode>;
 template class BitBlaster<BBNodeAIG, BBNodeManagerAIG>;
 
 #undef BBNodeVec
-#undef BBNodeVecMap
-#undef BBNodeSet
 
 } // stp namespace
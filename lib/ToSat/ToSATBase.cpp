@@ -35,7 +35,8 @@ void ToSATBase::PrintOutput(SOLVER_RETURN_TYPE ret)
 {
   if (ret == SOLVER_TIMEOUT || ret == SOLVER_UNDECIDED)
   {
-    cout << "Timed Out." << endl;
+    if (bm->UserFlags.print_output_flag)
+      cout << "Timed Out." << endl;
     return;
   }
 
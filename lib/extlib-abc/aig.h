@@ -171,6 +171,14 @@ struct Aig_Man_t_
 #define AIG_ABS(a)         (((a) >= 0)?  (a) :-(a))
 #define AIG_INFINITY       (100000000)
 
+// the global tables are kept per thread, so that AIG managers
+// can be used on different threads at the same time
+#ifdef _MSC_VER
+#define AIG_THREAD_LOCAL   __declspec(thread)
+#else
+#define AIG_THREAD_LOCAL   __thread
+#endif
+
 #ifndef PRT
 #define PRT(a,t)  printf("%s = ", (a)); printf("%6.2f sec\n", (float)(t)/(float)(CLOCKS_PER_SEC))
 #endif
@@ -42,7 +42,7 @@ SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 ///                        DECLARATIONS                              ///
 ////////////////////////////////////////////////////////////////////////
 
-static Cnf_Man_t * s_pManCnf = NULL;
+static AIG_THREAD_LOCAL Cnf_Man_t * s_pManCnf = NULL;
 
 ////////////////////////////////////////////////////////////////////////
 ///                     FUNCTION DEFINITIONS                         ///
@@ -52,14 +52,15 @@ static Cnf_Man_t * s_pManCnf = NULL;
 
   Synopsis    [Converts AIG into the SAT solver.]
 
-  Description []
+  Description [If pSink is given, the clauses are handed to it in
+  chunks as they are written, and the returned CNF has no clauses.]
                
   SideEffects []
 
   SeeAlso     []
 
 ***********************************************************************/
-Cnf_Dat_t * Cnf_Derive( Aig_Man_t * pAig, int nOutputs )
+static Cnf_Dat_t * Cnf_DeriveInt( Aig_Man_t * pAig, int nOutputs, Cnf_ClauseSink_t pSink, void * pUser )
 {
     Cnf_Man_t * p;
     Cnf_Dat_t * pCnf;
@@ -88,7 +89,10 @@ p->timeMap = clock() - clk;
 clk = clock();
     Cnf_ManTransferCuts( p );
     vMapped = Cnf_ManScanMapping( p, 1, 1 );
-    pCnf = Cnf_ManWriteCnf( p, vMapped, nOutputs );
+    if ( pSink )
+        pCnf = Cnf_ManWriteCnfStream( p, vMapped, nOutputs, pSink, pUser );
+    else
+        pCnf = Cnf_ManWriteCnf( p, vMapped, nOutputs );
     Vec_PtrFree( vMapped );
     Aig_MmFixedStop( pMemCuts, 0 );
 p->timeSave = clock() - clk;
@@ -101,6 +105,41 @@ p->timeSave = clock() - clk;
     return pCnf;
 }
 
+/**Function*************************************************************
+
+  Synopsis    [Converts AIG into the SAT solver.]
+
+  Description []
+               
+  SideEffects []
+
+  SeeAlso     []
+
+***********************************************************************/
+Cnf_Dat_t * Cnf_Derive( Aig_Man_t * pAig, int nOutputs )
+{
+    return Cnf_DeriveInt( pAig, nOutputs, NULL, NULL );
+}
+
+/**Function*************************************************************
+
+  Synopsis    [Converts AIG into CNF without keeping the clauses.]
+
+  Description [The clauses go to pSink in bounded chunks, so the whole
+  CNF never exists at once. The returned CNF has the variable numbers
+  and counts, but no clauses.]
+               
+  SideEffects []
+
+  SeeAlso     []
+
+***********************************************************************/
+Cnf_Dat_t * Cnf_DeriveStream( Aig_Man_t * pAig, int nOutputs, Cnf_ClauseSink_t pSink, void * pUser )
+{
+    assert( pSink != NULL );
+    return Cnf_DeriveInt( pAig, nOutputs, pSink, pUser );
+}
+
 /**Function*************************************************************
 
   Synopsis    []
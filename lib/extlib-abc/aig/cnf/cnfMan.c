@@ -140,8 +140,11 @@ void Cnf_DataFree( Cnf_Dat_t * p )
 {
     if ( p == NULL )
         return;
-    free( p->pClauses[0] );
-    free( p->pClauses );
+    if ( p->pClauses )
+    {
+        free( p->pClauses[0] );
+        free( p->pClauses );
+    }
     free( p->pVarNums );
     free( p );
 }
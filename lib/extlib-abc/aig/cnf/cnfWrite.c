@@ -336,6 +336,203 @@ Cnf_Dat_t * Cnf_ManWriteCnf( Cnf_Man_t * p, Vec_Ptr_t * vMapped, int nOutputs )
     return pCnf;
 }
 
+// the number of literals buffered before they are handed to the sink
+#define CNF_STREAM_LITS   (1 << 16)
+// no clause is longer than this (one output plus the cut leaves)
+#define CNF_STREAM_CLAUSE 64
+
+typedef struct Cnf_Stream_t_ Cnf_Stream_t;
+struct Cnf_Stream_t_
+{
+    Cnf_ClauseSink_t pSink;
+    void *           pUser;
+    int              nVars;
+    int *            pLits;           // the literals of the buffered clauses
+    int *            pBegins;         // where each buffered clause starts
+    int              nLits;
+    int              nClauses;
+    int              nLitsAll;        // the totals handed to the sink
+    int              nClausesAll;
+};
+
+static void Cnf_StreamFlush( Cnf_Stream_t * s )
+{
+    if ( s->nClauses == 0 )
+        return;
+    s->pBegins[s->nClauses] = s->nLits;
+    s->pSink( s->pUser, s->nVars, s->pLits, s->pBegins, s->nClauses );
+    s->nLitsAll += s->nLits;
+    s->nClausesAll += s->nClauses;
+    s->nLits = 0;
+    s->nClauses = 0;
+}
+
+// returns where to write the literals of the next clause
+static int * Cnf_StreamBegin( Cnf_Stream_t * s )
+{
+    if ( s->nLits + CNF_STREAM_CLAUSE > CNF_STREAM_LITS )
+        Cnf_StreamFlush( s );
+    s->pBegins[s->nClauses++] = s->nLits;
+    return s->pLits + s->nLits;
+}
+
+static void Cnf_StreamEnd( Cnf_Stream_t * s, int * pEnd )
+{
+    s->nLits = pEnd - s->pLits;
+    assert( s->nLits - s->pBegins[s->nClauses-1] <= CNF_STREAM_CLAUSE );
+}
+
+/**Function*************************************************************
+
+  Synopsis    [Derives CNF for the mapping, handing the clauses to a sink.]
+
+  Description [Writes the same clauses as Cnf_ManWriteCnf(), in the same
+  order, but only ever buffers a bounded number of them. The returned
+  CNF holds the variable numbers and the clause and literal counts, but
+  pClauses is NULL.]
+               
+  SideEffects []
+
+  SeeAlso     []
+
+***********************************************************************/
+Cnf_Dat_t * Cnf_ManWriteCnfStream( Cnf_Man_t * p, Vec_Ptr_t * vMapped, int nOutputs, Cnf_ClauseSink_t pSink, void * pUser )
+{
+    Aig_Obj_t * pObj;
+    Cnf_Dat_t * pCnf;
+    Cnf_Cut_t * pCut;
+    Cnf_Stream_t Stream, * s = &Stream;
+    Vec_Int_t * vCover, * vSopTemp;
+    int OutVar, PoVar, pVars[32], * pLits;
+    unsigned uTruth;
+    int i, k, Cube, Number;
+
+    // allocate CNF without the clauses
+    pCnf = ALLOC( Cnf_Dat_t, 1 );
+    memset( pCnf, 0, sizeof(Cnf_Dat_t) );
+
+    // create room for variable numbers
+    pCnf->pVarNums = ALLOC( int, Aig_ManObjNumMax(p->pManAig) );
+    memset( pCnf->pVarNums, 0xff, sizeof(int) * Aig_ManObjNumMax(p->pManAig) );
+    // assign variables to the last (nOutputs) POs
+    Number = 1;
+    if ( nOutputs )
+    {
+        assert( nOutputs == Aig_ManRegNum(p->pManAig) );
+        Aig_ManForEachLiSeq( p->pManAig, pObj, i )
+            pCnf->pVarNums[pObj->Id] = Number++;
+    }
+    // assign variables to the internal nodes
+    Vec_PtrForEachEntry( vMapped, pObj, i )
+        pCnf->pVarNums[pObj->Id] = Number++;
+    // assign variables to the PIs and constant node
+    Aig_ManForEachPi( p->pManAig, pObj, i )
+        pCnf->pVarNums[pObj->Id] = Number++;
+    pCnf->pVarNums[Aig_ManConst1(p->pManAig)->Id] = Number++;
+    pCnf->nVars = Number;
+
+    s->pSink    = pSink;
+    s->pUser    = pUser;
+    s->nVars    = pCnf->nVars;
+    s->pLits    = ALLOC( int, CNF_STREAM_LITS );
+    s->pBegins  = ALLOC( int, CNF_STREAM_LITS + 1 );
+    s->nLits    = 0;
+    s->nClauses = 0;
+    s->nLitsAll = 0;
+    s->nClausesAll = 0;
+
+    // write the clauses
+    vSopTemp = Vec_IntAlloc( 1 << 16 );
+    Vec_PtrForEachEntry( vMapped, pObj, i )
+    {
+        pCut = Cnf_ObjBestCut( pObj );
+
+        // save variables of this cut
+        OutVar = pCnf->pVarNums[ pObj->Id ];
+        for ( k = 0; k < (int)pCut->nFanins; k++ )
+        {
+            pVars[k] = pCnf->pVarNums[ pCut->pFanins[k] ];
+            assert( pVars[k] <= Aig_ManObjNumMax(p->pManAig) );
+        }
+
+        // positive polarity of the cut
+        if ( pCut->nFanins < 5 )
+        {
+            uTruth = 0xFFFF & *Cnf_CutTruth(pCut);
+            Cnf_SopConvertToVector( p->pSops[uTruth], p->pSopSizes[uTruth], vSopTemp );
+            vCover = vSopTemp;
+        }
+        else
+            vCover = pCut->vIsop[1];
+        Vec_IntForEachEntry( vCover, Cube, k )
+        {
+            pLits = Cnf_StreamBegin( s );
+            *pLits++ = 2 * OutVar; 
+            pLits += Cnf_IsopWriteCube( Cube, pCut->nFanins, pVars, pLits );
+            Cnf_StreamEnd( s, pLits );
+        }
+
+        // negative polarity of the cut
+        if ( pCut->nFanins < 5 )
+        {
+            uTruth = 0xFFFF & ~*Cnf_CutTruth(pCut);
+            Cnf_SopConvertToVector( p->pSops[uTruth], p->pSopSizes[uTruth], vSopTemp );
+            vCover = vSopTemp;
+        }
+        else
+            vCover = pCut->vIsop[0];
+        Vec_IntForEachEntry( vCover, Cube, k )
+        {
+            pLits = Cnf_StreamBegin( s );
+            *pLits++ = 2 * OutVar + 1; 
+            pLits += Cnf_IsopWriteCube( Cube, pCut->nFanins, pVars, pLits );
+            Cnf_StreamEnd( s, pLits );
+        }
+    }
+    Vec_IntFree( vSopTemp );
+ 
+    // write the constant literal
+    OutVar = pCnf->pVarNums[ Aig_ManConst1(p->pManAig)->Id ];
+    assert( OutVar <= Aig_ManObjNumMax(p->pManAig) );
+    pLits = Cnf_StreamBegin( s );
+    *pLits++ = 2 * OutVar; 
+    Cnf_StreamEnd( s, pLits );
+
+    // write the output literals
+    Aig_ManForEachPo( p->pManAig, pObj, i )
+    {
+        OutVar = pCnf->pVarNums[ Aig_ObjFanin0(pObj)->Id ];
+        if ( i < Aig_ManPoNum(p->pManAig) - nOutputs )
+        {
+            pLits = Cnf_StreamBegin( s );
+            *pLits++ = 2 * OutVar + Aig_ObjFaninC0(pObj); 
+            Cnf_StreamEnd( s, pLits );
+        }
+        else
+        {
+            PoVar = pCnf->pVarNums[ pObj->Id ];
+            // first clause
+            pLits = Cnf_StreamBegin( s );
+            *pLits++ = 2 * PoVar; 
+            *pLits++ = 2 * OutVar + !Aig_ObjFaninC0(pObj); 
+            Cnf_StreamEnd( s, pLits );
+            // second clause
+            pLits = Cnf_StreamBegin( s );
+            *pLits++ = 2 * PoVar + 1; 
+            *pLits++ = 2 * OutVar + Aig_ObjFaninC0(pObj); 
+            Cnf_StreamEnd( s, pLits );
+        }
+    }
+    Cnf_StreamFlush( s );
+
+    free( s->pLits );
+    free( s->pBegins );
+
+    pCnf->nClauses = s->nClausesAll;
+    pCnf->nLiterals = s->nLitsAll;
+    return pCnf;
+}
+
 // Create a new partial CNF with just the extra bits versus the old CNF.
 // This uses the Tseitin transform of Cnf_DeriveSimple
 // NB. We assume there will only be one more PO than last time.
@@ -69,6 +69,9 @@ typedef struct Cnf_Man_t_            Cnf_Man_t;
 typedef struct Cnf_Dat_t_            Cnf_Dat_t;
 typedef struct Cnf_Cut_t_            Cnf_Cut_t;
 
+// receives a chunk of clauses; clause i is pLits[pBegins[i]] up to pLits[pBegins[i+1]]
+typedef void (*Cnf_ClauseSink_t)( void * pUser, int nVars, int * pLits, int * pBegins, int nClauses );
+
 // the CNF asserting outputs of AIG to be 1
 struct Cnf_Dat_t_
 {
@@ -136,6 +139,7 @@ static inline void         Cnf_ObjSetBestCut( Aig_Obj_t * pObj, Cnf_Cut_t * pCut
 
 /*=== cnfCore.c ========================================================*/
 extern Cnf_Dat_t *     Cnf_Derive( Aig_Man_t * pAig, int nOutputs );
+extern Cnf_Dat_t *     Cnf_DeriveStream( Aig_Man_t * pAig, int nOutputs, Cnf_ClauseSink_t pSink, void * pUser );
 extern Cnf_Man_t *     Cnf_ManRead();
 extern void            Cnf_ClearMemory();
 /*=== cnfCut.c ========================================================*/
@@ -166,6 +170,7 @@ extern Vec_Ptr_t *     Cnf_ManScanMapping( Cnf_Man_t * p, int fCollect, int fPre
 /*=== cnfWrite.c ========================================================*/
 extern void            Cnf_SopConvertToVector( char * pSop, int nCubes, Vec_Int_t * vCover );
 extern Cnf_Dat_t *     Cnf_ManWriteCnf( Cnf_Man_t * p, Vec_Ptr_t * vMapped, int nOutputs );
+extern Cnf_Dat_t *     Cnf_ManWriteCnfStream( Cnf_Man_t * p, Vec_Ptr_t * vMapped, int nOutputs, Cnf_ClauseSink_t pSink, void * pUser );
 extern Cnf_Dat_t *     Cnf_DeriveSimple( Aig_Man_t * p, int nOutputs );
 // NB: This is an STP function...
 extern Cnf_Dat_t * Cnf_DeriveSimple_Additional( Aig_Man_t * p, Cnf_Dat_t * old );
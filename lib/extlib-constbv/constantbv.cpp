@@ -267,7 +267,7 @@ namespace CONSTANTBV {
   /*                                                     */
   /*******************************************************/
 
-  ErrCode BitVector_Boot(void) {
+  static ErrCode BitVector_BootOnce(void) {
     unsigned long longsample = 1L;
     unsigned int sample = LSB;
     unsigned int lsb;
@@ -312,6 +312,13 @@ namespace CONSTANTBV {
     return(ErrCode_Ok);
   }
 
+  /* Every solver instance calls this, possibly on several threads at */
+  /* once. The constants are only computed by the first call.        */
+  ErrCode BitVector_Boot(void) {
+    static const ErrCode result = BitVector_BootOnce();
+    return(result);
+  }
+
   unsigned int BitVector_Size(unsigned int bits) {          /* bit vector size (# of words)  */
     unsigned int size;
 
@@ -0,0 +1,124 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+
+#include <gtest/gtest.h>
+#include "stp/c_interface.h"
+
+// Reads at x, y and z must all give the same value when x, y and z are
+// equal, even though the sorting network only relates neighbouring reads.
+// The indexes are only forced equal by bvule in both directions, so nothing
+// substitutes one for another and the reads have to be Ackermannised.
+TEST(array_sorted_ack, transitive)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, ARRAY_ENCODING, 2);
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr a = vc_varExpr(vc, "a", vc_arrayType(vc, bv8, bv8));
+  Expr x = vc_varExpr(vc, "x", bv8);
+  Expr y = vc_varExpr(vc, "y", bv8);
+  Expr z = vc_varExpr(vc, "z", bv8);
+  Expr v = vc_varExpr(vc, "v", bv8);
+
+  vc_assertFormula(vc, vc_bvLeExpr(vc, x, y));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, y, x));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, y, z));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, z, y));
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, a, y), v));
+
+  // Pinning the read at x alone is enough to fix the read at y.
+  vc_push(vc);
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, a, x),
+                                 vc_bvConstExprFromInt(vc, 8, 1)));
+  ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+  ASSERT_EQ(1u, getBVUnsigned(vc_getCounterExample(vc, v)));
+  vc_pop(vc);
+
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, a, x),
+                                 vc_bvConstExprFromInt(vc, 8, 1)));
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, a, z),
+                                 vc_bvConstExprFromInt(vc, 8, 2)));
+
+  ASSERT_EQ(1, vc_query(vc, vc_falseExpr(vc)));
+
+  vc_Destroy(vc);
+}
+
+// Reads at x, y and x + 1, where y is x + 1 only through the arithmetic of
+// the constraints below.
+TEST(array_sorted_ack, arithmetic)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, ARRAY_ENCODING, 2);
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr a = vc_varExpr(vc, "a", vc_arrayType(vc, bv8, bv8));
+  Expr x = vc_varExpr(vc, "x", bv8);
+  Expr y = vc_varExpr(vc, "y", bv8);
+  Expr one = vc_bvConstExprFromInt(vc, 8, 1);
+
+  // y is x + 1, but only through y - x = 1 and y > x.
+  vc_assertFormula(vc, vc_bvLtExpr(vc, x, y));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, vc_bvMinusExpr(vc, 8, y, x), one));
+
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, a, x),
+                                 vc_bvConstExprFromInt(vc, 8, 1)));
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, a, y),
+                                 vc_bvConstExprFromInt(vc, 8, 2)));
+  ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+
+  vc_assertFormula(
+      vc, vc_eqExpr(vc, vc_readExpr(vc, a, vc_bvPlusExpr(vc, 8, x, one)),
+                    vc_bvConstExprFromInt(vc, 8, 3)));
+  ASSERT_EQ(1, vc_query(vc, vc_falseExpr(vc)));
+
+  vc_Destroy(vc);
+}
+
+// Many reads at distinct indexes with distinct values. The model has to be
+// a real array.
+TEST(array_sorted_ack, distinct)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, ARRAY_ENCODING, 2);
+
+  const int n = 12;
+  Type bv8 = vc_bvType(vc, 8);
+  Expr a = vc_varExpr(vc, "a", vc_arrayType(vc, bv8, bv8));
+  Expr index[n];
+  for (int i = 0; i < n; i++)
+  {
+    char name[16];
+    sprintf(name, "i%d", i);
+    index[i] = vc_varExpr(vc, name, bv8);
+    vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, a, index[i]),
+                                   vc_bvConstExprFromInt(vc, 8, i)));
+  }
+
+  ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+
+  for (int i = 0; i < n; i++)
+    for (int j = i + 1; j < n; j++)
+      ASSERT_NE(getBVUnsigned(vc_getCounterExample(vc, index[i])),
+                getBVUnsigned(vc_getCounterExample(vc, index[j])));
+
+  vc_Destroy(vc);
+}
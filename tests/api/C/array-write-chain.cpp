@@ -0,0 +1,63 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+#include <gtest/gtest.h>
+#include "stp/c_interface.h"
+
+// Reads at constants through a long chain of writes to constants. Each
+// index is overwritten many times, so only the last write to it counts.
+TEST(array_write_chain, last_write_wins)
+{
+  VC vc = vc_createValidityChecker();
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr a = vc_varExpr(vc, "a", vc_arrayType(vc, bv8, bv8));
+  Expr x = vc_varExpr(vc, "x", bv8);
+
+  const int writes = 500;
+  const int indexes = 17;
+  Expr chain = a;
+  for (int i = 0; i < writes; i++)
+  {
+    // Halfway along, write to a symbolic index instead.
+    Expr index = (i == writes / 2) ? x
+                                   : vc_bvConstExprFromInt(vc, 8, i % indexes);
+    chain =
+        vc_writeExpr(vc, chain, index, vc_bvConstExprFromInt(vc, 8, i % 256));
+  }
+
+  // The last lap of writes covers every index.
+  for (int i = writes - indexes; i < writes; i++)
+  {
+    Expr index = vc_bvConstExprFromInt(vc, 8, i % indexes);
+    Expr expected = vc_bvConstExprFromInt(vc, 8, i % 256);
+    ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, vc_readExpr(vc, chain, index),
+                                        expected)));
+  }
+
+  // Index 100 is only ever written through x.
+  Expr far = vc_bvConstExprFromInt(vc, 8, 100);
+  vc_assertFormula(vc, vc_eqExpr(vc, x, far));
+  Expr expected = vc_bvConstExprFromInt(vc, 8, (writes / 2) % 256);
+  ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, vc_readExpr(vc, chain, far),
+                                      expected)));
+
+  vc_Destroy(vc);
+}
@@ -0,0 +1,102 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+#include <gtest/gtest.h>
+#include "stp/c_interface.h"
+
+static unsigned long long fold(VC vc, Expr e)
+{
+  Expr s = vc_simplify(vc, e);
+  return getBVUnsignedLongLong(s);
+}
+
+// Signed division at the extremes of a 64-bit and an 8-bit vector.
+TEST(consteval, signed_division)
+{
+  VC vc = vc_createValidityChecker();
+
+  Expr min64 = vc_bvConstExprFromLL(vc, 64, 0x8000000000000000ULL);
+  Expr minus1 = vc_bvConstExprFromLL(vc, 64, ~0ULL);
+  Expr seven = vc_bvConstExprFromLL(vc, 64, 7);
+  Expr minus7 = vc_bvConstExprFromLL(vc, 64, -7ULL);
+  Expr two = vc_bvConstExprFromLL(vc, 64, 2);
+  Expr minus2 = vc_bvConstExprFromLL(vc, 64, -2ULL);
+
+  ASSERT_EQ(0x8000000000000000ULL,
+            fold(vc, vc_sbvDivExpr(vc, 64, min64, minus1)));
+  ASSERT_EQ(-3ULL, fold(vc, vc_sbvDivExpr(vc, 64, minus7, two)));
+  ASSERT_EQ(-1ULL, fold(vc, vc_sbvRemExpr(vc, 64, minus7, two)));
+  ASSERT_EQ(1ULL, fold(vc, vc_sbvModExpr(vc, 64, minus7, two)));
+  ASSERT_EQ(-1ULL, fold(vc, vc_sbvModExpr(vc, 64, seven, minus2)));
+  ASSERT_EQ(1ULL, fold(vc, vc_sbvRemExpr(vc, 64, seven, minus2)));
+
+  Expr min8 = vc_bvConstExprFromInt(vc, 8, 0x80);
+  Expr minus1_8 = vc_bvConstExprFromInt(vc, 8, 0xff);
+  ASSERT_EQ(0x80ULL, fold(vc, vc_sbvDivExpr(vc, 8, min8, minus1_8)));
+
+  vc_Destroy(vc);
+}
+
+TEST(consteval, shifts_and_concat)
+{
+  VC vc = vc_createValidityChecker();
+
+  Expr x = vc_bvConstExprFromInt(vc, 16, 0x8421);
+  Expr four = vc_bvConstExprFromInt(vc, 16, 4);
+  Expr big = vc_bvConstExprFromInt(vc, 16, 17);
+
+  ASSERT_EQ(0x4210ULL, fold(vc, vc_bvLeftShiftExprExpr(vc, 16, x, four)));
+  ASSERT_EQ(0x0842ULL, fold(vc, vc_bvRightShiftExprExpr(vc, 16, x, four)));
+  ASSERT_EQ(0xf842ULL,
+            fold(vc, vc_bvSignedRightShiftExprExpr(vc, 16, x, four)));
+  ASSERT_EQ(0xffffULL,
+            fold(vc, vc_bvSignedRightShiftExprExpr(vc, 16, x, big)));
+  ASSERT_EQ(0ULL, fold(vc, vc_bvLeftShiftExprExpr(vc, 16, x, big)));
+
+  Expr y = vc_bvConstExprFromLL(vc, 48, 0x123456789abcULL);
+  ASSERT_EQ(0x8421123456789abcULL, fold(vc, vc_bvConcatExpr(vc, x, y)));
+  ASSERT_EQ(0x9abULL, fold(vc, vc_bvExtract(vc, y, 15, 4)));
+
+  vc_Destroy(vc);
+}
+
+// Constants of 64 bits or less are stored in the node, wider ones in a
+// CBV. Values must survive crossing between the two.
+TEST(consteval, inline_constants)
+{
+  VC vc = vc_createValidityChecker();
+
+  Expr all64 = vc_bvConstExprFromLL(vc, 64, ~0ULL);
+  Expr wide = vc_bvConcatExpr(vc, vc_bvConstExprFromInt(vc, 8, 0x5a), all64);
+  ASSERT_EQ(~0ULL, fold(vc, vc_bvExtract(vc, wide, 63, 0)));
+  ASSERT_EQ(0x5affULL, fold(vc, vc_bvExtract(vc, wide, 71, 56)));
+  ASSERT_EQ(~0ULL, getBVUnsignedLongLong(all64));
+
+  Expr one8 = vc_bvConstExprFromInt(vc, 8, 1);
+  Expr one9 = vc_bvConstExprFromInt(vc, 9, 1);
+  ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, vc_bvConcatExpr(vc, one8, one8),
+                                      vc_bvConstExprFromInt(vc, 16, 0x101))));
+  Expr zero1 = vc_bvConstExprFromInt(vc, 1, 0);
+  ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, vc_bvConcatExpr(vc, zero1, one8),
+                                      one9)));
+  ASSERT_EQ(getBVUnsigned(one8), getBVUnsigned(one9));
+
+  vc_Destroy(vc);
+}
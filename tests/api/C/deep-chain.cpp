@@ -0,0 +1,107 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include "stp/c_interface.h"
+
+// Each link is an ITE feeding a BVPLUS, so nothing flattens the chain as it
+// is built and every pass sees it at its full depth.
+static Expr deep_chain(VC vc, Expr x, Expr* conditions, int links)
+{
+  Expr one = vc_bvConstExprFromInt(vc, 8, 1);
+  Expr chain = x;
+  for (int i = 0; i < links; i++)
+    chain = vc_bvPlusExpr(vc, 8, vc_iteExpr(vc, conditions[i], chain, x), one);
+  return chain;
+}
+
+static Expr* fresh_conditions(VC vc, int links)
+{
+  Expr* conditions = new Expr[links];
+  for (int i = 0; i < links; i++)
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "c%d", i);
+    conditions[i] = vc_varExpr(vc, name, vc_boolType(vc));
+  }
+  return conditions;
+}
+
+// Only the simplifier, and deleting the nodes, see the chain at this depth.
+// Other passes on the vc_query path still recurse once per level.
+TEST(deep_chain, simplify)
+{
+  const int links = 100000;
+  VC vc = vc_createValidityChecker();
+
+  Expr x = vc_varExpr(vc, "x", vc_bvType(vc, 8));
+  Expr* conditions = fresh_conditions(vc, links);
+  Expr chain = deep_chain(vc, x, conditions, links);
+
+  // Nothing in the chain simplifies, so it comes back unchanged.
+  ASSERT_EQ(getExprID(chain), getExprID(vc_simplify(vc, chain)));
+
+  delete[] conditions;
+  vc_Destroy(vc);
+}
+
+// Deep enough that the simplifier and the bit-blaster both pass their
+// recursion limits, shallow enough for the passes that still recurse.
+static const int query_links = 2000;
+
+// A different condition at every link, so the whole chain is bit-blasted.
+TEST(deep_chain, bvadd_ite_invalid)
+{
+  VC vc = vc_createValidityChecker();
+
+  Expr x = vc_varExpr(vc, "x", vc_bvType(vc, 8));
+  Expr* conditions = fresh_conditions(vc, query_links);
+  Expr chain = deep_chain(vc, x, conditions, query_links);
+
+  // Taking the else branch at the last link makes the chain x + 1.
+  Expr seven = vc_bvConstExprFromInt(vc, 8, 7);
+  ASSERT_EQ(0, vc_query(vc, vc_notExpr(vc, vc_eqExpr(vc, chain, seven))));
+
+  delete[] conditions;
+  vc_Destroy(vc);
+}
+
+// One condition shared by every link. Once it is asserted the simplifier
+// has to fold the whole chain down to x + links.
+TEST(deep_chain, bvadd_ite_valid)
+{
+  VC vc = vc_createValidityChecker();
+
+  Expr x = vc_varExpr(vc, "x", vc_bvType(vc, 8));
+  Expr c = vc_varExpr(vc, "c", vc_boolType(vc));
+  Expr* conditions = new Expr[query_links];
+  for (int i = 0; i < query_links; i++)
+    conditions[i] = c;
+  Expr chain = deep_chain(vc, x, conditions, query_links);
+
+  vc_assertFormula(vc, c);
+  Expr expected =
+      vc_bvPlusExpr(vc, 8, x, vc_bvConstExprFromInt(vc, 8, query_links % 256));
+  ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, chain, expected)));
+
+  delete[] conditions;
+  vc_Destroy(vc);
+}
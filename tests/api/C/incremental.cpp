@@ -0,0 +1,112 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+#include <gtest/gtest.h>
+#include "stp/c_interface.h"
+
+// Formulas that are popped must not constrain later queries, even though
+// their clauses are still in the solver.
+TEST(incremental, push_pop)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, INCREMENTAL, 1);
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr a = vc_varExpr(vc, "a", bv8);
+  Expr b = vc_varExpr(vc, "b", bv8);
+
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_bvPlusExpr(vc, 8, a, b),
+                                 vc_bvConstExprFromInt(vc, 8, 10)));
+
+  vc_push(vc);
+  vc_assertFormula(vc, vc_eqExpr(vc, a, vc_bvConstExprFromInt(vc, 8, 3)));
+  ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, b, vc_bvConstExprFromInt(vc, 8, 7))));
+  vc_pop(vc);
+
+  vc_push(vc);
+  vc_assertFormula(vc, vc_eqExpr(vc, a, vc_bvConstExprFromInt(vc, 8, 4)));
+  ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, b, vc_bvConstExprFromInt(vc, 8, 6))));
+  ASSERT_EQ(0, vc_query(vc, vc_eqExpr(vc, b, vc_bvConstExprFromInt(vc, 8, 7))));
+  vc_pop(vc);
+
+  ASSERT_EQ(0, vc_query(vc, vc_eqExpr(vc, b, vc_bvConstExprFromInt(vc, 8, 6))));
+  Expr ce = vc_getCounterExample(vc, b);
+  ASSERT_NE(6u, getBVUnsigned(ce));
+
+  vc_Destroy(vc);
+}
+
+// Array reads from different queries are related to each other.
+TEST(incremental, arrays)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, INCREMENTAL, 1);
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr m = vc_varExpr(vc, "m", vc_arrayType(vc, bv8, bv8));
+  Expr i = vc_varExpr(vc, "i", bv8);
+  Expr j = vc_varExpr(vc, "j", bv8);
+
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_readExpr(vc, m, i),
+                                 vc_bvConstExprFromInt(vc, 8, 1)));
+  ASSERT_EQ(0, vc_query(vc, vc_eqExpr(vc, vc_readExpr(vc, m, j),
+                                      vc_bvConstExprFromInt(vc, 8, 1))));
+
+  vc_push(vc);
+  vc_assertFormula(vc, vc_eqExpr(vc, i, j));
+  ASSERT_EQ(1, vc_query(vc, vc_eqExpr(vc, vc_readExpr(vc, m, j),
+                                      vc_bvConstExprFromInt(vc, 8, 1))));
+  vc_pop(vc);
+
+  vc_Destroy(vc);
+}
+
+// Queries that share a large term. The multiplication is bit-blasted once,
+// and each query only adds the comparison against it.
+TEST(incremental, shared_terms)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, INCREMENTAL, 1);
+
+  Type bv16 = vc_bvType(vc, 16);
+  Expr x = vc_varExpr(vc, "x", bv16);
+  Expr y = vc_varExpr(vc, "y", bv16);
+  Expr product = vc_bvMultExpr(vc, 16, x, y);
+
+  vc_assertFormula(vc, vc_bvGtExpr(vc, x, vc_bvConstExprFromInt(vc, 16, 1)));
+  vc_assertFormula(vc, vc_bvGtExpr(vc, y, vc_bvConstExprFromInt(vc, 16, 1)));
+  vc_assertFormula(vc, vc_bvLtExpr(vc, x, vc_bvConstExprFromInt(vc, 16, 256)));
+  vc_assertFormula(vc, vc_bvLtExpr(vc, y, vc_bvConstExprFromInt(vc, 16, 256)));
+
+  for (int i = 0; i < 8; i++)
+  {
+    const int target = 6 + 2 * i;
+    vc_push(vc);
+    vc_assertFormula(
+        vc, vc_eqExpr(vc, product, vc_bvConstExprFromInt(vc, 16, target)));
+    ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+    const unsigned xv = getBVUnsigned(vc_getCounterExample(vc, x));
+    const unsigned yv = getBVUnsigned(vc_getCounterExample(vc, y));
+    ASSERT_EQ((unsigned)target, (xv * yv) & 0xffff);
+    vc_pop(vc);
+  }
+
+  vc_Destroy(vc);
+}
@@ -0,0 +1,146 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string>
+#include "stp/c_interface.h"
+
+// True if the first interval pass left nothing of the problem, so neither
+// later passes nor the SAT solver were needed to decide it.
+static bool decided_by_intervals(VC vc)
+{
+  char* buf = NULL;
+  unsigned long len = 0;
+  vc_printProfileToBuffer(vc, &buf, &len);
+  const std::string json(buf);
+  free(buf);
+  const std::string stage =
+      "{\"stage\":\"After Establishing Intervals\",\"nodes\":";
+  const size_t first = json.find(stage);
+  return first != std::string::npos && first == json.find(stage + "1}");
+}
+
+// A bounds check: 0 <=s i <s n and n <=u 100. The bounds on i and n make
+// i + 1 <=u 100 true, but the model still has to respect the asserts.
+TEST(intervals, bounds_check)
+{
+  VC vc = vc_createValidityChecker();
+
+  Type bv16 = vc_bvType(vc, 16);
+  Expr i = vc_varExpr(vc, "i", bv16);
+  Expr n = vc_varExpr(vc, "n", bv16);
+  Expr zero = vc_bvConstExprFromInt(vc, 16, 0);
+  Expr hundred = vc_bvConstExprFromInt(vc, 16, 100);
+
+  vc_assertFormula(vc, vc_sbvGeExpr(vc, i, zero));
+  vc_assertFormula(vc, vc_sbvLtExpr(vc, i, n));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, n, hundred));
+
+  Expr next = vc_bvPlusExpr(vc, 16, i, vc_bvConstExprFromInt(vc, 16, 1));
+  ASSERT_EQ(1, vc_query(vc, vc_bvLeExpr(vc, next, hundred)));
+
+  vc_assertFormula(vc, vc_bvGeExpr(vc, i, vc_bvConstExprFromInt(vc, 16, 98)));
+  ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+  const unsigned iv = getBVUnsigned(vc_getCounterExample(vc, i));
+  const unsigned nv = getBVUnsigned(vc_getCounterExample(vc, n));
+  ASSERT_TRUE(iv >= 98 && iv < nv && nv <= 100);
+
+  vc_Destroy(vc);
+}
+
+// x is negative, so it can't be greater than y, which is non-negative.
+TEST(intervals, signed_unsat)
+{
+  VC vc = vc_createValidityChecker();
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr x = vc_varExpr(vc, "x", bv8);
+  Expr y = vc_varExpr(vc, "y", bv8);
+  Expr zero = vc_bvConstExprFromInt(vc, 8, 0);
+
+  vc_assertFormula(vc, vc_sbvLtExpr(vc, x, zero));
+  vc_assertFormula(vc, vc_sbvGeExpr(vc, y, zero));
+  vc_assertFormula(vc, vc_sbvGtExpr(vc, x, y));
+
+  ASSERT_EQ(1, vc_query(vc, vc_falseExpr(vc)));
+
+  vc_Destroy(vc);
+}
+
+// x + 3 <=u 10 bounds x to [-3, 7], and x <=u 20 then leaves [0, 7].
+TEST(intervals, backward_through_plus)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, PROFILE, 1);
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr x = vc_varExpr(vc, "x", bv8);
+  Expr sum = vc_bvPlusExpr(vc, 8, x, vc_bvConstExprFromInt(vc, 8, 3));
+
+  vc_assertFormula(vc, vc_bvLeExpr(vc, sum, vc_bvConstExprFromInt(vc, 8, 10)));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, x, vc_bvConstExprFromInt(vc, 8, 20)));
+
+  Expr eight = vc_bvConstExprFromInt(vc, 8, 8);
+  ASSERT_EQ(1, vc_query(vc, vc_bvLtExpr(vc, x, eight)));
+  ASSERT_TRUE(decided_by_intervals(vc));
+
+  vc_Destroy(vc);
+}
+
+// The top four bits of x are at most 1, so x is less than 32.
+TEST(intervals, backward_through_extract)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, PROFILE, 1);
+
+  Expr x = vc_varExpr(vc, "x", vc_bvType(vc, 8));
+
+  vc_assertFormula(vc, vc_bvLeExpr(vc, vc_bvExtract(vc, x, 7, 4),
+                                   vc_bvConstExprFromInt(vc, 4, 1)));
+
+  Expr thirtyTwo = vc_bvConstExprFromInt(vc, 8, 32);
+  ASSERT_EQ(1, vc_query(vc, vc_bvLtExpr(vc, x, thirtyTwo)));
+  ASSERT_TRUE(decided_by_intervals(vc));
+
+  vc_Destroy(vc);
+}
+
+// x is in [-5, 5], which spans zero, so as an unsigned interval it is all
+// values. Kept as a signed interval it's still below y.
+TEST(intervals, signed_across_zero)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, PROFILE, 1);
+
+  Type bv8 = vc_bvType(vc, 8);
+  Expr x = vc_varExpr(vc, "x", bv8);
+  Expr y = vc_varExpr(vc, "y", bv8);
+
+  Expr minusFive = vc_bvConstExprFromInt(vc, 8, 251);
+  vc_assertFormula(vc, vc_sbvGeExpr(vc, x, minusFive));
+  vc_assertFormula(vc, vc_sbvLeExpr(vc, x, vc_bvConstExprFromInt(vc, 8, 5)));
+  vc_assertFormula(vc, vc_sbvGeExpr(vc, y, vc_bvConstExprFromInt(vc, 8, 6)));
+
+  ASSERT_EQ(1, vc_query(vc, vc_sbvLtExpr(vc, x, y)));
+  ASSERT_TRUE(decided_by_intervals(vc));
+
+  vc_Destroy(vc);
+}
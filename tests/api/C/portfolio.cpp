@@ -0,0 +1,69 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+#include <gtest/gtest.h>
+#include "stp/c_interface.h"
+
+// Factor a number with several solvers racing. Whichever answers, its model
+// has to be read back correctly.
+TEST(portfolio, factor)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, PORTFOLIO, 4);
+
+  Type bv16 = vc_bvType(vc, 16);
+  Expr x = vc_varExpr(vc, "x", bv16);
+  Expr y = vc_varExpr(vc, "y", bv16);
+
+  vc_assertFormula(vc, vc_bvGtExpr(vc, x, vc_bvConstExprFromInt(vc, 16, 1)));
+  vc_assertFormula(vc, vc_bvGtExpr(vc, y, vc_bvConstExprFromInt(vc, 16, 1)));
+  vc_assertFormula(vc, vc_bvLtExpr(vc, x, vc_bvConstExprFromInt(vc, 16, 256)));
+  vc_assertFormula(vc, vc_bvLtExpr(vc, y, vc_bvConstExprFromInt(vc, 16, 256)));
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_bvMultExpr(vc, 16, x, y),
+                                 vc_bvConstExprFromInt(vc, 16, 391)));
+
+  ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+  const unsigned xv = getBVUnsigned(vc_getCounterExample(vc, x));
+  const unsigned yv = getBVUnsigned(vc_getCounterExample(vc, y));
+  ASSERT_EQ(391u, xv * yv);
+
+  vc_Destroy(vc);
+}
+
+// An even x makes x * y even, but 391 is odd.
+TEST(portfolio, unsat)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, PORTFOLIO, 3);
+
+  Type bv16 = vc_bvType(vc, 16);
+  Expr x = vc_varExpr(vc, "x", bv16);
+  Expr y = vc_varExpr(vc, "y", bv16);
+  Expr one = vc_bvConstExprFromInt(vc, 16, 1);
+  Expr zero = vc_bvConstExprFromInt(vc, 16, 0);
+
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_bvMultExpr(vc, 16, x, y),
+                                 vc_bvConstExprFromInt(vc, 16, 391)));
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_bvAndExpr(vc, x, one), zero));
+
+  ASSERT_EQ(1, vc_query(vc, vc_falseExpr(vc)));
+
+  vc_Destroy(vc);
+}
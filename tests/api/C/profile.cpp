@@ -0,0 +1,88 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string>
+#include "stp/c_interface.h"
+
+TEST(profile, per_query_json)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, PROFILE, 1);
+
+  Type bv32 = vc_bvType(vc, 32);
+  Expr x = vc_varExpr(vc, "x", bv32);
+  Expr y = vc_varExpr(vc, "y", bv32);
+  Expr product = vc_bvMultExpr(vc, 32, x, y);
+  vc_assertFormula(
+      vc, vc_eqExpr(vc, product, vc_bvConstExprFromInt(vc, 32, 143)));
+  vc_assertFormula(
+      vc, vc_bvGtExpr(vc, x, vc_bvConstExprFromInt(vc, 32, 1)));
+  vc_assertFormula(
+      vc, vc_bvGtExpr(vc, y, vc_bvConstExprFromInt(vc, 32, 1)));
+  ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+
+  char* buf = NULL;
+  unsigned long len = 0;
+  vc_printProfileToBuffer(vc, &buf, &len);
+  ASSERT_TRUE(buf != NULL);
+  const std::string json(buf);
+  free(buf);
+
+  ASSERT_EQ('{', json[0]);
+  ASSERT_NE(std::string::npos, json.find("\"passes\":{"));
+  ASSERT_NE(std::string::npos, json.find("\"SAT Solving\":{\"count\":"));
+  ASSERT_NE(std::string::npos, json.find("\"cpu_us\":"));
+  ASSERT_NE(std::string::npos, json.find("\"stage\":"));
+  ASSERT_NE(std::string::npos, json.find("\"CNF clauses\":"));
+
+  vc_Destroy(vc);
+}
+
+// By default the problem is bit-blasted, with constant bits fixed, to
+// measure it. That bit-blast is the one that's then solved.
+TEST(profile, reuses_measured_bitblast)
+{
+  VC vc = vc_createValidityChecker();
+  vc_setInterfaceFlags(vc, PROFILE, 1);
+
+  Type bv32 = vc_bvType(vc, 32);
+  Expr x = vc_varExpr(vc, "x", bv32);
+  Expr y = vc_varExpr(vc, "y", bv32);
+  vc_assertFormula(
+      vc, vc_eqExpr(vc, vc_bvMultExpr(vc, 32, x, y),
+                    vc_bvConstExprFromInt(vc, 32, 143)));
+  vc_assertFormula(
+      vc, vc_bvGtExpr(vc, x, vc_bvConstExprFromInt(vc, 32, 1)));
+  ASSERT_EQ(0, vc_query(vc, vc_falseExpr(vc)));
+
+  char* buf = NULL;
+  unsigned long len = 0;
+  vc_printProfileToBuffer(vc, &buf, &len);
+  ASSERT_TRUE(buf != NULL);
+  const std::string json(buf);
+  free(buf);
+
+  ASSERT_NE(std::string::npos, json.find("\"Bit Blasting\":{\"count\":1,"));
+  ASSERT_NE(std::string::npos, json.find("\"Bit-blasts reused\":1"));
+
+  vc_Destroy(vc);
+}
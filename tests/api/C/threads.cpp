@@ -0,0 +1,69 @@
+/***********
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+**********************/
+
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "stp/c_interface.h"
+
+// Each thread builds, solves and destroys its own validity checker. The
+// product differs per thread, so a model leaking between threads is caught.
+static void factor(unsigned product, unsigned* result)
+{
+  VC vc = vc_createValidityChecker();
+
+  Type bv16 = vc_bvType(vc, 16);
+  Expr x = vc_varExpr(vc, "x", bv16);
+  Expr y = vc_varExpr(vc, "y", bv16);
+
+  vc_assertFormula(vc, vc_bvGtExpr(vc, x, vc_bvConstExprFromInt(vc, 16, 1)));
+  vc_assertFormula(vc, vc_bvGtExpr(vc, y, vc_bvConstExprFromInt(vc, 16, 1)));
+  vc_assertFormula(vc, vc_bvLtExpr(vc, x, vc_bvConstExprFromInt(vc, 16, 256)));
+  vc_assertFormula(vc, vc_bvLtExpr(vc, y, vc_bvConstExprFromInt(vc, 16, 256)));
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_bvMultExpr(vc, 16, x, y),
+                                 vc_bvConstExprFromInt(vc, 16, product)));
+
+  *result = 0;
+  if (vc_query(vc, vc_falseExpr(vc)) == 0)
+    *result = getBVUnsigned(vc_getCounterExample(vc, x)) *
+              getBVUnsigned(vc_getCounterExample(vc, y));
+
+  vc_Destroy(vc);
+}
+
+TEST(threads, independent_checkers)
+{
+  const unsigned products[] = {391, 667, 899, 1147, 1517, 1763, 2021, 2491};
+  const int n = sizeof(products) / sizeof(products[0]);
+
+  for (int round = 0; round < 3; round++)
+  {
+    unsigned results[n];
+    std::vector<std::thread> workers;
+    for (int i = 0; i < n; i++)
+      workers.push_back(std::thread(factor, products[i], &results[i]));
+    for (int i = 0; i < n; i++)
+      workers[i].join();
+
+    for (int i = 0; i < n; i++)
+      ASSERT_EQ(products[i], results[i]);
+  }
+}
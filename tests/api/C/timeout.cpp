@@ -26,29 +26,62 @@ THE SOFTWARE.
 #include <stdio.h>
 #include "stp/c_interface.h"
 #include <iostream>
-#include <stdlib.h>
+#include <sys/time.h>
 
+static long milliseconds()
+{
+  timeval t;
+  gettimeofday(&t, NULL);
+  return (1000 * t.tv_sec) + (t.tv_usec / 1000);
+}
+
+// Showing that a 62-bit prime has no factors takes far longer than the time
+// limit, so the query should give up soon after the limit has passed.
+TEST(timeout, wall_clock)
+{
+  VC vc = vc_createValidityChecker();
+
+  Type bv64 = vc_bvType(vc, 64);
+  Expr x = vc_varExpr(vc, "x", bv64);
+  Expr y = vc_varExpr(vc, "y", bv64);
+  Expr one = vc_bvConstExprFromInt(vc, 64, 1);
+  Expr bound = vc_bvConstExprFromLL(vc, 64, 0xffffffffULL);
+
+  // 2^62 - 57 is prime.
+  vc_assertFormula(vc, vc_eqExpr(vc, vc_bvMultExpr(vc, 64, x, y),
+                                 vc_bvConstExprFromLL(
+                                     vc, 64, 4611686018427387847ULL)));
+  vc_assertFormula(vc, vc_bvGtExpr(vc, x, one));
+  vc_assertFormula(vc, vc_bvGtExpr(vc, y, one));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, x, bound));
+  vc_assertFormula(vc, vc_bvLeExpr(vc, y, bound));
+  vc_assertFormula(vc, vc_bvLtExpr(vc, x, y));
+
+  const long start = milliseconds();
+  ASSERT_EQ(3, vc_query_with_timeout(vc, vc_falseExpr(vc), 200));
+  ASSERT_LT(milliseconds() - start, 5000);
+
+  vc_Destroy(vc);
+}
+
+// Each query gets a short fixed deadline, so the test runs quickly and
+// behaves the same way every time.
 TEST(timeout, one)
 {
   VC vc = vc_createValidityChecker();
   vc_setFlags(vc, 'm');
 
-  srand(time(NULL)); // FIXME: We should not be introducing non-deterministic
-                     // behaviour in a test case!
-
   // SMT_FILE is a macro that expands to a file path
   Expr c = vc_parseExpr(vc, SMT_FILE);
 
   for (int i = 0; i < 10; i++)
   {
-    int time =
-        rand() %
-        7000; // FIXME: non-determinsitc behaviour in a test case is BAD!!!
-    std::cout << "Timeout : " << time << " : result " << std::flush;
-    std::cout << vc_query_with_timeout(vc, vc_falseExpr(vc), time) << std::endl;
+    const long start = milliseconds();
+    int result = vc_query_with_timeout(vc, vc_falseExpr(vc), 100);
+    std::cout << "Timeout : 100 : result " << result << std::endl;
+    ASSERT_NE(2, result);
+    ASSERT_LT(milliseconds() - start, 5000);
   }
   vc_DeleteExpr(c);
   vc_Destroy(vc);
-  // FIXME: Actually test something
-  // ASSERT_TRUE(false && "FIXME: Actually test something");
 }
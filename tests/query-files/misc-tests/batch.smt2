@@ -0,0 +1,12 @@
+; RUN: echo %s > %t.list
+; RUN: echo %s >> %t.list
+; RUN: %solver --batch %t.list --threads 2 | %OutputCheck %s
+(set-logic QF_BV)
+(set-info :smt-lib-version 2.0)
+(declare-fun x () (_ BitVec 8))
+
+(assert (= (bvmul x (_ bv3 8)) (_ bv21 8)))
+; CHECK: ^sat [0-9.]+s [0-9.]+MB .*batch\.smt2$
+; CHECK-NEXT: ^sat [0-9.]+s [0-9.]+MB .*batch\.smt2$
+(check-sat)
+(exit)
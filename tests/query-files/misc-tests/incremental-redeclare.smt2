@@ -0,0 +1,27 @@
+; RUN: %solver --incremental %s | %OutputCheck %s
+(set-logic QF_BV)
+(set-info :smt-lib-version 2.0)
+(push 1)
+(declare-fun x () (_ BitVec 8))
+(assert (= (bvadd x (_ bv1 8)) (_ bv0 8)))
+; CHECK-NEXT: ^sat
+(check-sat)
+; CHECK-NEXT: ^\(\(\|x\| \(_ bv255 8\)\)\)
+(get-value (x))
+(pop 1)
+
+; x is declared again with a wider sort, after the solver has encoded it at
+; 8 bits.
+(declare-fun x () (_ BitVec 16))
+(assert (= (bvadd x (_ bv1 16)) (_ bv0 16)))
+; CHECK-NEXT: ^sat
+(check-sat)
+; CHECK-NEXT: ^\(\(\|x\| \(_ bv65535 16\)\)\)
+(get-value (x))
+
+(push 1)
+(assert (bvult x (_ bv256 16)))
+; CHECK-NEXT: ^unsat
+(check-sat)
+(pop 1)
+(exit)
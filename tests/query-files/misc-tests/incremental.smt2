@@ -0,0 +1,45 @@
+; RUN: %solver --incremental %s | %OutputCheck %s
+(set-logic QF_BV)
+(set-info :smt-lib-version 2.0)
+(declare-fun x () (_ BitVec 8))
+(declare-fun y () (_ BitVec 8))
+(declare-fun a () (Array (_ BitVec 8) (_ BitVec 8)))
+
+(assert (= (bvadd x y) (_ bv10 8)))
+(assert (= x (_ bv3 8)))
+; CHECK-NEXT: ^sat
+(check-sat)
+; CHECK-NEXT: ^\(\(\|x\| \(_ bv3 8\)\)
+; CHECK-NEXT: ^ \(\|y\| \(_ bv7 8\)\)
+; CHECK-NEXT: ^ \(\(bvadd \|x\| \|y\|\) \(_ bv10 8\)\)\)
+(get-value (x y (bvadd x y)))
+
+(push 1)
+(assert (bvult y (_ bv5 8)))
+; CHECK-NEXT: ^unsat
+(check-sat)
+(pop 1)
+
+; CHECK-NEXT: ^unsat
+(check-sat-assuming ((= y (_ bv1 8))))
+; CHECK-NEXT: ^sat
+(check-sat)
+; CHECK-NEXT: ^\(model
+; CHECK-NEXT: ^  \(define-fun \|x\| \(\) \(_ BitVec 8\) \(_ bv3 8\)\)
+; CHECK-NEXT: ^  \(define-fun \|y\| \(\) \(_ BitVec 8\) \(_ bv7 8\)\)
+; CHECK-NEXT: ^\)
+(get-model)
+
+; An error doesn't end the session.
+; CHECK-NEXT: ^\(error "get-value: values of arrays can't be printed"\)
+(get-value (x a))
+; CHECK-NEXT: ^\(\(\|x\| \(_ bv3 8\)\)\)
+(get-value (x))
+
+(reset-assertions)
+(assert (= x (_ bv200 8)))
+; CHECK-NEXT: ^sat
+(check-sat)
+; CHECK-NEXT: ^\(\(\|x\| \(_ bv200 8\)\)\)
+(get-value (x))
+(exit)
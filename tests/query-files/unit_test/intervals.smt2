@@ -0,0 +1,18 @@
+; RUN: %solver %s | %OutputCheck %s
+(set-logic QF_BV)
+(set-info :smt-lib-version 2.0)
+(set-info :category "check")
+(set-info :status sat)
+(declare-fun x () (_ BitVec 6))
+(declare-fun y () (_ BitVec 6))
+
+; The bounds on x are simplified away from the conjuncts that give them, and
+; those conjuncts are put back. Putting them back must not change the
+; problem each time, or simplifying it never stops.
+
+(assert (bvugt (concat #b0000 ((_ extract 2 1) (bvadd x y))) x))
+(assert (bvsgt x y))
+(assert (bvugt #b110110 x))
+; CHECK-NEXT: ^sat
+(check-sat)
+(exit)
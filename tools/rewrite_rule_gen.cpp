@@ -72,7 +72,9 @@ using std::ofstream;
 using std::ifstream;
 using namespace stp;
 
-extern int smt2parse();
+extern int smt2lex_init(void** scanner);
+extern int smt2lex_destroy(void* scanner);
+extern int smt2parse(void* scanner);
 
 
 
@@ -1774,7 +1776,7 @@ ASTNode rewrite(const ASTNode& n, const Rewrite_rule& original_rule,
   return n2;
 }
 
-int smt2_scan_string(const char* yy_str);
+void* smt2_scan_string(const char* yy_str, void* scanner);
 
 // http://stackoverflow.com/questions/3418231/c-replace-part-of-a-string-with-another-string
 bool replace(std::string& str, const std::string& from, const std::string& to)
@@ -1820,6 +1822,9 @@ void load_new_rules(const string fileName = "rules_new.smt2")
   w_ss << "(declare-fun w () (_ BitVec " << bits << "))";
   string w_string = w_ss.str();
 
+  void* scanner;
+  smt2lex_init(&scanner);
+
   // This file I/O code: 1) Is terrible  2) I'm in a big rush so just getting it
   // working 3) am embarised by it.
   while (!feof(in))
@@ -1862,8 +1867,8 @@ void load_new_rules(const string fileName = "rules_new.smt2")
 
     // Load it into a string because other wise the parser reads in big blocks
     // way past where we want it to.
-    smt2_scan_string(s.c_str());
-    smt2parse();
+    smt2_scan_string(s.c_str(), scanner);
+    smt2parse(scanner);
     ASTVec values = piTypeCheckDefault.GetAsserts();
     values = FlattenKind(AND, values);
 
@@ -1898,8 +1903,7 @@ void load_new_rules(const string fileName = "rules_new.smt2")
     GlobalParserInterface->popToFirstLevel();
   }
 
-  extern int smt2lex_destroy(void);
-  smt2lex_destroy();
+  smt2lex_destroy(scanner);
 
   GlobalParserInterface->cleanUp();
   GlobalParserInterface = NULL;
@@ -1938,15 +1942,14 @@ void expandRules(int timeout_ms, const char* fileName = "")
 
 void t2()
 {
-  extern FILE* smt2in;
-
-  smt2in = fopen("big_array.smt2", "r");
+  FILE* in = fopen("big_array.smt2", "r");
   TypeChecker nfTypeCheckDefault(*mgr->hashingNodeFactory, *mgr);
   Cpp_interface piTypeCheckDefault(*mgr, &nfTypeCheckDefault);
   GlobalParserInterface = &piTypeCheckDefault;
 
   mgr->GetRunTimes()->start(RunTimes::Parsing);
-  smt2parse();
+  parseSMTLIB2(in);
+  fclose(in);
 
   ASTVec v = FlattenKind(AND, piTypeCheckDefault.GetAsserts());
   ASTNode n = nf->CreateNode(XOR, v);
@@ -1966,9 +1969,7 @@ void load_old_rules(string fileName)
   if (!ifstream(fileName.c_str()))
     return; // file doesn't exist.
 
-  extern FILE* smt2in;
-
-  smt2in = fopen(fileName.c_str(), "r");
+  FILE* in = fopen(fileName.c_str(), "r");
   TypeChecker nfTypeCheckDefault(*mgr->hashingNodeFactory, *mgr);
   Cpp_interface piTypeCheckDefault(*mgr, &nfTypeCheckDefault);
   GlobalParserInterface = &piTypeCheckDefault;
@@ -1976,7 +1977,8 @@ void load_old_rules(string fileName)
   GlobalParserInterface->push(); // so the rules can be de-asserted.
 
   mgr->GetRunTimes()->start(RunTimes::Parsing);
-  smt2parse();
+  parseSMTLIB2(in);
+  fclose(in);
 
   ASTVec values = piTypeCheckDefault.GetAsserts();
   values = FlattenKind(AND, values);
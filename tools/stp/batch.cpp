@@ -0,0 +1,324 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+
+#include "batch.h"
+#include "main_common.h"
+#include "extlib-abc/cnf_short.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+
+extern int smtparse(void*);
+extern int cvcparse(void*);
+extern int cvclex_destroy(void);
+extern int smtlex_destroy(void);
+extern FILE* cvcin;
+extern FILE* smtin;
+
+using namespace stp;
+using std::auto_ptr;
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::string;
+
+static bool hasSuffix(const string& s, const string& suffix)
+{
+  return s.size() >= suffix.size() &&
+         !s.compare(s.size() - suffix.size(), suffix.size(), suffix);
+}
+
+// A bad file shouldn't take the other files down with it, so in batch mode
+// fatal errors unwind back to the worker.
+static void throwingErrorHandler(const char* error_msg)
+{
+  throw std::runtime_error(error_msg);
+}
+
+static const char* resultName(SOLVER_RETURN_TYPE ret, bool smt)
+{
+  switch (ret)
+  {
+    case SOLVER_VALID:
+      return smt ? "unsat" : "valid";
+    case SOLVER_INVALID:
+      return smt ? "sat" : "invalid";
+    case SOLVER_TIMEOUT:
+      return "timeout";
+    default:
+      return "unknown";
+  }
+}
+
+Batch::Batch(const UserDefinedFlags& flags_, int threads_)
+    : flags(flags_), threads(threads_), next(0), errors(0)
+{
+  if (threads < 1)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void Batch::addDirectory(const string& dir)
+{
+  DIR* d = opendir(dir.c_str());
+  if (d == NULL)
+  {
+    string errorMsg("Cannot open directory ");
+    errorMsg += dir;
+    FatalError(errorMsg.c_str());
+  }
+
+  std::vector<string> entries;
+  while (struct dirent* e = readdir(d))
+  {
+    const string name(e->d_name);
+    if (name != "." && name != "..")
+      entries.push_back(dir + "/" + name);
+  }
+  closedir(d);
+
+  // readdir's order depends on the file system.
+  std::sort(entries.begin(), entries.end());
+
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    struct stat st;
+    if (stat(entries[i].c_str(), &st) != 0)
+      continue;
+
+    if (S_ISDIR(st.st_mode))
+      addDirectory(entries[i]);
+    else if (hasSuffix(entries[i], ".cvc") || hasSuffix(entries[i], ".smt") ||
+             hasSuffix(entries[i], ".smt2"))
+      files.push_back(entries[i]);
+  }
+}
+
+void Batch::addInputs(const string& path)
+{
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+  {
+    string errorMsg("Cannot open ");
+    errorMsg += path;
+    FatalError(errorMsg.c_str());
+  }
+
+  if (S_ISDIR(st.st_mode))
+  {
+    addDirectory(path);
+    return;
+  }
+
+  // A list of files. Blank lines and lines starting with '#' are skipped.
+  std::ifstream list(path.c_str());
+  string line;
+  while (std::getline(list, line))
+  {
+    if (!line.empty() && line[line.size() - 1] == '\r')
+      line.erase(line.size() - 1);
+    if (!line.empty() && line[0] != '#')
+      files.push_back(line);
+  }
+}
+
+SOLVER_RETURN_TYPE Batch::solve(STPMgr* mgr, FILE* in, size_t& bytes)
+{
+  SimplifyingNodeFactory simplifyingNF(*mgr->hashingNodeFactory, *mgr);
+  mgr->defaultNodeFactory = &simplifyingNF;
+
+  Simplifier* simp = new Simplifier(mgr);
+  ArrayTransformer* arrayTransformer = new ArrayTransformer(mgr, simp);
+  ToSAT* tosat = new ToSAT(mgr);
+  AbsRefine_CounterExample* Ctr_Example =
+      new AbsRefine_CounterExample(mgr, simp, arrayTransformer);
+
+  // The STP object owns the others.
+  auto_ptr<STP> stp(
+      new STP(mgr, simp, arrayTransformer, tosat, Ctr_Example));
+  GlobalSTP = stp.get();
+  GlobalParserBM = mgr;
+
+  SOLVER_RETURN_TYPE ret = SOLVER_UNDECIDED;
+  const bool smtlib1 = mgr->UserFlags.smtlib1_parser_flag;
+  {
+    TypeChecker nfTypeCheck(simplifyingNF, *mgr);
+    Cpp_interface pi(*mgr, &nfTypeCheck);
+    GlobalParserInterface = &pi;
+    pi.startup();
+
+    mgr->GetRunTimes()->start(RunTimes::Parsing);
+    if (mgr->UserFlags.smtlib2_parser_flag)
+    {
+      // The SMT-LIB2 parser solves as it goes.
+      parseSMTLIB2(in);
+      mgr->GetRunTimes()->stop(RunTimes::Parsing);
+      ret = pi.getLastResult();
+    }
+    else
+    {
+      ASTVec AssertsQuery;
+      {
+        std::lock_guard<std::mutex> lock(globalParserMutex());
+        try
+        {
+          if (smtlib1)
+          {
+            smtin = in;
+            smtparse((void*)&AssertsQuery);
+          }
+          else
+          {
+            cvcin = in;
+            cvcparse((void*)&AssertsQuery);
+          }
+        }
+        catch (...)
+        {
+          // Don't leave the next file reading this one's buffer.
+          if (smtlib1)
+            smtlex_destroy();
+          else
+            cvclex_destroy();
+          throw;
+        }
+        if (smtlib1)
+          smtlex_destroy();
+        else
+          cvclex_destroy();
+      }
+      mgr->GetRunTimes()->stop(RunTimes::Parsing);
+
+      if (AssertsQuery.size() != 2)
+        FatalError("Input must contain a query\n");
+
+      // A COUNTEREXAMPLE command in the file turns printing back on.
+      mgr->UserFlags.print_counterexample_flag = false;
+
+      ret = stp->TopLevelSTP(AssertsQuery[0], AssertsQuery[1]);
+    }
+    GlobalParserInterface = NULL;
+  }
+
+  bytes = mgr->NodeMemoryUsed();
+
+  stp.reset();
+  GlobalSTP = NULL;
+  mgr->defaultNodeFactory = mgr->hashingNodeFactory;
+  return ret;
+}
+
+void Batch::report(const string& file, const char* status, long ms,
+                   size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(outputMutex);
+  cout << status << " " << std::fixed << std::setprecision(3) << ms / 1000.0
+       << "s " << std::setprecision(1) << bytes / (1024.0 * 1024.0) << "MB "
+       << file << endl;
+}
+
+void Batch::work()
+{
+  STPMgr* mgr = NULL;
+
+  for (size_t i = next++; i < files.size(); i = next++)
+  {
+    const string& file = files[i];
+    const long start = getCurrentTime();
+
+    if (mgr == NULL)
+      mgr = new STPMgr();
+
+    mgr->UserFlags = flags;
+    UserDefinedFlags& uf = mgr->UserFlags;
+    // The workers share cout, so only report() may write to it.
+    uf.print_output_flag = false;
+    uf.print_counterexample_flag = false;
+    uf.stats_flag = false;
+    uf.quick_statistics_flag = false;
+    if (!uf.smtlib1_parser_flag && !uf.smtlib2_parser_flag)
+    {
+      if (hasSuffix(file, ".smt"))
+        uf.smtlib1_parser_flag = true;
+      if (hasSuffix(file, ".smt2"))
+        uf.smtlib2_parser_flag = true;
+      if (uf.smtlib1_parser_flag || uf.smtlib2_parser_flag)
+        uf.division_by_zero_returns_one_flag = true;
+    }
+    const bool smt = uf.smtlib1_parser_flag || uf.smtlib2_parser_flag;
+
+    const char* status = "error";
+    size_t bytes = 0;
+    bool failed = true;
+    FILE* in = fopen(file.c_str(), "r");
+    if (in == NULL)
+      cerr << prog << ": Error: Cannot open " << file << endl;
+    else
+    {
+      try
+      {
+        status = resultName(solve(mgr, in, bytes), smt);
+        failed = false;
+      }
+      catch (const std::runtime_error& e)
+      {
+        cerr << prog << ": Error in " << file << ": " << e.what() << endl;
+      }
+      fclose(in);
+    }
+
+    GlobalSTP = NULL;
+    GlobalParserBM = NULL;
+    GlobalParserInterface = NULL;
+    Cnf_ClearMemory();
+
+    // After an error the manager may still be holding nodes.
+    if (failed || !mgr->Recycle())
+    {
+      delete mgr;
+      mgr = NULL;
+    }
+
+    if (failed)
+      errors++;
+    report(file, status, getCurrentTime() - start, bytes);
+  }
+
+  delete mgr;
+}
+
+int Batch::run()
+{
+  vc_error_hdlr = throwingErrorHandler;
+
+  const int n = std::min<size_t>(threads, files.size());
+  std::vector<std::thread> workers;
+  for (int i = 0; i < n; i++)
+    workers.push_back(std::thread(&Batch::work, this));
+  for (size_t i = 0; i < workers.size(); i++)
+    workers[i].join();
+
+  return errors;
+}
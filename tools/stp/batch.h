@@ -0,0 +1,69 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+
+#ifndef __BATCH_H__
+#define __BATCH_H__
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "stp/STPManager/STPManager.h"
+
+// Solves many input files in one process. Each worker thread owns an STPMgr,
+// which is recycled from one file to the next rather than being rebuilt. One
+// line is printed per file, in the order they finish:
+//
+//   <status> <seconds>s <MB>MB <file>
+//
+// The memory is what the file's nodes took when it finished.
+class Batch
+{
+public:
+  // Every file is solved with a copy of "flags". The parser is picked from
+  // each file's extension unless the flags choose one.
+  Batch(const stp::UserDefinedFlags& flags, int threads);
+
+  // "path" is either a directory, which is searched recursively for .cvc,
+  // .smt and .smt2 files, or a file that lists one input on each line.
+  void addInputs(const std::string& path);
+
+  // Returns the number of files that failed with an error.
+  int run();
+
+private:
+  const stp::UserDefinedFlags& flags;
+  int threads;
+  std::vector<std::string> files;
+
+  // The next file to hand to a worker.
+  std::atomic<size_t> next;
+  std::atomic<int> errors;
+  std::mutex outputMutex;
+
+  void addDirectory(const std::string& dir);
+  void work();
+  stp::SOLVER_RETURN_TYPE solve(stp::STPMgr* mgr, FILE* in, size_t& bytes);
+  void report(const std::string& file, const char* status, long ms,
+              size_t bytes);
+};
+
+#endif //__BATCH_H__
@@ -89,6 +89,8 @@ ExtraMain::try_parsing_options(int argc, char** argv, po::variables_map& vm,
     if (vm.count("help"))
     {
       cout << "USAGE: " << argv[0] << " [options] <input-file>" << endl
+           << "       " << argv[0] << " [options] --batch <dir-or-list>"
+           << endl
            << " where input is SMTLIB1/2 or CVC depending on options and file "
               "extension" << endl;
 
@@ -166,7 +168,12 @@ void ExtraMain::create_options()
        "use cryptominisat4 as the solver. Only use CryptoMiniSat 4.2 or above.")
 #endif
       ("simplifying-minisat", "use installed simplifying minisat version as the solver")(
-          "minisat", "use installed minisat version as the solver (default)")
+          "minisat", "use installed minisat version as the solver (default)")(
+          "incremental", po::bool_switch(&(bm->UserFlags.incremental_flag)),
+          "keep one SAT solver for all queries, reusing what it has learnt")(
+          "portfolio", po::value<int>(&(bm->UserFlags.portfolio_workers)),
+          "race this many differently configured SAT solvers on separate "
+          "threads, and take the first answer")
   ;
 
   po::options_description refinement_options("Refinement options");
@@ -175,6 +182,11 @@ void ExtraMain::create_options()
       "Do abstraction-refinement outside the SAT solver")(
       "ackermanize,r", po::bool_switch(&(bm->UserFlags.ackermannisation)),
       "eagerly encode array-read axioms (Ackermannistaion)")(
+      "ackermanize-sorted",
+      po::bool_switch(&(bm->UserFlags.sorted_ackermannisation)),
+      "eagerly encode array-read axioms through a sorting network on the "
+      "read indexes, which grows as n log^2 n rather than n^2 in the number "
+      "of reads")(
       "flatten,x", po::bool_switch(&(bm->UserFlags.xor_flatten_flag)),
       "flatten XORs");
 
@@ -212,6 +224,9 @@ void ExtraMain::create_options()
       "print-quickstat,t",
       po::bool_switch(&(bm->UserFlags.quick_statistics_flag)),
       "print quick statistics")(
+      "print-profile-json",
+      "after each query, print a line of JSON to stderr with the time spent "
+      "in each pass, node counts, cache, CNF and SAT statistics")(
       "print-nodes,v", po::bool_switch(&(bm->UserFlags.print_nodes_flag)),
       "print nodes ")
       /*("constr-counterex,c",
@@ -240,6 +255,15 @@ void ExtraMain::create_options()
                              "exit after the CNF has been generated")
       ("timeout,g", po::value<int64_t>(&max_num_confl),
        "Number of conflicts after which the SAT solver gives up. -1 means never (default)")
+      ("max-time", po::value<int64_t>(&(bm->UserFlags.timeout_max_time)),
+       "Milliseconds after which each query gives up. -1 means never (default)")
+      ("batch", po::value<string>(&batch_input),
+       "solve every .cvc, .smt and .smt2 file under this directory, or every "
+       "file listed in this file, printing a line for each with its result, "
+       "time and node memory. The other options apply to all the files")
+      ("threads", po::value<int>(&batch_threads),
+       "number of files --batch solves at once. Defaults to the number of "
+       "cores")
       ("seed,i", po::value<size_t>(&random_seed),
        "set random seed for STP's satisfiable output. Random_seed is an "
        "integer >= 0")("random-seed",
@@ -283,6 +307,11 @@ int ExtraMain::parse_options(int argc, char** argv)
     bm->UserFlags.wordlevel_solve_flag = false;
   }
 
+  if (vm.count("print-profile-json"))
+  {
+    bm->GetRunTimes()->setProfiling(true);
+  }
+
   if (vm.count("disable-cbitp"))
   {
     bm->UserFlags.bitConstantProp_flag = false;
@@ -325,6 +354,18 @@ int ExtraMain::parse_options(int argc, char** argv)
   }
 #endif
 
+  if (vm.count("portfolio"))
+  {
+    if (bm->UserFlags.portfolio_workers < 1)
+      FatalError("--portfolio needs at least one solver");
+    bm->UserFlags.solver_to_use = UserDefinedFlags::PORTFOLIO_SOLVER;
+  }
+
+  if (bm->UserFlags.sorted_ackermannisation)
+  {
+    bm->UserFlags.ackermannisation = true;
+  }
+
   if (vm.count("oldstyle-refinement"))
   {
     bm->UserFlags.solver_to_use = UserDefinedFlags::MINISAT_SOLVER;
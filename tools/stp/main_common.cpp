@@ -23,21 +23,19 @@ THE SOFTWARE.
 ********************************************************************/
 
 #include "main_common.h"
+#include "batch.h"
 #include "extlib-abc/cnf_short.h"
 
 extern int smtparse(void*);
-extern int smt2parse();
 extern int cvcparse(void*);
 extern int cvclex_destroy(void);
 extern int smtlex_destroy(void);
-extern int smt2lex_destroy(void);
 extern void errorHandler(const char* error_msg);
 
 // Amount of memory to ask for at beginning of main.
 extern const intptr_t INITIAL_MEMORY_PREALLOCATION_SIZE;
 extern FILE* cvcin;
 extern FILE* smtin;
-extern FILE* smt2in;
 
 #ifdef EXT_HASH_MAP
 using namespace __gnu_cxx;
@@ -57,13 +55,12 @@ void errorHandler(const char* error_msg)
 // Amount of memory to ask for at beginning of main.
 const intptr_t INITIAL_MEMORY_PREALLOCATION_SIZE = 4000000;
 
-Main::Main() : onePrintBack(false)
+Main::Main() : onePrintBack(false), batch_threads(0)
 {
   bm = NULL;
   toClose = NULL;
   cvcin = NULL;
   smtin = NULL;
-  smt2in = NULL;
 
   // Register the error handler
   vc_error_hdlr = errorHandler;
@@ -119,16 +116,17 @@ void Main::parse_file(ASTVec* AssertsQuery)
 
   if (bm->UserFlags.smtlib1_parser_flag)
   {
+    std::lock_guard<std::mutex> lock(globalParserMutex());
     smtparse((void*)AssertsQuery);
     smtlex_destroy();
   }
   else if (bm->UserFlags.smtlib2_parser_flag)
   {
-    smt2parse();
-    smt2lex_destroy();
+    parseSMTLIB2(toClose);
   }
   else
   {
+    std::lock_guard<std::mutex> lock(globalParserMutex());
     cvcparse((void*)AssertsQuery);
     cvclex_destroy();
   }
@@ -202,9 +200,8 @@ void Main::read_file()
   }
   else if (bm->UserFlags.smtlib2_parser_flag)
   {
-    smt2in = fopen(infile.c_str(), "r");
-    toClose = smt2in;
-    if (smt2in == NULL)
+    toClose = fopen(infile.c_str(), "r");
+    if (toClose == NULL)
     {
       error = true;
     }
@@ -232,6 +229,16 @@ int Main::create_and_parse_options(int argc, char** argv)
   return 0;
 }
 
+int Main::run_batch()
+{
+  if (!infile.empty())
+    FatalError("Give either an input file or --batch, not both");
+
+  Batch batch(bm->UserFlags, batch_threads);
+  batch.addInputs(batch_input);
+  return batch.run() == 0 ? 0 : 1;
+}
+
 void Main::check_infile_type()
 {
   if (infile.size() >= 5)
@@ -268,6 +275,9 @@ int Main::main(int argc, char** argv)
     return ret;
   }
 
+  if (!batch_input.empty())
+    return run_batch();
+
   GlobalSTP = new STP(bm, simp.get(), arrayTransformer.get(), tosat.get(),
                       Ctr_Example.get());
 
@@ -308,6 +318,12 @@ int Main::main(int argc, char** argv)
     SOLVER_RETURN_TYPE ret = GlobalSTP->TopLevelSTP(
       asserts, query);
 
+    if (bm->GetRunTimes()->isProfiling())
+    {
+      bm->GetRunTimes()->printJSON(std::cerr);
+      bm->GetRunTimes()->clear();
+    }
+
     if (bm->UserFlags.quick_statistics_flag)
     {
       bm->GetRunTimes()->print();
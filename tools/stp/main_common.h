@@ -61,6 +61,12 @@ public:
   std::string infile;
   void check_infile_type();
 
+  // A directory or list of files to solve with a pool of threads, instead
+  // of the single infile.
+  std::string batch_input;
+  int batch_threads;
+  int run_batch();
+
   // For options
   int64_t max_num_confl;
   size_t random_seed;
@@ -36,10 +36,6 @@ using namespace stp;
 
 int main(int argc, char** argv)
 {
-  extern int smt2parse();
-  extern int smt2lex_destroy(void);
-  extern FILE* smt2in;
-
   STPMgr stp;
   STPMgr* mgr = &stp;
 
@@ -65,15 +61,14 @@ int main(int argc, char** argv)
   mgr->GetRunTimes()->start(RunTimes::Parsing);
   if (argc > 1)
   {
-    smt2in = fopen(argv[1], "r");
-    smt2parse();
+    FILE* in = fopen(argv[1], "r");
+    parseSMTLIB2(in);
+    fclose(in);
   }
   else
   {
-    smt2in = NULL; // from stdin.
-    smt2parse();
+    parseSMTLIB2(NULL); // from stdin.
   }
-  smt2lex_destroy();
   //-----------------------------------------------------
 
   ASTNode n;
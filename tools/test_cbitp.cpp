@@ -46,6 +46,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "stp/Util/Relations.h"
 #include "stp/Util/BBAsProp.h"
 #include "stp/Util/Functions.h"
+#include "stp/Util/BitSerial.h"
 #include "stp/Simplifier/constantBitP/ConstantBitP_MaxPrecision.h"
 
 using simplifier::constantBitP::FixedBits;
@@ -823,6 +824,81 @@ void random_tests()
   random_tests(&signedRemainder, SBVREM);
 }
 
+// The word at a time transfer functions should fix exactly the same bits as the
+// bit at a time versions they replaced. Widths either side of the word size
+// are checked. When there's a conflict the partial results can differ, only
+// the conflict itself has to agree.
+void check_word_parallel(Result (*word)(vector<FixedBits*>&, FixedBits&),
+                         Result (*serial)(vector<FixedBits*>&, FixedBits&),
+                         const Kind kind, const unsigned numberOfChildren,
+                         const bool booleanOutput)
+{
+  const unsigned widths[] = {1, 5, 63, 64, 65, 127, 128, 200};
+  MTRand rand(1);
+
+  for (unsigned w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+    for (unsigned prob = 10; prob <= 90; prob += 40)
+      for (int i = 0; i < 20000; i++)
+      {
+        const unsigned width = widths[w];
+        const unsigned outputWidth = booleanOutput ? 1 : width;
+
+        vector<FixedBits> initial;
+        for (unsigned j = 0; j < numberOfChildren; j++)
+          initial.push_back(FixedBits::createRandom(width, prob, rand));
+        FixedBits initialOutput =
+            FixedBits::createRandom(outputWidth, prob, rand);
+
+        vector<FixedBits> a(initial), b(initial);
+        vector<FixedBits*> aChildren, bChildren;
+        for (unsigned j = 0; j < numberOfChildren; j++)
+        {
+          aChildren.push_back(&a[j]);
+          bChildren.push_back(&b[j]);
+        }
+        FixedBits aOutput(initialOutput), bOutput(initialOutput);
+
+        const Result ra = word(aChildren, aOutput);
+        const Result rb = serial(bChildren, bOutput);
+
+        bool same = (ra == rb);
+        if (same && ra != CONFLICT)
+        {
+          same = FixedBits::equals(aOutput, bOutput);
+          for (unsigned j = 0; j < numberOfChildren; j++)
+            same &= FixedBits::equals(a[j], b[j]);
+        }
+
+        if (!same)
+        {
+          vector<FixedBits*> initialChildren;
+          for (unsigned j = 0; j < numberOfChildren; j++)
+            initialChildren.push_back(&initial[j]);
+          error(kind, initialChildren, initialOutput, aChildren, aOutput,
+                bChildren, bOutput);
+        }
+      }
+}
+
+void check_word_parallel()
+{
+  cerr << "word parallel transfer functions" << endl;
+  check_word_parallel(bvAndBothWays, bitserial::bvAndBothWays, BVAND, 2,
+                      false);
+  check_word_parallel(bvAndBothWays, bitserial::bvAndBothWays, BVAND, 3,
+                      false);
+  check_word_parallel(bvOrBothWays, bitserial::bvOrBothWays, BVOR, 2, false);
+  check_word_parallel(bvOrBothWays, bitserial::bvOrBothWays, BVOR, 3, false);
+  check_word_parallel(bvXorBothWays, bitserial::bvXorBothWays, BVXOR, 2,
+                      false);
+  check_word_parallel(bvXorBothWays, bitserial::bvXorBothWays, BVXOR, 3,
+                      false);
+  check_word_parallel(bvNotBothWays, bitserial::bvNotBothWays, BVNEG, 1,
+                      false);
+  check_word_parallel(bvEqualsBothWays, bitserial::bvEqualsBothWays, EQ, 2,
+                      true);
+}
+
 void check_bvconcat(const int bits)
 {
   if (bits >= 2)
@@ -1132,6 +1208,8 @@ int main(void)
   mgr->UserFlags.division_by_zero_returns_one_flag = true;
   Cpp_interface interface(*mgr);
 
+  check_word_parallel();
+
   // Add had a defect effecting bithWidth > 90.
   // Shifting had a defect effecting bitWidth > 64.
   random_tests();
@@ -40,6 +40,7 @@ THE SOFTWARE.
 
 #include "stp/Util/StopWatch.h"
 #include "stp/Util/Relations.h"
+#include "stp/Util/BitSerial.h"
 #include "stp/Parser/LetMgr.h"
 
 using simplifier::constantBitP::FixedBits;
@@ -227,6 +228,46 @@ simplifier::constantBitP::Result multiply(vector<FixedBits*>& children,
   return bvMultiplyBothWays(children, output, beev);
 }
 
+// Times the word at a time transfer function against the bit at a time version
+// it replaced, on the same random inputs.
+clock_t time_transfer(Result (*transfer)(vector<FixedBits*>&, FixedBits&),
+                      const vector<FixedBits>& inputs, unsigned arity)
+{
+  vector<FixedBits> copies(inputs);
+  vector<FixedBits*> children(arity);
+
+  Stopwatch s;
+  for (unsigned i = 0; i + arity < copies.size(); i += arity + 1)
+  {
+    for (unsigned j = 0; j < arity; j++)
+      children[j] = &copies[i + j];
+    transfer(children, copies[i + arity]);
+  }
+  return s.stop2();
+}
+
+void compare_word_parallel(Result (*word)(vector<FixedBits*>&, FixedBits&),
+                           Result (*serial)(vector<FixedBits*>&, FixedBits&),
+                           unsigned arity, const char* name)
+{
+  const unsigned widths[] = {8, 64, 256};
+  for (unsigned w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+  {
+    MTRand rand(1);
+    vector<FixedBits> inputs;
+    for (int i = 0; i < iterations; i++)
+      inputs.push_back(FixedBits::createRandom(widths[w], 30, rand));
+
+    const clock_t serialTime = time_transfer(serial, inputs, arity);
+    const clock_t wordTime = time_transfer(word, inputs, arity);
+
+    cerr << std::fixed << std::setprecision(2) << name << " width "
+         << widths[w] << ": bit at a time "
+         << float(serialTime) / CLOCKS_PER_SEC << "s, word at a time "
+         << float(wordTime) / CLOCKS_PER_SEC << "s" << endl;
+  }
+}
+
 //
 void run_with_various_prob(Result (*transfer)(vector<FixedBits*>&, FixedBits&),
                            ostream& output, Kind kind = stp::UNDEFINED)
@@ -249,6 +290,11 @@ int main(void)
 
   ostream& output = cerr;
 
+  compare_word_parallel(bvAndBothWays, bitserial::bvAndBothWays, 2, "and");
+  compare_word_parallel(bvOrBothWays, bitserial::bvOrBothWays, 2, "or");
+  compare_word_parallel(bvXorBothWays, bitserial::bvXorBothWays, 2, "xor");
+  compare_word_parallel(bvNotBothWays, bitserial::bvNotBothWays, 1, "not");
+
   output << "signed greater than equals" << endl;
   run_with_various_prob(&bvSignedGreaterThanEqualsBothWays, output, stp::BVSGE);
 
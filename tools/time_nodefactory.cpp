@@ -0,0 +1,110 @@
+/********************************************************************
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+********************************************************************/
+
+// Measures how quickly the hashing node factory creates nodes. Half of the
+// work creates nodes that don't exist yet, the rest looks up nodes that do,
+// which is what most calls to the node factory do in practice.
+
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include "stp/AST/AST.h"
+#include "stp/AST/time_mem.h"
+#include "stp/STPManager/STPManager.h"
+#include "stp/Simplifier/constantBitP/MersenneTwister.h"
+#include "stp/Util/StopWatch.h"
+
+using namespace stp;
+
+const unsigned bitWidth = 32;
+const int symbols = 64;
+const int nodes = 200000;
+const int repeats = 10;
+
+const Kind kinds[] = {BVPLUS, BVMULT, BVAND, BVOR, BVXOR, BVSUB};
+
+// Builds a DAG of binary terms over earlier terms. The same seed gives the
+// same sequence of nodes, so a second call with an equal seed only hits the
+// unique table.
+void build(STPMgr* mgr, const vector<ASTNode>& leaves, vector<ASTNode>& out,
+           unsigned long seed)
+{
+  MTRand rand(seed);
+  NodeFactory* nf = mgr->hashingNodeFactory;
+
+  out = leaves;
+  for (int i = 0; i < nodes; i++)
+  {
+    const ASTNode& a = out[rand.randInt(out.size() - 1)];
+    const ASTNode& b = out[rand.randInt(out.size() - 1)];
+    const Kind k = kinds[rand.randInt(sizeof(kinds) / sizeof(kinds[0]) - 1)];
+    out.push_back(nf->CreateTerm(k, bitWidth, a, b));
+  }
+}
+
+void report(const char* what, clock_t ticks, long created)
+{
+  const double seconds = double(ticks) / CLOCKS_PER_SEC;
+  cerr << std::setw(8) << what << ": " << std::fixed << std::setprecision(3)
+       << seconds << "s  " << std::setprecision(0)
+       << (seconds > 0 ? created / seconds : 0) << " nodes/s" << endl;
+}
+
+int main(void)
+{
+  STPMgr* mgr = new STPMgr();
+  GlobalParserBM = mgr;
+
+  vector<ASTNode> leaves;
+  for (int i = 0; i < symbols; i++)
+  {
+    std::stringstream name;
+    name << "v" << i;
+    leaves.push_back(mgr->CreateSymbol(name.str().c_str(), 0, bitWidth));
+  }
+
+  vector<ASTNode> kept;
+  vector<ASTNode> scratch;
+
+  Stopwatch2 misses, hits;
+  for (int r = 0; r < repeats; r++)
+  {
+    misses.start();
+    build(mgr, leaves, kept, r);
+    misses.stop();
+
+    hits.start();
+    build(mgr, leaves, scratch, r);
+    hits.stop();
+
+    kept.clear();
+    scratch.clear();
+  }
+
+  report("misses", misses.elapsed, (long)nodes * repeats);
+  report("hits", hits.elapsed, (long)nodes * repeats);
+  report("total", misses.elapsed + hits.elapsed, 2L * nodes * repeats);
+  cerr << "    peak: " << std::setprecision(1) << memUsedPeak() / (1024 * 1024)
+       << "MB" << endl;
+
+  leaves.clear();
+  delete mgr;
+  return 0;
+}